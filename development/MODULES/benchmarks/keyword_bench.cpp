@@ -0,0 +1,114 @@
+// Microbenchmark: keyword recognition through the compile-time perfect hash
+// (lexer/keywords.h) versus the unordered_map the lexer used to build in
+// every constructor.
+//
+// Usage: keyword_bench [source.hanami] [rounds]
+// Every identifier-like word in the source is looked up `rounds` times.
+
+#include <chrono>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../lexer/keywords.h"
+
+namespace {
+
+std::unordered_map<std::string_view, TokenType> buildKeywordMap() {
+    std::unordered_map<std::string_view, TokenType> keywords;
+    for (const auto& entry : KEYWORD_LIST) {
+        keywords[entry.text] = entry.type;
+    }
+    return keywords;
+}
+
+std::vector<std::string_view> splitWords(const std::string& source) {
+    std::vector<std::string_view> words;
+    size_t i = 0;
+    while (i < source.size()) {
+        unsigned char c = source[i];
+        if (std::isalpha(c) || c == '_') {
+            size_t start = i;
+            while (i < source.size() && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_')) {
+                ++i;
+            }
+            words.emplace_back(source.data() + start, i - start);
+        } else {
+            ++i;
+        }
+    }
+    return words;
+}
+
+template <typename Lookup>
+double nanosPerLookup(const std::vector<std::string_view>& words, int rounds, Lookup lookup, size_t& keywordCount) {
+    keywordCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (std::string_view word : words) {
+            if (lookup(word) != TokenType::IDENTIFIER) ++keywordCount;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double nanos = std::chrono::duration<double, std::nano>(end - start).count();
+    return nanos / (static_cast<double>(words.size()) * rounds);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string inputFilename = argc > 1 ? argv[1] : "../lexer/input/test_final.hanami";
+    int rounds = argc > 2 ? std::stoi(argv[2]) : 20000;
+
+    std::ifstream inFile(inputFilename);
+    if (!inFile) {
+        std::cerr << "Error: Could not open input file: " << inputFilename << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << inFile.rdbuf();
+    std::string source = buffer.str();
+
+    std::vector<std::string_view> words = splitWords(source);
+    if (words.empty() || rounds <= 0) {
+        std::cerr << "Error: Nothing to look up in " << inputFilename << std::endl;
+        return 1;
+    }
+
+    // Construction cost the map paid on every Lexer; the perfect hash has none.
+    const int constructions = 10000;
+    size_t mapSizes = 0;
+    auto buildStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < constructions; ++i) {
+        mapSizes += buildKeywordMap().size();
+    }
+    auto buildEnd = std::chrono::steady_clock::now();
+    double buildNanos = std::chrono::duration<double, std::nano>(buildEnd - buildStart).count() / constructions;
+
+    auto keywordMap = buildKeywordMap();
+    size_t mapKeywords = 0;
+    size_t hashKeywords = 0;
+    double mapNanos = nanosPerLookup(words, rounds, [&](std::string_view word) {
+        auto it = keywordMap.find(word);
+        return it != keywordMap.end() ? it->second : TokenType::IDENTIFIER;
+    }, mapKeywords);
+    double hashNanos = nanosPerLookup(words, rounds, lookupKeyword, hashKeywords);
+
+    if (mapKeywords != hashKeywords || mapSizes == 0) {
+        std::cerr << "Error: Lookups disagree (" << mapKeywords << " vs " << hashKeywords << " keywords)" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Input: " << inputFilename << " (" << words.size() << " words, "
+              << hashKeywords / rounds << " keywords) x " << rounds << " rounds" << std::endl;
+    std::cout << "unordered_map build:  " << buildNanos << " ns per Lexer" << std::endl;
+    std::cout << "unordered_map lookup: " << mapNanos << " ns/word" << std::endl;
+    std::cout << "perfect hash lookup:  " << hashNanos << " ns/word" << std::endl;
+    std::cout << "speedup:              " << mapNanos / hashNanos << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Benchmark: lexer throughput in MB/s.
+//
+// Usage: lexer_bench [source.hanami] [corpus_mb] [runs]
+// The source file is repeated until the corpus is at least corpus_mb
+// megabytes, then Lexer::scanTokens is timed over it; the best run is reported.
+// Fails if an IDENTIFIER token comes out without its interned symbol.
+// Set HANAMI_SIMD=scalar|sse2|avx2 to time a specific set of scan kernels.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../lexer/lexer.h"
+#include "../lexer/simd_scan.h"
+
+int main(int argc, char* argv[]) {
+    std::string inputFilename = argc > 1 ? argv[1] : "../lexer/input/test_final.hanami";
+    double corpusMB = argc > 2 ? std::stod(argv[2]) : 8.0;
+    int runs = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    std::ifstream inFile(inputFilename);
+    if (!inFile) {
+        std::cerr << "Error: Could not open input file: " << inputFilename << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << inFile.rdbuf();
+    std::string unit = buffer.str();
+    if (unit.empty() || runs <= 0) {
+        std::cerr << "Error: Nothing to lex in " << inputFilename << std::endl;
+        return 1;
+    }
+    unit += '\n';
+
+    std::string corpus;
+    size_t corpusBytes = static_cast<size_t>(corpusMB * 1024 * 1024);
+    corpus.reserve(corpusBytes + unit.size());
+    while (corpus.size() < corpusBytes) {
+        corpus += unit;
+    }
+
+    double bestSeconds = 0;
+    size_t tokenCount = 0;
+    std::vector<Token> tokens;
+    for (int run = 0; run < runs; ++run) {
+        Lexer lexer(corpus);
+        auto start = std::chrono::steady_clock::now();
+        tokens = lexer.scanTokens();
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (run == 0 || seconds < bestSeconds) bestSeconds = seconds;
+        tokenCount = tokens.size();
+    }
+
+    // The lexer interns every identifier, so the parser never has to
+    for (const Token& token : tokens) {
+        if (token.type == TokenType::IDENTIFIER &&
+            (token.symbol == 0 || Symbol::fromId(token.symbol) != token.lexeme)) {
+            std::cerr << "Error: IDENTIFIER '" << token.lexeme << "' at offset " << token.offset
+                      << " was not interned by the lexer" << std::endl;
+            return 1;
+        }
+    }
+
+    double megabytes = corpus.size() / (1024.0 * 1024.0);
+    std::cout << "Input: " << inputFilename << " repeated to " << megabytes << " MB, "
+              << tokenCount << " tokens, best of " << runs << " runs, "
+              << scanKernels().name << " kernels" << std::endl;
+    std::cout << "lexer throughput: " << megabytes / bestSeconds << " MB/s ("
+              << bestSeconds * 1000 << " ms)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Benchmark: parallel chunked lexing, 1 to 16 threads.
+//
+// Usage: lexer_scaling_bench [source.hanami] [corpus_mb] [runs]
+// The source file is repeated until the corpus is at least corpus_mb
+// megabytes, then Lexer::scanTokensParallel is timed for each thread count
+// (best run reported) and its tokens are checked against Lexer::scanTokens.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../lexer/lexer.h"
+
+static bool sameTokens(const std::vector<Token>& a, const std::vector<Token>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || a[i].offset != b[i].offset || a[i].lexeme != b[i].lexeme) {
+            std::cerr << "First difference at token " << i << " (offset " << a[i].offset
+                      << " vs " << b[i].offset << ")" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFilename = argc > 1 ? argv[1] : "../lexer/input/test_final.hanami";
+    double corpusMB = argc > 2 ? std::stod(argv[2]) : 64.0;
+    int runs = argc > 3 ? std::stoi(argv[3]) : 3;
+
+    std::ifstream inFile(inputFilename);
+    if (!inFile) {
+        std::cerr << "Error: Could not open input file: " << inputFilename << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << inFile.rdbuf();
+    std::string unit = buffer.str();
+    if (unit.empty() || runs <= 0) {
+        std::cerr << "Error: Nothing to lex in " << inputFilename << std::endl;
+        return 1;
+    }
+    unit += '\n';
+
+    std::string corpus;
+    size_t corpusBytes = static_cast<size_t>(corpusMB * 1024 * 1024);
+    corpus.reserve(corpusBytes + unit.size());
+    while (corpus.size() < corpusBytes) {
+        corpus += unit;
+    }
+    double megabytes = corpus.size() / (1024.0 * 1024.0);
+
+    Lexer serialLexer(corpus);
+    std::vector<Token> serial = serialLexer.scanTokens();
+    std::cout << "Input: " << inputFilename << " repeated to " << megabytes << " MB, "
+              << serial.size() << " tokens, best of " << runs << " runs, "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    double baseSeconds = 0;
+    for (unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+        double bestSeconds = 0;
+        for (int run = 0; run < runs; ++run) {
+            Lexer lexer(corpus);
+            auto start = std::chrono::steady_clock::now();
+            std::vector<Token> tokens = lexer.scanTokensParallel(threads);
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            if (run == 0 || seconds < bestSeconds) bestSeconds = seconds;
+            if (run == 0 && !sameTokens(tokens, serial)) {
+                std::cerr << "Error: " << threads << "-thread tokens differ from the serial lexer" << std::endl;
+                return 1;
+            }
+        }
+        if (threads == 1) baseSeconds = bestSeconds;
+        std::cout << threads << " threads: " << megabytes / bestSeconds << " MB/s ("
+                  << bestSeconds * 1000 << " ms, " << baseSeconds / bestSeconds << "x)" << std::endl;
+    }
+    return 0;
+}
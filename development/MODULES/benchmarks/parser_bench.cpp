@@ -0,0 +1,73 @@
+// Benchmark: parser throughput in tokens/s.
+//
+// Usage: parser_bench [source.hanami] [corpus_mb] [runs]
+// The source file is repeated until the corpus is at least corpus_mb
+// megabytes and lexed once; then Parser::parse is timed over the tokens
+// (a fresh arena per run) and the best run is reported.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+
+int main(int argc, char* argv[]) {
+    std::string inputFilename = argc > 1 ? argv[1] : "input/expressions.hanami";
+    double corpusMB = argc > 2 ? std::stod(argv[2]) : 4.0;
+    int runs = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    std::ifstream inFile(inputFilename);
+    if (!inFile) {
+        std::cerr << "Error: Could not open input file: " << inputFilename << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << inFile.rdbuf();
+    std::string unit = buffer.str();
+    if (unit.empty() || runs <= 0) {
+        std::cerr << "Error: Nothing to parse in " << inputFilename << std::endl;
+        return 1;
+    }
+    unit += '\n';
+
+    std::string corpus;
+    size_t corpusBytes = static_cast<size_t>(corpusMB * 1024 * 1024);
+    corpus.reserve(corpusBytes + unit.size());
+    while (corpus.size() < corpusBytes) {
+        corpus += unit;
+    }
+
+    Lexer lexer(corpus);
+    std::vector<Token> tokens = lexer.scanTokens();
+    for (const Token& token : tokens) {
+        if (token.type == TokenType::ERROR) {
+            std::cerr << "Error: " << inputFilename << " does not lex cleanly: " << token.lexeme << std::endl;
+            return 1;
+        }
+    }
+
+    double bestSeconds = 0;
+    size_t statementCount = 0;
+    for (int run = 0; run < runs; ++run) {
+        Arena arena;
+        Parser parser(tokens, lexer.lineTable(), arena);
+        auto start = std::chrono::steady_clock::now();
+        NodePtr<ProgramNode> program = parser.parse();
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (run == 0 || seconds < bestSeconds) bestSeconds = seconds;
+        statementCount = program->statements.size();
+    }
+
+    double megabytes = corpus.size() / (1024.0 * 1024.0);
+    std::cout << "Input: " << inputFilename << " repeated to " << megabytes << " MB, "
+              << tokens.size() << " tokens, " << statementCount << " top-level statements, best of "
+              << runs << " runs" << std::endl;
+    std::cout << "parser throughput: " << tokens.size() / bestSeconds / 1e6 << " M tokens/s ("
+              << bestSeconds * 1000 << " ms)" << std::endl;
+    return 0;
+}
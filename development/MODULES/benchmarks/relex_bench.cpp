@@ -0,0 +1,110 @@
+// Benchmark: incremental re-lexing of a keystroke vs a full lex.
+//
+// Usage: relex_bench [source.hanami] [runs]
+// The source file is repeated into documents of growing size; for each, an
+// IncrementalLexer is built and a character typed into an identifier in the
+// middle. That first edit moves the lexer's split from the end to the
+// middle; the keystroke timed after it types one more character at the same
+// place (and is undone, untimed, between runs). For comparison the whole
+// edited document is lexed with Lexer::scanTokens. Times are the best run;
+// the incremental tokens are checked against the full lex.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../lexer/lexer.h"
+
+// Best time of body(); setup() runs before each timed call
+template <typename Setup, typename F>
+static double bestSeconds(int runs, Setup&& setup, F&& body) {
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < best) best = seconds;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFilename = argc > 1 ? argv[1] : "../lexer/input/test_final.hanami";
+    int runs = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    std::ifstream inFile(inputFilename);
+    if (!inFile) {
+        std::cerr << "Error: Could not open input file: " << inputFilename << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << inFile.rdbuf();
+    std::string unit = buffer.str() + "\n";
+    if (unit.size() < 2 || runs <= 0) {
+        std::cerr << "Error: Nothing to lex in " << inputFilename << std::endl;
+        return 1;
+    }
+
+    std::cout << "Input: " << inputFilename << ", best of " << runs << " runs" << std::endl;
+    for (double megabytes : {0.25, 1.0, 4.0, 16.0}) {
+        std::string document;
+        while (document.size() < megabytes * 1024 * 1024) document += unit;
+        IncrementalLexer incremental(document);
+
+        // Type at the end of an identifier near the middle
+        size_t middle = incremental.size() / 2;
+        while (middle < incremental.size() && incremental.token(middle).type != TokenType::IDENTIFIER) ++middle;
+        if (middle == incremental.size()) {
+            std::cerr << "Error: No identifier to edit in " << inputFilename << std::endl;
+            return 1;
+        }
+        Token identifier = incremental.token(middle);
+        size_t at = identifier.offset + identifier.lexeme.size();
+
+        // The editor changes its text in place; that is not timed
+        document.insert(at, "x");
+        auto start = std::chrono::steady_clock::now();
+        incremental.relex(document, SourceEdit{at, 0, "x"});
+        double firstSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        RelexResult result{};
+        bool typed = false;
+        double keystrokeSeconds = bestSeconds(runs, [&] {
+            if (typed) {
+                document.erase(at + 1, 1);
+                incremental.relex(document, SourceEdit{at + 1, 1, ""});
+            }
+            document.insert(at + 1, "y");
+            typed = true;
+        }, [&] {
+            result = incremental.relex(document, SourceEdit{at + 1, 0, "y"});
+        });
+
+        size_t fullCount = 0;
+        double fullSeconds = bestSeconds(runs, [] {}, [&] {
+            Lexer lexer(document);
+            fullCount = lexer.scanTokens().size();
+        });
+        // Unescaped strings live in the Lexer, so the reference one stays alive
+        Lexer reference(document);
+        std::vector<Token> full = reference.scanTokens();
+        std::vector<Token> tokens = incremental.tokens();
+        bool same = tokens.size() == full.size() && full.size() == fullCount;
+        for (size_t i = 0; same && i < tokens.size(); ++i) {
+            same = tokens[i].type == full[i].type && tokens[i].offset == full[i].offset && tokens[i].lexeme == full[i].lexeme;
+        }
+        if (!same) {
+            std::cerr << "Error: relex and a full lex disagree on the edited document" << std::endl;
+            return 1;
+        }
+
+        std::cout << document.size() / (1024.0 * 1024.0) << " MB, " << tokens.size() << " tokens: first edit "
+                  << firstSeconds * 1000 << " ms, next keystroke " << keystrokeSeconds * 1000 << " ms ("
+                  << result.newEnd - result.first << " changed), full lex " << fullSeconds * 1000 << " ms" << std::endl;
+    }
+    return 0;
+}
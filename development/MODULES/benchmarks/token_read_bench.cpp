@@ -0,0 +1,101 @@
+// Benchmark: reading the text token format in tokens/s.
+//
+// Usage: token_read_bench [source.hanami] [min_tokens] [runs]
+// The source file is repeated and lexed until there are at least min_tokens
+// tokens, which are written in memory in the `lexer_executable --text` format.
+// readTextTokens is then timed over that buffer (fresh arena per run) and the
+// best run is reported.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../lexer/lexer.h"
+#include "../common/token_io.h"
+#include "../common/utils.h"
+
+// Same layout as writeTextTokens in lexer/main.cpp
+std::string formatTextTokens(const std::vector<Token>& tokens, const LineTable& lines) {
+    std::string out;
+    for (const Token& token : tokens) {
+        out += tokenTypeToString(token.type);
+        if (token.type == TokenType::IDENTIFIER || token.type == TokenType::NUMBER ||
+            token.type == TokenType::FLOAT_LITERAL || token.type == TokenType::DOUBLE_LITERAL ||
+            token.type == TokenType::STRING || token.type == TokenType::STYLE_INCLUDE ||
+            token.type == TokenType::ERROR) {
+            out += ' ';
+            for (char c : token.lexeme) {
+                switch (c) {
+                    case '\\': out += "\\\\"; break;
+                    case '"': out += "\\\""; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default: out += c; break;
+                }
+            }
+        }
+        SourcePosition pos = lines.position(token.offset);
+        out += ' ' + std::to_string(pos.line) + ' ' + std::to_string(pos.column) + '\n';
+        if (token.type == TokenType::EOF_TOKEN) break;
+    }
+    return out;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFilename = argc > 1 ? argv[1] : "input/expressions.hanami";
+    size_t minTokens = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    int runs = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    std::ifstream inFile(inputFilename);
+    if (!inFile) {
+        std::cerr << "Error: Could not open input file: " << inputFilename << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << inFile.rdbuf();
+    std::string unit = buffer.str();
+    if (unit.empty() || runs <= 0) {
+        std::cerr << "Error: Nothing to read in " << inputFilename << std::endl;
+        return 1;
+    }
+    unit += '\n';
+
+    Lexer unitLexer(unit);
+    size_t unitTokens = unitLexer.scanTokens().size();
+    std::string corpus;
+    for (size_t lexed = 0; lexed < minTokens; lexed += unitTokens) {
+        corpus += unit;
+    }
+    Lexer lexer(corpus);
+    std::vector<Token> tokens = lexer.scanTokens();
+    std::string text = formatTextTokens(tokens, lexer.lineTable());
+    size_t written = std::count(text.begin(), text.end(), '\n'); // One line per token, up to the first EOF_TOKEN
+
+    double bestSeconds = 0;
+    size_t readCount = 0;
+    for (int run = 0; run < runs; ++run) {
+        Arena pool;
+        LineTable lines;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Token> read = readTextTokens(text.data(), text.size(), pool, lines);
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (run == 0 || seconds < bestSeconds) bestSeconds = seconds;
+        readCount = read.size();
+    }
+    if (readCount != written) {
+        std::cerr << "Error: read " << readCount << " tokens, wrote " << written << std::endl;
+        return 1;
+    }
+
+    std::cout << "Input: " << inputFilename << " as " << text.size() / (1024.0 * 1024.0) << " MB of text tokens, "
+              << readCount << " tokens, best of " << runs << " runs" << std::endl;
+    std::cout << "text token read: " << readCount / bestSeconds / 1e6 << " M tokens/s ("
+              << bestSeconds * 1000 << " ms)" << std::endl;
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include <map>
 #include <iomanip> // For file output formatting if needed
 #include <chrono>
+#include <thread>
 
 #include "../common/token.h" // May need TokenType if IR uses it
 #include "../common/ast.h"   // Needs AST node definitions to parse IR
@@ -19,149 +20,22 @@
 // All deserialization is now handled by the functions declared in json_deserializer.h
 // and implemented in json_deserializer.cpp
 
-// --- Code Generation Logic (Placeholders) --- 
-
-// TODO: Implement code generation visitors/functions for each language
-// Forward declare visitors
-class JavaCodeGenerator;
-class PythonCodeGenerator;
-class CppCodeGenerator;
-class JavaScriptCodeGenerator;
-
-// --- Base Code Generator Visitor (using accept pattern) ---
-// Add accept methods to AST nodes if not already present
-// Modify ast.h if needed, e.g.:
-/*
-struct Expression {
-    virtual ~Expression() = default;
-    virtual std::string accept(CodeGeneratorVisitor& visitor) = 0; 
-    ...
-};
-*/
-// For now, we'll use dynamic_cast in the visitor.
-
-class CodeGeneratorVisitor {
-public:
-    virtual ~CodeGeneratorVisitor() = default;
-    virtual std::string generate(ASTNode* node) = 0;
-    
-protected:
-    // Common utilities or state if needed
-    int indentLevel = 0;
-    std::string getIndent() {
-        return std::string(indentLevel * 4, ' ');
-    }
-    
-    // Visitor methods to be implemented by subclasses
-    virtual std::string visitProgram(ProgramNode* node) = 0;
-    virtual std::string visitStyleInclude(StyleIncludeStmt* node) = 0;
-    virtual std::string visitGardenDecl(GardenDeclStmt* node) = 0;
-    virtual std::string visitSpeciesDecl(SpeciesDeclStmt* node) = 0;
-    virtual std::string visitVisibilityBlock(VisibilityBlockStmt* node) = 0;
-    virtual std::string visitBlock(BlockStmt* node) = 0;
-    virtual std::string visitVariableDecl(VariableDeclStmt* node) = 0;
-    virtual std::string visitFunctionDef(FunctionDefStmt* node) = 0;
-    virtual std::string visitReturn(ReturnStmt* node) = 0;
-    virtual std::string visitExpressionStmt(ExpressionStmt* node) = 0;
-    virtual std::string visitBranch(BranchStmt* node) = 0;
-    virtual std::string visitIO(IOStmt* node) = 0;
-    
-    virtual std::string visitWhileStmt(WhileStmt* node) = 0;
-    virtual std::string visitForStmt(ForStmt* node) = 0;
-    
-    virtual std::string visitIdentifierExpr(IdentifierExpr* node) = 0;
-    virtual std::string visitNumberLiteralExpr(NumberLiteralExpr* node) = 0;
-    virtual std::string visitStringLiteralExpr(StringLiteralExpr* node) = 0;
-    virtual std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) = 0;
-    virtual std::string visitBinaryOpExpr(BinaryOpExpr* node) = 0;
-    virtual std::string visitFunctionCallExpr(FunctionCallExpr* node) = 0;
-    virtual std::string visitMemberAccessExpr(MemberAccessExpr* node) = 0;
-    virtual std::string visitAssignmentStmt(AssignmentStmt* node) = 0;
-    virtual std::string visitFloatLiteralExpr(FloatLiteralExpr* node) = 0;
-    virtual std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) = 0;
-    
-    // Generic dispatch using dynamic_cast
-     std::string dispatch(ASTNode* node) {
-         if (!node) return "";
-         if (auto* p = dynamic_cast<ProgramNode*>(node)) return visitProgram(p);
-         if (auto* p = dynamic_cast<StyleIncludeStmt*>(node)) return visitStyleInclude(p);
-         if (auto* p = dynamic_cast<GardenDeclStmt*>(node)) return visitGardenDecl(p);
-         if (auto* p = dynamic_cast<SpeciesDeclStmt*>(node)) return visitSpeciesDecl(p);
-         if (auto* p = dynamic_cast<VisibilityBlockStmt*>(node)) return visitVisibilityBlock(p);
-         if (auto* p = dynamic_cast<BlockStmt*>(node)) return visitBlock(p);
-         if (auto* p = dynamic_cast<VariableDeclStmt*>(node)) return visitVariableDecl(p);
-         if (auto* p = dynamic_cast<FunctionDefStmt*>(node)) return visitFunctionDef(p);
-         if (auto* p = dynamic_cast<ReturnStmt*>(node)) return visitReturn(p);
-         if (auto* p = dynamic_cast<ExpressionStmt*>(node)) return visitExpressionStmt(p);
-         if (auto* p = dynamic_cast<BranchStmt*>(node)) return visitBranch(p);
-         if (auto* p = dynamic_cast<IOStmt*>(node)) return visitIO(p);
-         
-         if (auto* p = dynamic_cast<WhileStmt*>(node)) return visitWhileStmt(p);
-         if (auto* p = dynamic_cast<ForStmt*>(node)) return visitForStmt(p);
-         
-         // Expressions (need to handle them within statements/other expressions)
-         if (auto* p = dynamic_cast<IdentifierExpr*>(node)) return visitIdentifierExpr(p);
-         if (auto* p = dynamic_cast<NumberLiteralExpr*>(node)) return visitNumberLiteralExpr(p);
-         if (auto* p = dynamic_cast<StringLiteralExpr*>(node)) return visitStringLiteralExpr(p);
-         if (auto* p = dynamic_cast<BooleanLiteralExpr*>(node)) return visitBooleanLiteralExpr(p);
-         if (auto* p = dynamic_cast<BinaryOpExpr*>(node)) return visitBinaryOpExpr(p);
-         if (auto* p = dynamic_cast<FunctionCallExpr*>(node)) return visitFunctionCallExpr(p);
-         if (auto* p = dynamic_cast<MemberAccessExpr*>(node)) return visitMemberAccessExpr(p);
-         if (auto* p = dynamic_cast<AssignmentStmt*>(node)) return visitAssignmentStmt(p);
-         if (auto* p = dynamic_cast<FloatLiteralExpr*>(node)) return visitFloatLiteralExpr(p);
-         if (auto* p = dynamic_cast<DoubleLiteralExpr*>(node)) return visitDoubleLiteralExpr(p);
-         
-         std::cerr << "Error: CodeGen dispatch failed for node type." << std::endl;
-         return "/* Error: Unsupported Node */";
-     }
-     
-     std::string dispatchExpr(Expression* node) {
-          // Specifically for expressions, ensures we don't accidentally dispatch statements
-           if (!node) return "";
-           if (auto* p = dynamic_cast<IdentifierExpr*>(node)) return visitIdentifierExpr(p);
-           if (auto* p = dynamic_cast<NumberLiteralExpr*>(node)) return visitNumberLiteralExpr(p);
-           if (auto* p = dynamic_cast<StringLiteralExpr*>(node)) return visitStringLiteralExpr(p);
-           if (auto* p = dynamic_cast<BooleanLiteralExpr*>(node)) return visitBooleanLiteralExpr(p);
-           if (auto* p = dynamic_cast<BinaryOpExpr*>(node)) return visitBinaryOpExpr(p);
-           if (auto* p = dynamic_cast<FunctionCallExpr*>(node)) return visitFunctionCallExpr(p);
-           if (auto* p = dynamic_cast<MemberAccessExpr*>(node)) return visitMemberAccessExpr(p);
-           if (auto* p = dynamic_cast<AssignmentStmt*>(node)) return visitAssignmentStmt(p);
-           if (auto* p = dynamic_cast<FloatLiteralExpr*>(node)) return visitFloatLiteralExpr(p);
-           if (auto* p = dynamic_cast<DoubleLiteralExpr*>(node)) return visitDoubleLiteralExpr(p);
-           
-           std::cerr << "Error: CodeGen dispatch failed for expression type." << std::endl;
-           return "/* Error: Unsupported Expression */";
-     }
-};
-
-// --- Language-Specific Generators (Implementations) --- 
-
-// TODO: Implement the visit methods for each language
-
-#include "generators/JavaCodeGenerator.cpp" 
-#include "generators/PythonCodeGenerator.cpp"
-#include "generators/CppCodeGenerator.cpp"
-#include "generators/JavaScriptCodeGenerator.cpp"
-
-// Helper to write string content to a file
-bool writeToFile(const std::string& filename, const std::string& content) {
-    std::ofstream outFile(filename);
-    if (!outFile) {
-        std::cerr << "Error: Could not open output file: " << filename << std::endl;
-        return false;
-    }
-    outFile << content;
-    outFile.close();
-    std::cout << "Successfully wrote code to " << filename << std::endl;
-    return true;
-}
+#include "codegen.h" // CodeGeneratorVisitor, the language generators and writeToFile
 
 int main(int argc, char* argv[]) {
     std::string inputFilename = "input/input.ir"; // Default input IR file
     std::string outputDir = "output/";        // Default output directory
 
-    if (argc > 1) {
-        inputFilename = std::string(argv[1]);
+    // Usage: codegen_executable [input] [--log=level]
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (!applyLogFlag(arg)) {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() > 0) {
+        inputFilename = positional[0];
     }
     // Optional: Specify output directory?
     // if (argc > 2) { outputDir = std::string(argv[2]); }
@@ -169,32 +43,18 @@ int main(int argc, char* argv[]) {
     std::cout << "Code Generation Module" << std::endl;
     std::cout << "Reading IR from: " << inputFilename << std::endl;
 
-    // Read JSON IR file
-    std::ifstream inFile(inputFilename);
-    if (!inFile) {
-        std::cerr << "Error: Could not open input IR file: " << inputFilename << std::endl;
-        return 1;
-    }
-    nlohmann::json irJson;
-    try {
-        inFile >> irJson;
-    } catch (nlohmann::json::parse_error& e) {
-        std::cerr << "Error: Failed to parse input IR JSON: " << e.what() << std::endl;
-        return 1;
-    }
-    inFile.close();
-
     std::cout << "Deserializing IR (AST)..." << std::endl;
 
     //start_time
     auto start_time = std::chrono::steady_clock::now();
     
-    std::unique_ptr<ASTNode> astRoot = nullptr;
+    Arena astArena; // Owns every node of the loaded IR
+    NodePtr<ASTNode> astRoot = nullptr;
     try {
-         // Use the shared deserializer
-         astRoot = fromJson(irJson); 
+         // Use the shared loader (binary IR or JSON dump, detected from the file header)
+         astRoot = readAstFile(inputFilename, astArena); 
     } catch (const std::exception& e) {
-         std::cerr << "Error during IR deserialization: " << e.what() << std::endl;
+         LOG_ERROR("Error: Failed to read input IR: " << e.what());
 
         //end_time
         auto end_time = std::chrono::steady_clock::now();
@@ -203,7 +63,7 @@ int main(int argc, char* argv[]) {
     }
     
     if (!astRoot) {
-        std::cerr << "Error: Failed to deserialize IR from JSON." << std::endl;
+        LOG_ERROR("Error: Failed to deserialize IR.");
 
         //end_time
         auto end_time = std::chrono::steady_clock::now();
@@ -211,9 +71,9 @@ int main(int argc, char* argv[]) {
         return 1;
     }
      // Expect ProgramNode as root
-     ProgramNode* programRoot = dynamic_cast<ProgramNode*>(astRoot.get());
+     ProgramNode* programRoot = nodeCast<ProgramNode>(astRoot.get());
      if (!programRoot) {
-          std::cerr << "Error: Deserialized IR root is not a ProgramNode." << std::endl;
+          LOG_ERROR("Error: Deserialized IR root is not a ProgramNode.");
 
             //end_time
         auto end_time = std::chrono::steady_clock::now();
@@ -222,7 +82,16 @@ int main(int argc, char* argv[]) {
      }
 
     std::cout << "Generating code for multiple languages..." << std::endl;
-    bool success = true;
+
+    // The generators share nothing but the tree, which they only read: their
+    // state is all members, and Symbol text lookups are lock-free. So each
+    // target is generated into its own buffer and written to its own file on
+    // its own thread; the results are reported in the usual order afterwards.
+    struct TargetOutput {
+        std::string filename;
+        bool written = false;
+    };
+    TargetOutput javaOutput, pythonOutput, cppOutput, jsOutput;
 
     // Create generator instances
     JavaCodeGenerator javaGen;
@@ -231,24 +100,42 @@ int main(int argc, char* argv[]) {
     JavaScriptCodeGenerator jsGen;
 
     // Generate Java
-    std::string javaCode = javaGen.generate(programRoot);
-    std::string javaClassName = javaGen.getClassName();
-    success &= writeToFile(outputDir + javaClassName + ".java", javaCode);
+    std::thread javaThread([&] {
+        std::string javaCode = javaGen.generate(programRoot);
+        javaOutput.filename = outputDir + javaGen.getClassName() + ".java";
+        javaOutput.written = writeFileContents(javaOutput.filename, javaCode);
+    });
 
     // Generate Python
-    std::string pythonCode = pythonGen.generate(programRoot);
-    success &= writeToFile(outputDir + "output.py", pythonCode);
+    std::thread pythonThread([&] {
+        pythonOutput.filename = outputDir + "output.py";
+        pythonOutput.written = writeFileContents(pythonOutput.filename, pythonGen.generate(programRoot));
+    });
 
     // Generate C++
-    std::string cppCode = cppGen.generate(programRoot);
-    success &= writeToFile(outputDir + "output.cpp", cppCode);
+    std::thread cppThread([&] {
+        cppOutput.filename = outputDir + "output.cpp";
+        cppOutput.written = writeFileContents(cppOutput.filename, cppGen.generate(programRoot));
+    });
+
+    // Generate JavaScript (on this thread)
+    jsOutput.filename = outputDir + "output.js";
+    jsOutput.written = writeFileContents(jsOutput.filename, jsGen.generate(programRoot));
 
-    // Generate JavaScript
-    std::string jsCode = jsGen.generate(programRoot);
-    success &= writeToFile(outputDir + "output.js", jsCode);
+    javaThread.join();
+    pythonThread.join();
+    cppThread.join();
+
+    bool success = true;
+    for (const TargetOutput* output : {&javaOutput, &pythonOutput, &cppOutput, &jsOutput}) {
+        if (output->written) {
+            std::cout << "Successfully wrote code to " << output->filename << std::endl;
+        }
+        success &= output->written;
+    }
 
     if (!success) {
-        std::cerr << "Code generation failed for one or more languages." << std::endl;
+        LOG_ERROR("Code generation failed for one or more languages.");
 
         //end_time
         auto end_time = std::chrono::steady_clock::now();
@@ -0,0 +1,85 @@
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "../common/token.h"
+#include "../common/ast.h"   // Needs AST node definitions
+#include "../common/ast_visitor.h"
+#include "../common/log.h"
+
+// The visitor base and the four language generators are shared by the
+// standalone codegen_executable and the in-process hanamic driver.
+
+// --- Code Generation Logic (Placeholders) --- 
+
+// TODO: Implement code generation visitors/functions for each language
+// Forward declare visitors
+class JavaCodeGenerator;
+class PythonCodeGenerator;
+class CppCodeGenerator;
+class JavaScriptCodeGenerator;
+
+// --- Base Code Generator Visitor ---
+// Dispatch comes from ASTVisitor (common/ast_visitor.h): one switch on the
+// node's kind, resolved at compile time to the generator's visitXxx() methods.
+// Each generator derives as  class XCodeGenerator : public CodeGeneratorVisitor<XCodeGenerator>
+// and befriends ASTVisitor<XCodeGenerator, std::string> so its visit methods can stay private.
+
+template <typename Derived>
+class CodeGeneratorVisitor : public ASTVisitor<Derived, std::string> {
+protected:
+    // Common utilities or state if needed
+    int indentLevel = 0;
+    std::string getIndent() {
+        return std::string(indentLevel * 4, ' ');
+    }
+
+    std::string visitUnsupported(ASTNode* node) {
+        LOG_ERROR("Error: CodeGen dispatch failed for node type " << node->kindName() << ".");
+        return "/* Error: Unsupported Node */";
+    }
+
+    std::string visitUnsupportedExpr(Expression* node) {
+        LOG_ERROR("Error: CodeGen dispatch failed for expression type " << node->kindName() << ".");
+        return "/* Error: Unsupported Expression */";
+    }
+};
+
+// --- Language-Specific Generators (Implementations) --- 
+
+// TODO: Implement the visit methods for each language
+
+#include "generators/JavaCodeGenerator.cpp" 
+#include "generators/PythonCodeGenerator.cpp"
+#include "generators/CppCodeGenerator.cpp"
+#include "generators/JavaScriptCodeGenerator.cpp"
+
+// Writes content to filename, reporting only failures, so several threads
+// can write their own files at once
+inline bool writeFileContents(const std::string& filename, const std::string& content) {
+    std::ofstream outFile(filename);
+    if (!outFile) {
+        LOG_ERROR("Error: Could not open output file: " << filename);
+        return false;
+    }
+    outFile << content;
+    outFile.close();
+    return true;
+}
+
+// Helper to write string content to a file
+inline bool writeToFile(const std::string& filename, const std::string& content) {
+    if (!writeFileContents(filename, content)) {
+        return false;
+    }
+    std::cout << "Successfully wrote code to " << filename << std::endl;
+    return true;
+}
+
+#endif // CODEGEN_H
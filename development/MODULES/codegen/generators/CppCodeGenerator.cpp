@@ -5,11 +5,22 @@
 #include <stdexcept>
 #include <set> // For tracking includes
 
-class CppCodeGenerator : public CodeGeneratorVisitor {
+class CppCodeGenerator : public CodeGeneratorVisitor<CppCodeGenerator> {
+    friend class ASTVisitor<CppCodeGenerator, std::string>; // dispatch() calls the private visit methods
 public:
-    std::string generate(ASTNode* node) override {
+    std::string generate(ASTNode* node) {
+        begin();
+        // Visit the AST to determine required headers & generate code structure
+        bodyCode_ += dispatch(node); // visitProgram adds each top-level statement
+        return finish();
+    }
+
+    // generate() for a program that arrives one top-level declaration at a
+    // time: begin(), then addDeclaration() for each, then finish().
+    void begin() {
         generatedCode_.str("");
         generatedCode_.clear();
+        bodyCode_.clear();
         includes_.clear();
         indentLevel = 0;
         hasMain_ = false;
@@ -18,18 +29,21 @@ public:
         includes_.insert("#include <iostream>");
         includes_.insert("#include <string>");
         includes_.insert("#include <vector>"); // Basic includes
-        
-        // Visit the AST to determine required headers & generate code structure
-        std::string bodyCode = dispatch(node);
-        
-        // Write includes first
+    }
+
+    void addDeclaration(Statement* stmt) {
+        bodyCode_ += dispatch(stmt);
+    }
+
+    std::string finish() {
+        // Write includes first (collected from the whole body)
         for (const auto& include : includes_) {
             generatedCode_ << include << "\n";
         }
         generatedCode_ << "\n";
         
         // Write the generated body code
-        generatedCode_ << bodyCode;
+        generatedCode_ << bodyCode_;
         
         // Add a default main if none was found
         if (!hasMain_) {
@@ -44,6 +58,7 @@ public:
 
 private:
     std::stringstream generatedCode_;
+    std::string bodyCode_; // Declarations so far; the includes go above them
     std::set<std::string> includes_;
     bool hasMain_ = false;
 
@@ -83,15 +98,14 @@ private:
     }
     
     // --- Visitor Implementations --- 
-    std::string visitProgram(ProgramNode* node) override {
-        std::string code = "";
+    std::string visitProgram(ProgramNode* node) {
         for (const auto& stmt : node->statements) {
-            code += dispatch(stmt.get());
+            addDeclaration(stmt.get());
         }
-        return code; 
+        return ""; // Handled by generate()
     }
 
-    std::string visitStyleInclude(StyleIncludeStmt* node) override { 
+    std::string visitStyleInclude(StyleIncludeStmt* node) { 
         // Try to map to C++ includes
         // Needs careful handling of quotes and path vs library
         std::string path = node->path;
@@ -108,11 +122,11 @@ private:
         return ""; // Include is added at the top level
     }
     
-    std::string visitGardenDecl(GardenDeclStmt* node) override { 
+    std::string visitGardenDecl(GardenDeclStmt* node) { 
         return "// Garden: " + node->name + " (namespace omitted for simplicity)\n"; 
     }
 
-    std::string visitSpeciesDecl(SpeciesDeclStmt* node) override {
+    std::string visitSpeciesDecl(SpeciesDeclStmt* node) {
         std::string speciesCode;
         speciesCode += getIndent() + "struct " + node->name + " {\n"; // Use struct for simplicity
         indentLevel++;
@@ -127,7 +141,7 @@ private:
         return speciesCode;
     }
 
-    std::string visitVisibilityBlock(VisibilityBlockStmt* node) override {
+    std::string visitVisibilityBlock(VisibilityBlockStmt* node) {
         // Add C++ access specifiers
         std::string code = "";
         switch(node->visibility) {
@@ -145,7 +159,7 @@ private:
         return code;
     }
 
-    std::string visitBlock(BlockStmt* node) override {
+    std::string visitBlock(BlockStmt* node) {
         std::string blockCode = "";
         // C++ needs braces for blocks
         // blockCode += getIndent() + "{\n"; 
@@ -159,7 +173,7 @@ private:
         return blockCode;
     }
 
-    std::string visitVariableDecl(VariableDeclStmt* node) override {
+    std::string visitVariableDecl(VariableDeclStmt* node) {
         std::string code = getIndent();
         code += mapType(node->typeName) + " " + node->varName;
         if (node->initializer) {
@@ -169,7 +183,7 @@ private:
         return code;
     }
 
-    std::string visitFunctionDef(FunctionDefStmt* node) override {
+    std::string visitFunctionDef(FunctionDefStmt* node) {
          std::string code = getIndent();
           bool isMain = (node->name == "mainGarden" || node->name == "main");
           if (isMain) {
@@ -195,7 +209,7 @@ private:
              bool hasReturn = false;
               if(node->body){
                  for(const auto& stmt : node->body->statements){
-                     if(dynamic_cast<ReturnStmt*>(stmt.get())) { hasReturn = true; break; }
+                     if(nodeCast<ReturnStmt>(stmt.get())) { hasReturn = true; break; }
                  }
               }
              if (!hasReturn) code += getIndent() + "return 0;\n";
@@ -205,7 +219,7 @@ private:
          return code;
     }
 
-    std::string visitReturn(ReturnStmt* node) override {
+    std::string visitReturn(ReturnStmt* node) {
          std::string code = getIndent() + "return";
          if (node->returnValue) {
              code += " " + dispatchExpr(node->returnValue.get());
@@ -214,11 +228,11 @@ private:
          return code;
     }
 
-    std::string visitExpressionStmt(ExpressionStmt* node) override {
+    std::string visitExpressionStmt(ExpressionStmt* node) {
          return getIndent() + dispatchExpr(node->expression.get()) + ";\n";
     }
 
-    std::string visitBranch(BranchStmt* node) override {
+    std::string visitBranch(BranchStmt* node) {
          std::string code = "";
          bool first = true;
          for(const auto& branch : node->branches) {
@@ -248,7 +262,7 @@ private:
          return code;
     }
 
-    std::string visitIO(IOStmt* node) override {
+    std::string visitIO(IOStmt* node) {
          includes_.insert("#include <iostream>"); // Ensure iostream
          std::string code = "";
          std::string stream = (node->ioType == TokenType::BLOOM) ? "std::cout" : "std::cin";
@@ -267,23 +281,23 @@ private:
     }
     
     // --- Expression Visitors ---
-     std::string visitIdentifierExpr(IdentifierExpr* node) override { 
+     std::string visitIdentifierExpr(IdentifierExpr* node) { 
          return node->name;
      }
      
-     std::string visitNumberLiteralExpr(NumberLiteralExpr* node) override { return node->value.empty() ? "0" : node->value; }
+     std::string visitNumberLiteralExpr(NumberLiteralExpr* node) { return node->value.empty() ? "0" : node->value; }
      
-     std::string visitFloatLiteralExpr(FloatLiteralExpr* node) override {
+     std::string visitFloatLiteralExpr(FloatLiteralExpr* node) {
          // C++ requires 'f' suffix for float literals
          return node->value + "f";
      }
      
-     std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) override {
+     std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) {
          // Standard double literal format in C++
          return node->value;
      }
      
-     std::string visitStringLiteralExpr(StringLiteralExpr* node) override { 
+     std::string visitStringLiteralExpr(StringLiteralExpr* node) { 
           includes_.insert("#include <string>");
           std::string escapedValue = "";
           for (char c : node->value) {
@@ -297,15 +311,15 @@ private:
           }
           return "std::string(\"" + escapedValue + "\")"; // Construct std::string with escaped value
      }
-     std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) override { return node->value ? "true" : "false"; }
+     std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) { return node->value ? "true" : "false"; }
      
-     std::string visitBinaryOpExpr(BinaryOpExpr* node) override {
+     std::string visitBinaryOpExpr(BinaryOpExpr* node) {
           return "(" + dispatchExpr(node->left.get()) + " " + 
                      mapBinaryOperator(node->op) + " " + 
                      dispatchExpr(node->right.get()) + ")";
      }
      
-     std::string visitFunctionCallExpr(FunctionCallExpr* node) override {
+     std::string visitFunctionCallExpr(FunctionCallExpr* node) {
          std::string code = dispatchExpr(node->callee.get()) + "(";
           for (size_t i = 0; i < node->arguments.size(); ++i) {
              code += dispatchExpr(node->arguments[i].get());
@@ -315,16 +329,16 @@ private:
          return code;
      }
      
-     std::string visitMemberAccessExpr(MemberAccessExpr* node) override {
+     std::string visitMemberAccessExpr(MemberAccessExpr* node) {
          // Use . for objects/structs, -> for pointers (assume objects for now)
          return dispatchExpr(node->object.get()) + "." + node->member->name;
      }
      
-      std::string visitAssignmentStmt(AssignmentStmt* node) override {
+      std::string visitAssignmentStmt(AssignmentStmt* node) {
           return dispatchExpr(node->left.get()) + " = " + dispatchExpr(node->right.get());
       }
 
-    std::string visitWhileStmt(WhileStmt* node) override {
+    std::string visitWhileStmt(WhileStmt* node) {
         std::string code = getIndent() + "while (";
         if (node->condition) code += dispatchExpr(node->condition.get());
         code += ") {\n";
@@ -335,7 +349,7 @@ private:
         return code;
     }
 
-    std::string visitForStmt(ForStmt* node) override {
+    std::string visitForStmt(ForStmt* node) {
         std::string code = getIndent() + "for (";
         if (node->initializer) {
             // Need to handle potential semicolon from VariableDecl
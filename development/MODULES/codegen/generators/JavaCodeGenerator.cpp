@@ -5,49 +5,58 @@
 #include <stdexcept>
 #include <map>
 
-class JavaCodeGenerator : public CodeGeneratorVisitor {
+class JavaCodeGenerator : public CodeGeneratorVisitor<JavaCodeGenerator> {
+    friend class ASTVisitor<JavaCodeGenerator, std::string>; // dispatch() calls the private visit methods
 public:
-    std::string generate(ASTNode* node) override {
+    std::string generate(ASTNode* node) {
+        begin();
+        dispatch(node); // visitProgram adds each top-level statement
+        return finish();
+    }
+
+    // generate() for a program that arrives one top-level declaration at a
+    // time: begin(), then addDeclaration() for each, then finish().
+    void begin() {
         // Reset state for new generation if needed
         generatedCode_.str(""); 
         generatedCode_.clear();
-        std::string gardenName = ""; // Find garden name
+        gardenName_ = ""; // Set by the first garden declaration
         hasMain_ = false;
-        indentLevel = 0;
+        indentLevel = 1; // Declarations go inside the class that finish() wraps around them
         currentSpeciesName_ = ""; // Reset context
-        
-        // Find Garden name
-        if(auto* p = dynamic_cast<ProgramNode*>(node)){
-             for(const auto& stmt : p->statements){
-                 if(auto* g = dynamic_cast<GardenDeclStmt*>(stmt.get())){
-                     gardenName = g->name;
-                     break;
-                 }
-             }
+    }
+
+    void addDeclaration(Statement* stmt) {
+        if (gardenName_.empty()) {
+            if (auto* g = nodeCast<GardenDeclStmt>(stmt)) {
+                gardenName_ = g->name;
+            }
         }
-        
+        generatedCode_ << dispatch(stmt);
+    }
+
+    std::string finish() {
         // Determine class name: Use garden name directly
-        className_ = gardenName.empty() ? "GeneratedHanamiClass" : gardenName;
+        className_ = gardenName_.empty() ? "GeneratedHanamiClass" : gardenName_;
 
+        std::stringstream code;
         // Add imports
-        generatedCode_ << "// Converting Hanami code to Java\n";
-        generatedCode_ << "import java.util.Scanner;\n\n";
+        code << "// Converting Hanami code to Java\n";
+        code << "import java.util.Scanner;\n\n";
         
         // Create the class declaration
-        generatedCode_ << "public class " << className_ << " {\n";
-        indentLevel++;
+        code << "public class " << className_ << " {\n";
 
         // Add a static Scanner instance for input
-        generatedCode_ << getIndent() << "private static Scanner inputScanner = new Scanner(System.in);\n\n";
-        
-        // Process all AST nodes
-        dispatch(node);
-        
+        code << "    private static Scanner inputScanner = new Scanner(System.in);\n\n";
+
+        code << generatedCode_.str();
+
         // Add the final closing brace for the main class
-        indentLevel--; 
-        generatedCode_ << getIndent() << "}\n";
+        indentLevel = 0;
+        code << "}\n";
         
-        return generatedCode_.str();
+        return code.str();
     }
 
     // Getter for the determined class name
@@ -58,6 +67,7 @@ public:
 private:
     std::stringstream generatedCode_;
     std::string className_ = "GeneratedHanamiClass";
+    std::string gardenName_;
     std::string currentSpeciesName_ = ""; // Track context
     bool hasMain_ = false;
     int indentLevel = 0;
@@ -111,22 +121,22 @@ private:
     }
 
     // --- Visitor Implementations --- 
-    std::string visitProgram(ProgramNode* node) override {
+    std::string visitProgram(ProgramNode* node) {
         for (const auto& stmt : node->statements) {
-            generatedCode_ << dispatch(stmt.get());
+            addDeclaration(stmt.get());
         }
         return ""; // Handled by generate()
     }
 
-    std::string visitStyleInclude(StyleIncludeStmt* node) override { 
+    std::string visitStyleInclude(StyleIncludeStmt* node) { 
         return ""; // Ignore includes in Java
     }
     
-    std::string visitGardenDecl(GardenDeclStmt* node) override { 
+    std::string visitGardenDecl(GardenDeclStmt* node) { 
         return ""; // Already handled in generate()
     }
 
-    std::string visitSpeciesDecl(SpeciesDeclStmt* node) override {
+    std::string visitSpeciesDecl(SpeciesDeclStmt* node) {
         // Generate a class for the species
         std::string speciesCode;
         speciesCode += getIndent() + "static class " + node->name + " {\n";
@@ -141,10 +151,10 @@ private:
             speciesMemberTypes_[node->name] = {}; // Ensure map entry exists
         }
         for (const auto& section : node->sections) {
-            if (auto* visBlock = dynamic_cast<VisibilityBlockStmt*>(section.get())) {
+            if (auto* visBlock = nodeCast<VisibilityBlockStmt>(section.get())) {
                 if(visBlock->block){
                     for (const auto& stmt : visBlock->block->statements) {
-                        if (auto* varDecl = dynamic_cast<VariableDeclStmt*>(stmt.get())) {
+                        if (auto* varDecl = nodeCast<VariableDeclStmt>(stmt.get())) {
                             speciesMemberTypes_[node->name][varDecl->varName] = mapType(varDecl->typeName);
                         }
                     }
@@ -156,11 +166,11 @@ private:
         TokenType currentVisibility = TokenType::HIDDEN; // Default to private
         
         for (const auto& section : node->sections) {
-            if (auto* visBlock = dynamic_cast<VisibilityBlockStmt*>(section.get())) {
+            if (auto* visBlock = nodeCast<VisibilityBlockStmt>(section.get())) {
                 currentVisibility = visBlock->visibility;
                 for (const auto& stmt : visBlock->block->statements) {
                     // Apply visibility modifier to each statement in the block
-                    if (auto* varDecl = dynamic_cast<VariableDeclStmt*>(stmt.get())) {
+                    if (auto* varDecl = nodeCast<VariableDeclStmt>(stmt.get())) {
                         speciesCode += getIndent();
                         switch (currentVisibility) {
                             case TokenType::OPEN: speciesCode += "public "; break;
@@ -174,7 +184,7 @@ private:
                         }
                         speciesCode += ";\n";
                     }
-                    else if (auto* funcDef = dynamic_cast<FunctionDefStmt*>(stmt.get())) {
+                    else if (auto* funcDef = nodeCast<FunctionDefStmt>(stmt.get())) {
                         speciesCode += getIndent();
                         switch (currentVisibility) {
                             case TokenType::OPEN: speciesCode += "public "; break;
@@ -198,7 +208,7 @@ private:
                               speciesMemberTypes_[node->name] = {}; // Ensure map exists
                            }
                            for(const auto& bodyStmt : funcDef->body->statements){
-                               if (auto* memberVarDecl = dynamic_cast<VariableDeclStmt*>(bodyStmt.get())){
+                               if (auto* memberVarDecl = nodeCast<VariableDeclStmt>(bodyStmt.get())){
                                    speciesMemberTypes_[node->name][memberVarDecl->varName] = mapType(memberVarDecl->typeName);
                                }
                                speciesCode += dispatch(bodyStmt.get());
@@ -225,12 +235,12 @@ private:
         return speciesCode;
     }
 
-    std::string visitVisibilityBlock(VisibilityBlockStmt* node) override {
+    std::string visitVisibilityBlock(VisibilityBlockStmt* node) {
         // This is now handled in visitSpeciesDecl for better visibility control
         return "";
     }
 
-    std::string visitBlock(BlockStmt* node) override {
+    std::string visitBlock(BlockStmt* node) {
         std::string blockCode = "";
         for (const auto& stmt : node->statements) {
              blockCode += dispatch(stmt.get());
@@ -238,7 +248,7 @@ private:
         return blockCode;
     }
 
-    std::string visitVariableDecl(VariableDeclStmt* node) override {
+    std::string visitVariableDecl(VariableDeclStmt* node) {
         // Store type for later lookup (e.g., for input parsing)
         variableTypes_[node->varName] = mapType(node->typeName);
 
@@ -248,7 +258,7 @@ private:
         
         if (node->initializer) {
             code += " = " + dispatchExpr(node->initializer.get());
-        } else if (!node->typeName.empty() && std::isupper(node->typeName[0])) {
+        } else if (!node->typeName.empty() && std::isupper(node->typeName.view()[0])) {
             // Initialize object types
             code += " = new " + javaType + "()";
         }
@@ -257,7 +267,7 @@ private:
         return code;
     }
 
-    std::string visitFunctionDef(FunctionDefStmt* node) override {
+    std::string visitFunctionDef(FunctionDefStmt* node) {
         std::string code = ""; // Start empty, add indent per line
         variableTypes_.clear(); // Clear types for new function scope
 
@@ -279,7 +289,7 @@ private:
             if (node->body) {
                 for (const auto& stmt_ptr : node->body->statements) {
                     // Special handling for return in main -> System.exit()
-                    if (auto* returnStmt = dynamic_cast<ReturnStmt*>(stmt_ptr.get())) {
+                    if (auto* returnStmt = nodeCast<ReturnStmt>(stmt_ptr.get())) {
                         if (returnStmt->returnValue) {
                             code += getIndent() + "System.exit(" + dispatchExpr(returnStmt->returnValue.get()) + ");\n";
                         } else {
@@ -326,7 +336,7 @@ private:
         }
     }
 
-    std::string visitReturn(ReturnStmt* node) override {
+    std::string visitReturn(ReturnStmt* node) {
         std::string code = getIndent() + "return";
         if (node->returnValue) {
             code += " " + dispatchExpr(node->returnValue.get());
@@ -335,11 +345,11 @@ private:
         return code;
     }
 
-    std::string visitExpressionStmt(ExpressionStmt* node) override {
+    std::string visitExpressionStmt(ExpressionStmt* node) {
         return getIndent() + dispatchExpr(node->expression.get()) + ";\n";
     }
 
-    std::string visitBranch(BranchStmt* node) override {
+    std::string visitBranch(BranchStmt* node) {
         std::string code = "";
         bool first = true;
         
@@ -387,7 +397,7 @@ private:
         return code;
     }
 
-    std::string visitIO(IOStmt* node) override {
+    std::string visitIO(IOStmt* node) {
         std::string code = ""; // Start empty, add indent per line
 
         if (node->ioType == TokenType::BLOOM) { // Output
@@ -402,7 +412,7 @@ private:
         } else if (node->ioType == TokenType::WATER) { // Input
             for (const auto& expr : node->expressions) {
                  std::string lineCode = getIndent(); // Indent each assignment line
-                if (IdentifierExpr* ident = dynamic_cast<IdentifierExpr*>(expr.get())) {
+                if (IdentifierExpr* ident = nodeCast<IdentifierExpr>(expr.get())) {
                     std::string varName = ident->name;
                     std::string targetType = "";
 
@@ -430,11 +440,11 @@ private:
                     } else { // Default to String or completely unknown type
                          lineCode += "inputScanner.nextLine(); // Assumed String or unknown type ('"+targetType+"')\n";
                     }
-                } else if (MemberAccessExpr* member = dynamic_cast<MemberAccessExpr*>(expr.get())) {
+                } else if (MemberAccessExpr* member = nodeCast<MemberAccessExpr>(expr.get())) {
                     // Determine object type (using heuristic)
                     std::string objectTypeName = "";
                      // First check if the object is an identifier we know the type of
-                    if(IdentifierExpr* objIdent = dynamic_cast<IdentifierExpr*>(member->object.get())){
+                    if(IdentifierExpr* objIdent = nodeCast<IdentifierExpr>(member->object.get())){
                         if(variableTypes_.count(objIdent->name)){
                             objectTypeName = variableTypes_[objIdent->name]; // Get mapped Java type
                         }
@@ -475,62 +485,37 @@ private:
         return code;
     }
     
-    // Expression dispatch helper
+    // Expression dispatch helper (missing or unknown expressions become a comment)
     std::string dispatchExpr(Expression* expr) {
-        if (auto* ident = dynamic_cast<IdentifierExpr*>(expr)) {
-            return visitIdentifierExpr(ident);
-        }
-        else if (auto* num = dynamic_cast<NumberLiteralExpr*>(expr)) {
-            return visitNumberLiteralExpr(num);
-        }
-        else if (auto* str = dynamic_cast<StringLiteralExpr*>(expr)) {
-            return visitStringLiteralExpr(str);
-        }
-        else if (auto* boolean = dynamic_cast<BooleanLiteralExpr*>(expr)) {
-            return visitBooleanLiteralExpr(boolean);
-        }
-        else if (auto* binary = dynamic_cast<BinaryOpExpr*>(expr)) {
-            return visitBinaryOpExpr(binary);
-        }
-        else if (auto* call = dynamic_cast<FunctionCallExpr*>(expr)) {
-            return visitFunctionCallExpr(call);
-        }
-        else if (auto* access = dynamic_cast<MemberAccessExpr*>(expr)) {
-            return visitMemberAccessExpr(access);
-        }
-        else if (auto* assign = dynamic_cast<AssignmentStmt*>(expr)) {
-            return visitAssignmentStmt(assign);
-        }
-        else if (auto* flt = dynamic_cast<FloatLiteralExpr*>(expr)) {
-            return visitFloatLiteralExpr(flt);
-        }
-        else if (auto* dbl = dynamic_cast<DoubleLiteralExpr*>(expr)) {
-            return visitDoubleLiteralExpr(dbl);
-        }
+        if (!expr) return "/* Unknown expression */";
+        return CodeGeneratorVisitor::dispatchExpr(expr);
+    }
+
+    std::string visitUnsupportedExpr(Expression* expr) {
         return "/* Unknown expression */";
     }
     
     // --- Expression Visitors ---
-    std::string visitIdentifierExpr(IdentifierExpr* node) override { 
+    std::string visitIdentifierExpr(IdentifierExpr* node) { 
         return node->name; 
     }
     
-    std::string visitNumberLiteralExpr(NumberLiteralExpr* node) override { 
+    std::string visitNumberLiteralExpr(NumberLiteralExpr* node) { 
         // Java defaults to int
         return node->value;
     }
     
-    std::string visitFloatLiteralExpr(FloatLiteralExpr* node) override {
+    std::string visitFloatLiteralExpr(FloatLiteralExpr* node) {
         // Append 'f' for float literals in Java
         return node->value + "f";
     }
     
-    std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) override {
+    std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) {
         // Double literals are standard in Java
         return node->value;
     }
     
-    std::string visitStringLiteralExpr(StringLiteralExpr* node) override { 
+    std::string visitStringLiteralExpr(StringLiteralExpr* node) { 
         std::string escapedValue = "";
         for (char c : node->value) {
             switch (c) {
@@ -544,11 +529,11 @@ private:
         return "\"" + escapedValue + "\""; 
     }
     
-    std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) override { 
+    std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) { 
         return node->value ? "true" : "false"; 
     }
     
-    std::string visitBinaryOpExpr(BinaryOpExpr* node) override {
+    std::string visitBinaryOpExpr(BinaryOpExpr* node) {
         // Special handling for string equality operations
         if ((node->op == TokenType::EQUAL || node->op == TokenType::NOT_EQUAL)) {
             // Try to determine if operands might be strings
@@ -556,10 +541,10 @@ private:
             bool mightBeStringComparison = false;
             
             // Check if either operand is a string literal
-            if (auto* left = dynamic_cast<StringLiteralExpr*>(node->left.get())) {
+            if (auto* left = nodeCast<StringLiteralExpr>(node->left.get())) {
                 mightBeStringComparison = true;
             }
-            if (auto* right = dynamic_cast<StringLiteralExpr*>(node->right.get())) {
+            if (auto* right = nodeCast<StringLiteralExpr>(node->right.get())) {
                 mightBeStringComparison = true;
             }
             
@@ -582,7 +567,7 @@ private:
     }
     
     
-    std::string visitFunctionCallExpr(FunctionCallExpr* node) override {
+    std::string visitFunctionCallExpr(FunctionCallExpr* node) {
         std::string code = dispatchExpr(node->callee.get()) + "(";
         
         for (size_t i = 0; i < node->arguments.size(); ++i) {
@@ -594,15 +579,15 @@ private:
         return code;
     }
     
-    std::string visitMemberAccessExpr(MemberAccessExpr* node) override {
+    std::string visitMemberAccessExpr(MemberAccessExpr* node) {
         return dispatchExpr(node->object.get()) + "." + node->member->name;
     }
     
-    std::string visitAssignmentStmt(AssignmentStmt* node) override {
+    std::string visitAssignmentStmt(AssignmentStmt* node) {
         return dispatchExpr(node->left.get()) + " = " + dispatchExpr(node->right.get());
     }
 
-    std::string visitWhileStmt(WhileStmt* node) override {
+    std::string visitWhileStmt(WhileStmt* node) {
         std::string code = getIndent() + "while (";
         if (node->condition) code += dispatchExpr(node->condition.get());
         code += ") {\n";
@@ -613,7 +598,7 @@ private:
         return code;
     }
 
-    std::string visitForStmt(ForStmt* node) override {
+    std::string visitForStmt(ForStmt* node) {
         std::string code = getIndent() + "for (";
         if (node->initializer) {
             std::string initStr = dispatch(node->initializer.get());
@@ -5,16 +5,31 @@
 #include <stdexcept>
 #include <set>
 
-class JavaScriptCodeGenerator : public CodeGeneratorVisitor {
+class JavaScriptCodeGenerator : public CodeGeneratorVisitor<JavaScriptCodeGenerator> {
+    friend class ASTVisitor<JavaScriptCodeGenerator, std::string>; // dispatch() calls the private visit methods
 public:
-    std::string generate(ASTNode* node) override {
+    std::string generate(ASTNode* node) {
+        begin();
+        dispatch(node); // Start visiting; visitProgram adds each top-level statement
+        return finish();
+    }
+
+    // generate() for a program that arrives one top-level declaration at a
+    // time: begin(), then addDeclaration() for each, then finish().
+    void begin() {
         generatedCode_.str("");
         generatedCode_.clear();
         indentLevel = 0;
         currentSpeciesName_ = ""; // Reset species context
         // JS doesn't usually have explicit main, but we might wrap in a function
         generatedCode_ << "// Generated Hanami Code (JavaScript)\n\n";
-        dispatch(node); // Start visiting
+    }
+
+    void addDeclaration(Statement* stmt) {
+        generatedCode_ << dispatch(stmt);
+    }
+
+    std::string finish() {
         return generatedCode_.str();
     }
 
@@ -56,17 +71,17 @@ private:
     }
     
     // --- Visitor Implementations ---
-    std::string visitProgram(ProgramNode* node) override {
+    std::string visitProgram(ProgramNode* node) {
         for (const auto& stmt : node->statements) {
-            generatedCode_ << dispatch(stmt.get());
+            addDeclaration(stmt.get());
         }
         return ""; // Handled by generate()
     }
 
-    std::string visitStyleInclude(StyleIncludeStmt* node) override { return ""; /* Ignore for JS */ }
-    std::string visitGardenDecl(GardenDeclStmt* node) override { return "// Garden: " + node->name + "\n"; }
+    std::string visitStyleInclude(StyleIncludeStmt* node) { return ""; /* Ignore for JS */ }
+    std::string visitGardenDecl(GardenDeclStmt* node) { return "// Garden: " + node->name + "\n"; }
 
-    std::string visitSpeciesDecl(SpeciesDeclStmt* node) override {
+    std::string visitSpeciesDecl(SpeciesDeclStmt* node) {
         std::string speciesCode;
         speciesCode += getIndent() + "class " + node->name + " {\n";
         indentLevel++;
@@ -82,7 +97,7 @@ private:
         for (const auto& section : node->sections) {
              if(!section->block) continue;
              for (const auto& stmt : section->block->statements){
-                 if(auto* varDecl = dynamic_cast<VariableDeclStmt*>(stmt.get())){
+                 if(auto* varDecl = nodeCast<VariableDeclStmt>(stmt.get())){
                      // Add member variable declaration (JS doesn't need type)
                      membersCode += getIndent() + varDecl->varName;
                       if(varDecl->initializer){
@@ -94,7 +109,7 @@ private:
                          constructorCode += getIndent() + "  this." + varDecl->varName + " = null;\n"; 
                          membersCode += "; // Initialized in constructor\n";
                       }
-                 } else if (auto* funcDef = dynamic_cast<FunctionDefStmt*>(stmt.get())){
+                 } else if (auto* funcDef = nodeCast<FunctionDefStmt>(stmt.get())){
                      // Add method definition
                      methodsCode += dispatch(funcDef); // visitFunctionDef handles method syntax
                  }
@@ -119,13 +134,13 @@ private:
         return speciesCode;
     }
 
-    std::string visitVisibilityBlock(VisibilityBlockStmt* node) override {
+    std::string visitVisibilityBlock(VisibilityBlockStmt* node) {
          // JS visibility is handled differently (or ignored for simplicity)
          // The content (members/methods) are processed by visitSpeciesDecl
          return ""; // Don't output anything for the block itself
     }
 
-    std::string visitBlock(BlockStmt* node) override {
+    std::string visitBlock(BlockStmt* node) {
         std::string blockCode = "";
         // Braces handled by caller (function, if/else)
         for (const auto& stmt : node->statements) {
@@ -134,7 +149,7 @@ private:
         return blockCode;
     }
 
-    std::string visitVariableDecl(VariableDeclStmt* node) override {
+    std::string visitVariableDecl(VariableDeclStmt* node) {
         std::string code = getIndent();
         // Use let/const? Defaulting to let.
         code += "let " + node->varName;
@@ -144,7 +159,7 @@ private:
             // Initialize based on type name convention
             if (!currentSpeciesName_.empty()) { // Inside class -> handled by constructor
                 code += "; // Initialized in constructor"; 
-            } else if (!node->typeName.empty() && std::isupper(node->typeName[0])){
+            } else if (!node->typeName.empty() && std::isupper(node->typeName.view()[0])){
                 code += " = new " + mapType(node->typeName) + "()"; // Instantiate class
             } else {
                  code += " = undefined"; // Default for others
@@ -154,7 +169,7 @@ private:
          return code;
     }
 
-    std::string visitFunctionDef(FunctionDefStmt* node) override {
+    std::string visitFunctionDef(FunctionDefStmt* node) {
          bool isMethod = !currentSpeciesName_.empty();
          currentFuncParams_.clear(); // Clear params from previous function
          
@@ -183,7 +198,7 @@ private:
          return code;
     }
 
-    std::string visitReturn(ReturnStmt* node) override {
+    std::string visitReturn(ReturnStmt* node) {
          std::string code = getIndent() + "return";
          if (node->returnValue) {
              code += " " + dispatchExpr(node->returnValue.get());
@@ -192,11 +207,11 @@ private:
          return code;
     }
 
-    std::string visitExpressionStmt(ExpressionStmt* node) override {
+    std::string visitExpressionStmt(ExpressionStmt* node) {
          return getIndent() + dispatchExpr(node->expression.get()) + ";\n";
     }
 
-    std::string visitBranch(BranchStmt* node) override {
+    std::string visitBranch(BranchStmt* node) {
          std::string code = "";
          bool first = true;
          for(const auto& branch : node->branches) {
@@ -226,7 +241,7 @@ private:
          return code;
     }
 
-    std::string visitIO(IOStmt* node) override {
+    std::string visitIO(IOStmt* node) {
          std::string code = "";
          if (node->ioType == TokenType::BLOOM) { // Output
               code += getIndent() + "console.log(";
@@ -244,11 +259,11 @@ private:
                 // Node.js would need require('readline')
                 code += getIndent() + "// Basic input using prompt:\n";
                  for (const auto& expr : node->expressions) {
-                    if (IdentifierExpr* ident = dynamic_cast<IdentifierExpr*>(expr.get())) {
+                    if (IdentifierExpr* ident = nodeCast<IdentifierExpr>(expr.get())) {
                          // Assign directly, assuming var declared elsewhere
                          code += getIndent() + ident->name + " = parseFloat(prompt()); // Reads string, parses to float\n"; 
                          // TODO: Add parsing based on expected type? parseInt, parseFloat?
-                    } else if (MemberAccessExpr* member = dynamic_cast<MemberAccessExpr*>(expr.get())) {
+                    } else if (MemberAccessExpr* member = nodeCast<MemberAccessExpr>(expr.get())) {
                         // Similar logic for member access - reads as string for now
                         std::string objectName = dispatchExpr(member->object.get()); 
                         std::string memberName = member->member->name;
@@ -262,7 +277,7 @@ private:
     }
     
     // --- Expression Visitors ---
-     std::string visitIdentifierExpr(IdentifierExpr* node) override { 
+     std::string visitIdentifierExpr(IdentifierExpr* node) { 
         // Prepend "this." if inside a class method and not a parameter
         if (!currentSpeciesName_.empty() && 
             currentFuncParams_.find(node->name) == currentFuncParams_.end()) 
@@ -271,19 +286,19 @@ private:
         }
         return node->name; 
     }
-     std::string visitNumberLiteralExpr(NumberLiteralExpr* node) override { return node->value.empty() ? "0" : node->value; }
+     std::string visitNumberLiteralExpr(NumberLiteralExpr* node) { return node->value.empty() ? "0" : node->value; }
      
-     std::string visitFloatLiteralExpr(FloatLiteralExpr* node) override {
+     std::string visitFloatLiteralExpr(FloatLiteralExpr* node) {
          // JavaScript uses the same number type for int/float/double
          return node->value;
      }
      
-     std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) override {
+     std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) {
          // JavaScript uses the same number type for int/float/double
          return node->value;
      }
      
-     std::string visitStringLiteralExpr(StringLiteralExpr* node) override { 
+     std::string visitStringLiteralExpr(StringLiteralExpr* node) { 
          // JS uses quotes, consider template literals?
           std::string escapedValue = "";
           for (char c : node->value) {
@@ -297,15 +312,15 @@ private:
           }
           return "\"" + escapedValue + "\""; 
      }
-     std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) override { return node->value ? "true" : "false"; }
+     std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) { return node->value ? "true" : "false"; }
      
-     std::string visitBinaryOpExpr(BinaryOpExpr* node) override {
+     std::string visitBinaryOpExpr(BinaryOpExpr* node) {
           return "(" + dispatchExpr(node->left.get()) + " " + 
                      mapBinaryOperator(node->op) + " " + 
                      dispatchExpr(node->right.get()) + ")";
      }
      
-     std::string visitFunctionCallExpr(FunctionCallExpr* node) override {
+     std::string visitFunctionCallExpr(FunctionCallExpr* node) {
          std::string code = dispatchExpr(node->callee.get()) + "(";
           for (size_t i = 0; i < node->arguments.size(); ++i) {
              code += dispatchExpr(node->arguments[i].get());
@@ -315,17 +330,17 @@ private:
          return code;
      }
      
-     std::string visitMemberAccessExpr(MemberAccessExpr* node) override {
+     std::string visitMemberAccessExpr(MemberAccessExpr* node) {
          // Standard dot notation
          return dispatchExpr(node->object.get()) + "." + node->member->name;
      }
      
-      std::string visitAssignmentStmt(AssignmentStmt* node) override {
+      std::string visitAssignmentStmt(AssignmentStmt* node) {
           // Need to handle var/let/const declaration if LHS is just identifier?
           // Assuming variable already declared for assignment expressions.
           std::string leftCode;
           // Check if the left side is an identifier that needs `this.`
-          if(IdentifierExpr* ident = dynamic_cast<IdentifierExpr*>(node->left.get())) {
+          if(IdentifierExpr* ident = nodeCast<IdentifierExpr>(node->left.get())) {
               if (!currentSpeciesName_.empty() && 
                   currentFuncParams_.find(ident->name) == currentFuncParams_.end()) 
               {
@@ -340,7 +355,7 @@ private:
           return leftCode + " = " + dispatchExpr(node->right.get());
       }
 
-    std::string visitWhileStmt(WhileStmt* node) override {
+    std::string visitWhileStmt(WhileStmt* node) {
         std::string code = getIndent() + "while (";
         if (node->condition) code += dispatchExpr(node->condition.get());
         code += ") {\n";
@@ -351,7 +366,7 @@ private:
         return code;
     }
 
-    std::string visitForStmt(ForStmt* node) override {
+    std::string visitForStmt(ForStmt* node) {
         std::string code = getIndent() + "for (";
         if (node->initializer) {
             std::string initStr = dispatch(node->initializer.get());
@@ -5,9 +5,18 @@
 #include <stdexcept>
 #include <set>
 
-class PythonCodeGenerator : public CodeGeneratorVisitor {
+class PythonCodeGenerator : public CodeGeneratorVisitor<PythonCodeGenerator> {
+    friend class ASTVisitor<PythonCodeGenerator, std::string>; // dispatch() calls the private visit methods
 public:
-    std::string generate(ASTNode* node) override {
+    std::string generate(ASTNode* node) {
+        begin();
+        dispatch(node); // Start visiting; visitProgram adds each top-level statement
+        return finish();
+    }
+
+    // generate() for a program that arrives one top-level declaration at a
+    // time: begin(), then addDeclaration() for each, then finish().
+    void begin() {
         generatedCode_.str("");
         generatedCode_.clear();
         indentLevel = 0;
@@ -18,9 +27,13 @@ public:
         
         // Add imports if needed (e.g., for specific functionality)
         // generatedCode_ << "import sys\n\n";
-        
-        dispatch(node); // Start visiting
-        
+    }
+
+    void addDeclaration(Statement* stmt) {
+        generatedCode_ << dispatch(stmt);
+    }
+
+    std::string finish() {
         // Add main guard if a main function was found
         if (hasMain_) {
              generatedCode_ << "\n\nif __name__ == \"__main__\":\n";
@@ -72,17 +85,17 @@ private:
     }
     
     // --- Visitor Implementations ---
-    std::string visitProgram(ProgramNode* node) override {
+    std::string visitProgram(ProgramNode* node) {
         for (const auto& stmt : node->statements) {
-            generatedCode_ << dispatch(stmt.get());
+            addDeclaration(stmt.get());
         }
         return ""; // Handled by generate()
     }
 
-    std::string visitStyleInclude(StyleIncludeStmt* node) override { return ""; /* Ignore for Python */ }
-    std::string visitGardenDecl(GardenDeclStmt* node) override { return ""; /* No direct equivalent */ }
+    std::string visitStyleInclude(StyleIncludeStmt* node) { return ""; /* Ignore for Python */ }
+    std::string visitGardenDecl(GardenDeclStmt* node) { return ""; /* No direct equivalent */ }
 
-    std::string visitSpeciesDecl(SpeciesDeclStmt* node) override {
+    std::string visitSpeciesDecl(SpeciesDeclStmt* node) {
         std::string speciesCode;
         speciesCode += getIndent() + "class " + node->name + ":\n";
         indentLevel++;
@@ -98,7 +111,7 @@ private:
         for (const auto& section : node->sections) {
             if(!section->block) continue;
             for(const auto& stmt : section->block->statements) {
-                 if(auto* varDecl = dynamic_cast<VariableDeclStmt*>(stmt.get())){
+                 if(auto* varDecl = nodeCast<VariableDeclStmt>(stmt.get())){
                      // Generate initialization in constructor
                       constructorCode += getIndent() + "  self." + varDecl->varName + " = ";
                       if(varDecl->initializer){
@@ -111,7 +124,7 @@ private:
                            else constructorCode += "None\n"; // Default for unknown/species types
                       }
                      members_exist = true;
-                 } else if (auto* funcDef = dynamic_cast<FunctionDefStmt*>(stmt.get())){
+                 } else if (auto* funcDef = nodeCast<FunctionDefStmt>(stmt.get())){
                      // Generate method
                      methodsCode += dispatch(funcDef); // visitFunctionDef adds 'self'
                      members_exist = true;
@@ -140,13 +153,13 @@ private:
         return speciesCode;
     }
 
-    std::string visitVisibilityBlock(VisibilityBlockStmt* node) override {
+    std::string visitVisibilityBlock(VisibilityBlockStmt* node) {
          // Python visibility is handled by convention/name mangling
          // The contents are processed by visitSpeciesDecl
          return ""; // Don't generate anything for the block itself
     }
 
-    std::string visitBlock(BlockStmt* node) override {
+    std::string visitBlock(BlockStmt* node) {
         std::string blockCode = "";
         for (const auto& stmt : node->statements) {
              blockCode += dispatch(stmt.get());
@@ -160,7 +173,7 @@ private:
         return blockCode;
     }
 
-    std::string visitVariableDecl(VariableDeclStmt* node) override {
+    std::string visitVariableDecl(VariableDeclStmt* node) {
         // Python is dynamically typed, so type name is ignored for declaration.
         std::string code = getIndent() + node->varName;
         if (node->initializer) {
@@ -173,7 +186,7 @@ private:
                   // as they are initialized in __init__.
                   // If called, it might be a local variable inside a method.
                  code += " = None";
-             } else if (!node->typeName.empty() && std::isupper(node->typeName[0])){
+             } else if (!node->typeName.empty() && std::isupper(node->typeName.view()[0])){
                  // Likely a class type in global/main scope
                  code += " = " + mapType(node->typeName) + "()"; // Instantiate class
              } else {
@@ -184,7 +197,7 @@ private:
         return code;
     }
 
-    std::string visitFunctionDef(FunctionDefStmt* node) override {
+    std::string visitFunctionDef(FunctionDefStmt* node) {
          bool isMethod = !currentSpeciesName_.empty();
          currentFuncParams_.clear(); // Clear params from previous function
          
@@ -223,7 +236,7 @@ private:
          return code;
     }
 
-    std::string visitReturn(ReturnStmt* node) override {
+    std::string visitReturn(ReturnStmt* node) {
          std::string code = getIndent() + "return";
          if (node->returnValue) {
              code += " " + dispatchExpr(node->returnValue.get());
@@ -232,12 +245,12 @@ private:
          return code;
     }
 
-    std::string visitExpressionStmt(ExpressionStmt* node) override {
+    std::string visitExpressionStmt(ExpressionStmt* node) {
          // Assignments are expressions in Python
          return getIndent() + dispatchExpr(node->expression.get()) + "\n";
     }
 
-    std::string visitBranch(BranchStmt* node) override {
+    std::string visitBranch(BranchStmt* node) {
          std::string code = "";
          bool first = true;
          for(const auto& branch : node->branches) {
@@ -271,7 +284,7 @@ private:
          return code;
     }
 
-    std::string visitIO(IOStmt* node) override {
+    std::string visitIO(IOStmt* node) {
          std::string code = "";
           if (node->ioType == TokenType::BLOOM) { // Output
               code += getIndent() + "print(";
@@ -290,7 +303,7 @@ private:
                for (const auto& expr : node->expressions) {
                     // Check if assigning to a member variable
                     std::string targetVar = "";
-                    if (IdentifierExpr* ident = dynamic_cast<IdentifierExpr*>(expr.get())) {
+                    if (IdentifierExpr* ident = nodeCast<IdentifierExpr>(expr.get())) {
                         if (!currentSpeciesName_.empty() && 
                             currentFuncParams_.find(ident->name) == currentFuncParams_.end())
                         {
@@ -308,7 +321,7 @@ private:
     }
     
     // --- Expression Visitors ---
-     std::string visitIdentifierExpr(IdentifierExpr* node) override {
+     std::string visitIdentifierExpr(IdentifierExpr* node) {
          // Prepend "self." if inside a class method and the identifier
          // is not a parameter of the current function.
          if (!currentSpeciesName_.empty() && 
@@ -321,16 +334,16 @@ private:
          }
           return node->name; 
      }
-     std::string visitNumberLiteralExpr(NumberLiteralExpr* node) override { return node->value.empty() ? "0" : node->value; }
-     std::string visitFloatLiteralExpr(FloatLiteralExpr* node) override {
+     std::string visitNumberLiteralExpr(NumberLiteralExpr* node) { return node->value.empty() ? "0" : node->value; }
+     std::string visitFloatLiteralExpr(FloatLiteralExpr* node) {
          // Python handles floats directly
          return node->value;
      }
-     std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) override {
+     std::string visitDoubleLiteralExpr(DoubleLiteralExpr* node) {
          // Python treats floats and doubles similarly (as float)
          return node->value;
      }
-     std::string visitStringLiteralExpr(StringLiteralExpr* node) override { 
+     std::string visitStringLiteralExpr(StringLiteralExpr* node) { 
          // Python uses quotes, escapes might need translation
           std::string escapedValue = "";
           for (char c : node->value) {
@@ -344,15 +357,15 @@ private:
           }
           return "\"" + escapedValue + "\""; 
      }
-     std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) override { return node->value ? "True" : "False"; } // Capitalized
+     std::string visitBooleanLiteralExpr(BooleanLiteralExpr* node) { return node->value ? "True" : "False"; } // Capitalized
      
-     std::string visitBinaryOpExpr(BinaryOpExpr* node) override {
+     std::string visitBinaryOpExpr(BinaryOpExpr* node) {
           return "(" + dispatchExpr(node->left.get()) + " " + 
                      mapBinaryOperator(node->op) + " " + 
                      dispatchExpr(node->right.get()) + ")";
      }
      
-     std::string visitFunctionCallExpr(FunctionCallExpr* node) override {
+     std::string visitFunctionCallExpr(FunctionCallExpr* node) {
          std::string code = dispatchExpr(node->callee.get()) + "(";
           for (size_t i = 0; i < node->arguments.size(); ++i) {
              code += dispatchExpr(node->arguments[i].get());
@@ -362,14 +375,14 @@ private:
          return code;
      }
      
-     std::string visitMemberAccessExpr(MemberAccessExpr* node) override {
+     std::string visitMemberAccessExpr(MemberAccessExpr* node) {
          return dispatchExpr(node->object.get()) + "." + node->member->name;
      }
      
-      std::string visitAssignmentStmt(AssignmentStmt* node) override {
+      std::string visitAssignmentStmt(AssignmentStmt* node) {
           std::string leftCode;
           // Check if the left side is an identifier that needs `self.`
-          if(IdentifierExpr* ident = dynamic_cast<IdentifierExpr*>(node->left.get())) {
+          if(IdentifierExpr* ident = nodeCast<IdentifierExpr>(node->left.get())) {
               if (!currentSpeciesName_.empty() && 
                   currentFuncParams_.find(ident->name) == currentFuncParams_.end()) 
               {
@@ -384,7 +397,7 @@ private:
           return leftCode + " = " + dispatchExpr(node->right.get());
       }
 
-    std::string visitWhileStmt(WhileStmt* node) override {
+    std::string visitWhileStmt(WhileStmt* node) {
         std::string code = getIndent() + "while ";
         if (node->condition) code += dispatchExpr(node->condition.get());
         code += ":\n";
@@ -400,7 +413,7 @@ private:
         return code;
     }
 
-    std::string visitForStmt(ForStmt* node) override {
+    std::string visitForStmt(ForStmt* node) {
         // Python's for loop is different (for item in iterable)
         // Translate standard C-style for loop to a while loop
         std::string code = "";
@@ -433,22 +446,11 @@ private:
 
     // Dispatch expression nodes (return value as string)
     std::string dispatchExpr(Expression* expr) {
-        // This is a simplified dispatch for expression nodes. 
-        // It assumes expressions can be directly converted to string representations.
         if (!expr) return "None"; // Default Python representation for null/void
-        
-        // Using dynamic_cast to determine the type and call the specific visitor
-        if (auto* p = dynamic_cast<IdentifierExpr*>(expr)) return visitIdentifierExpr(p);
-        if (auto* p = dynamic_cast<NumberLiteralExpr*>(expr)) return visitNumberLiteralExpr(p);
-        if (auto* p = dynamic_cast<FloatLiteralExpr*>(expr)) return visitFloatLiteralExpr(p);
-        if (auto* p = dynamic_cast<DoubleLiteralExpr*>(expr)) return visitDoubleLiteralExpr(p);
-        if (auto* p = dynamic_cast<StringLiteralExpr*>(expr)) return visitStringLiteralExpr(p);
-        if (auto* p = dynamic_cast<BooleanLiteralExpr*>(expr)) return visitBooleanLiteralExpr(p);
-        if (auto* p = dynamic_cast<BinaryOpExpr*>(expr)) return visitBinaryOpExpr(p);
-        if (auto* p = dynamic_cast<FunctionCallExpr*>(expr)) return visitFunctionCallExpr(p);
-        if (auto* p = dynamic_cast<MemberAccessExpr*>(expr)) return visitMemberAccessExpr(p);
-        if (auto* p = dynamic_cast<AssignmentStmt*>(expr)) return visitAssignmentStmt(p);
+        return CodeGeneratorVisitor::dispatchExpr(expr);
+    }
 
+    std::string visitUnsupportedExpr(Expression* expr) {
         return "#<Unknown Expr>#"; // Placeholder for unhandled expression types
     }
 
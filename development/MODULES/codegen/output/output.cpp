@@ -1,9 +0,0 @@
-#include <iostream>
-#include <string>
-#include <vector>
-
-int main() {
-    std::cout << std::string("Hello, World!");
-    return 0;
-}
-
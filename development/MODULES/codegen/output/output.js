@@ -1,7 +0,0 @@
-// Generated Hanami Code (JavaScript)
-
-function main() {
-    console.log("Hello, World!");
-    return 0;
-}
-
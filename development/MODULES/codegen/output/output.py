@@ -1,8 +0,0 @@
-def main():
-    print("Hello, World!", end='')
-    return 0
-
-
-
-if __name__ == "__main__":
-    main()
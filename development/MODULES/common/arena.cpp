@@ -0,0 +1,78 @@
+#include "arena.h"
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+Arena::Arena(size_t blockSize) : blockSize_(blockSize) {}
+
+Arena::~Arena() {
+    release();
+}
+
+char* Arena::newBlock(size_t size) {
+    char* block = static_cast<char*>(std::malloc(size));
+    if (!block) throw std::bad_alloc();
+    blocks_.push_back(block);
+    bytesReserved_ += size;
+    return block;
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    uintptr_t p = reinterpret_cast<uintptr_t>(cursor_);
+    uintptr_t aligned = (p + align - 1) & ~(uintptr_t)(align - 1);
+    if (cursor_ && aligned + size <= reinterpret_cast<uintptr_t>(limit_)) {
+        bytesUsed_ += (aligned - p) + size;
+        cursor_ = reinterpret_cast<char*>(aligned + size);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Oversized requests get a block of their own so the current one keeps filling up
+    if (size + align > blockSize_ / 4) {
+        char* block = newBlock(size + align);
+        uintptr_t start = reinterpret_cast<uintptr_t>(block);
+        uintptr_t result = (start + align - 1) & ~(uintptr_t)(align - 1);
+        bytesUsed_ += (result - start) + size;
+        return reinterpret_cast<void*>(result);
+    }
+
+    cursor_ = newBlock(blockSize_); // malloc'ed blocks are max_align_t aligned
+    limit_ = cursor_ + blockSize_;
+    return allocate(size, align);
+}
+
+std::string_view Arena::copyString(std::string_view s) {
+    if (s.empty()) return std::string_view();
+    char* copy = static_cast<char*>(allocate(s.size(), 1));
+    std::memcpy(copy, s.data(), s.size());
+    return std::string_view(copy, s.size());
+}
+
+void Arena::release() {
+    for (char* block : blocks_) {
+        std::free(block);
+    }
+    blocks_.clear();
+    cursor_ = limit_ = nullptr;
+    bytesUsed_ = 0;
+    bytesReserved_ = 0;
+}
+
+// --- Current arena ---
+
+namespace {
+thread_local Arena* activeArena = nullptr;
+}
+
+ArenaScope::ArenaScope(Arena& arena) : previous_(activeArena) {
+    activeArena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    activeArena = previous_;
+}
+
+Arena& currentArena() {
+    if (activeArena) return *activeArena;
+    thread_local Arena fallback;
+    return fallback;
+}
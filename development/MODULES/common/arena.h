@@ -0,0 +1,188 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// --- Arena (bump-pointer) allocator ---
+// Hands out memory from large blocks by bumping a pointer and frees every
+// block in one step when the arena is destroyed or release() is called.
+// Objects placed in an arena are never destroyed one by one, so they must not
+// own heap memory themselves: AST nodes hold their strings as StrRef and their
+// child lists as ArenaVector, both of which also live in the arena (names are
+// interned Symbols, which own nothing).
+// An arena is not thread-safe; give each thread its own.
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copies s into the arena. The view stays valid until release().
+    std::string_view copyString(std::string_view s);
+
+    // Frees all blocks at once. Everything allocated so far becomes invalid.
+    void release();
+
+    size_t bytesUsed() const { return bytesUsed_; }         // Handed out, including alignment padding
+    size_t bytesReserved() const { return bytesReserved_; } // Obtained from the system
+    size_t blockCount() const { return blocks_.size(); }
+
+private:
+    char* newBlock(size_t size);
+
+    size_t blockSize_;
+    std::vector<char*> blocks_;
+    char* cursor_ = nullptr;
+    char* limit_ = nullptr;
+    size_t bytesUsed_ = 0;
+    size_t bytesReserved_ = 0;
+};
+
+// --- Current arena ---
+// Makes an arena the target of StrRef, ArenaVector and makeNode() on this
+// thread for the lifetime of the scope. Scopes nest.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* previous_;
+};
+
+// Arena of the innermost ArenaScope on this thread. Without one, a per-thread
+// fallback arena is used that lives until the thread exits.
+Arena& currentArena();
+
+// Owning-style pointer to an arena object: moves like unique_ptr but never
+// deletes, since the memory goes away with the arena.
+struct ArenaDeleter {
+    template <typename T>
+    void operator()(T*) const noexcept {}
+};
+
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+// --- StrRef ---
+// Immutable string copied into the current arena. It is a string_view, and
+// converts to std::string wherever one is expected.
+class StrRef : public std::string_view {
+public:
+    StrRef() = default;
+    StrRef(std::string_view s) : std::string_view(currentArena().copyString(s)) {}
+    StrRef(const std::string& s) : StrRef(std::string_view(s)) {}
+    StrRef(const char* s) : StrRef(std::string_view(s)) {}
+
+    std::string str() const { return std::string(data(), size()); }
+    operator std::string() const { return str(); }
+};
+
+inline std::string operator+(const std::string& a, const StrRef& b) {
+    std::string result;
+    result.reserve(a.size() + b.size());
+    result.append(a).append(b.data(), b.size());
+    return result;
+}
+inline std::string operator+(std::string&& a, const StrRef& b) {
+    a.append(b.data(), b.size());
+    return std::move(a);
+}
+inline std::string operator+(const StrRef& a, const std::string& b) {
+    std::string result;
+    result.reserve(a.size() + b.size());
+    result.append(a.data(), a.size()).append(b);
+    return result;
+}
+inline std::string operator+(const char* a, const StrRef& b) {
+    return std::string(a) + b;
+}
+inline std::string operator+(const StrRef& a, const char* b) {
+    return a.str().append(b);
+}
+
+// --- ArenaVector ---
+// Growable array whose storage comes from the current arena. Growing copies
+// the elements into a bigger array and leaves the old one to the arena, and
+// elements are never destroyed, so T must not own heap memory.
+template <typename T>
+class ArenaVector {
+public:
+    ArenaVector() = default;
+    ArenaVector(const ArenaVector&) = delete;
+    ArenaVector& operator=(const ArenaVector&) = delete;
+    ArenaVector(ArenaVector&& other) noexcept
+        : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+        other.data_ = nullptr;
+        other.size_ = other.capacity_ = 0;
+    }
+    ArenaVector& operator=(ArenaVector&& other) noexcept {
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.data_ = nullptr;
+        other.size_ = other.capacity_ = 0;
+        return *this;
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) grow();
+        T* slot = new (data_ + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_back(const T& value) { emplace_back(value); }
+
+    void reserve(size_t n) {
+        if (n > capacity_) grow(n);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+private:
+    void grow(size_t minCapacity = 0) {
+        size_t newCapacity = capacity_ ? capacity_ * 2 : 4;
+        if (newCapacity < minCapacity) newCapacity = minCapacity;
+        T* newData = static_cast<T*>(currentArena().allocate(newCapacity * sizeof(T), alignof(T)));
+        for (size_t i = 0; i < size_; ++i) {
+            new (newData + i) T(std::move(data_[i]));
+        }
+        data_ = newData;
+        capacity_ = newCapacity;
+    }
+
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+#endif // ARENA_H
@@ -11,6 +11,9 @@
 #include "utils.h" // Include for tokenTypeToString
 
 #include "token.h" // Depends on TokenType
+#include "ast_binary.h" // BinaryAstWriter used by writeBinary()
+#include "arena.h" // Nodes, their strings and child lists live in an Arena
+#include "string_interner.h" // Names and type names are interned Symbols
 
 // --- Error Handling --- 
 
@@ -20,20 +23,98 @@ public:
     ParseError(const std::string& message) : std::runtime_error(message) {}
 };
 
+// Deepest statement nesting, and separately expression nesting, the parser
+// accepts; readBinaryAst rejects files nested deeper than the parser could
+// have written them.
+constexpr size_t MAX_NESTING_DEPTH = 256;
+
+// --- Node Kinds --- 
+// Cheap tag carried by every node so diagnostics and dispatch can tell node
+// types apart without RTTI or serialization. Names match the JSON "node_type".
+enum class NodeKind {
+    ASTNode, Expression, Statement,
+    // Expressions
+    IdentifierExpr, NumberLiteralExpr, StringLiteralExpr, FloatLiteralExpr,
+    DoubleLiteralExpr, BooleanLiteralExpr, BinaryOpExpr, FunctionCallExpr,
+    MemberAccessExpr, AssignmentStmt,
+    // Statements
+    ProgramNode, StyleIncludeStmt, GardenDeclStmt, BlockStmt, VisibilityBlockStmt,
+    SpeciesDeclStmt, VariableDeclStmt, FunctionDefStmt, ReturnStmt, ExpressionStmt,
+    BranchStmt, IOStmt, WhileStmt, ForStmt
+};
+
+inline const char* nodeKindName(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::ASTNode: return "ASTNode";
+        case NodeKind::Expression: return "Expression";
+        case NodeKind::Statement: return "Statement";
+        case NodeKind::IdentifierExpr: return "IdentifierExpr";
+        case NodeKind::NumberLiteralExpr: return "NumberLiteralExpr";
+        case NodeKind::StringLiteralExpr: return "StringLiteralExpr";
+        case NodeKind::FloatLiteralExpr: return "FloatLiteralExpr";
+        case NodeKind::DoubleLiteralExpr: return "DoubleLiteralExpr";
+        case NodeKind::BooleanLiteralExpr: return "BooleanLiteralExpr";
+        case NodeKind::BinaryOpExpr: return "BinaryOpExpr";
+        case NodeKind::FunctionCallExpr: return "FunctionCallExpr";
+        case NodeKind::MemberAccessExpr: return "MemberAccessExpr";
+        case NodeKind::AssignmentStmt: return "AssignmentStmt";
+        case NodeKind::ProgramNode: return "ProgramNode";
+        case NodeKind::StyleIncludeStmt: return "StyleIncludeStmt";
+        case NodeKind::GardenDeclStmt: return "GardenDeclStmt";
+        case NodeKind::BlockStmt: return "BlockStmt";
+        case NodeKind::VisibilityBlockStmt: return "VisibilityBlockStmt";
+        case NodeKind::SpeciesDeclStmt: return "SpeciesDeclStmt";
+        case NodeKind::VariableDeclStmt: return "VariableDeclStmt";
+        case NodeKind::FunctionDefStmt: return "FunctionDefStmt";
+        case NodeKind::ReturnStmt: return "ReturnStmt";
+        case NodeKind::ExpressionStmt: return "ExpressionStmt";
+        case NodeKind::BranchStmt: return "BranchStmt";
+        case NodeKind::IOStmt: return "IOStmt";
+        case NodeKind::WhileStmt: return "WhileStmt";
+        case NodeKind::ForStmt: return "ForStmt";
+    }
+    return "Unknown";
+}
+
+inline bool isExpressionKind(NodeKind kind) {
+    return kind == NodeKind::Expression ||
+           (kind >= NodeKind::IdentifierExpr && kind <= NodeKind::AssignmentStmt);
+}
+
+// --- Node Allocation --- 
+// Nodes are created in the current arena (see ArenaScope) and the tree is
+// released all at once together with that arena; NodePtr only expresses
+// ownership between nodes and never frees anything itself.
+template <typename T>
+using NodePtr = ArenaPtr<T>;
+
+template <typename T, typename... Args>
+NodePtr<T> makeNode(Args&&... args) {
+    return NodePtr<T>(currentArena().create<T>(std::forward<Args>(args)...));
+}
+
 // --- AST Node Base --- 
 struct ASTNode {
+    const NodeKind kind; // Set once by the concrete node's constructor
+    explicit ASTNode(NodeKind k = NodeKind::ASTNode) : kind(k) {}
     virtual ~ASTNode() = default;
+    const char* kindName() const { return nodeKindName(kind); }
     virtual nlohmann::json toJson() const {
         nlohmann::json j;
         j["node_type"] = "ASTNode"; 
         return j;
     }
+    // Compact encoding used between stages (see ast_binary.h)
+    virtual void writeBinary(BinaryAstWriter& w) const {
+        throw std::runtime_error("writeBinary: node has no binary encoding");
+    }
     // Optional: Add field for semantic analysis results (e.g., DataType)
     // DataType semantic_type = UNKNOWN_TYPE; // Example
 };
 
 // --- Expressions ---
 struct Expression : public ASTNode {
+    explicit Expression(NodeKind k = NodeKind::Expression) : ASTNode(k) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "Expression";
@@ -42,78 +123,124 @@ struct Expression : public ASTNode {
 };
 
 struct IdentifierExpr : public Expression {
-    std::string name;
-    IdentifierExpr(std::string n) : name(std::move(n)) {}
+    static constexpr NodeKind Kind = NodeKind::IdentifierExpr;
+    Symbol name;
+    IdentifierExpr(Symbol n) : Expression(NodeKind::IdentifierExpr), name(n) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "IdentifierExpr";
-        j["name"] = name;
+        j["name"] = name.str();
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::IdentifierExpr);
+        w.string(name);
+    }
 };
 
 struct NumberLiteralExpr : public Expression {
-    std::string value; 
-    NumberLiteralExpr(std::string v) : value(std::move(v)) {}
+    static constexpr NodeKind Kind = NodeKind::NumberLiteralExpr;
+    StrRef value;     // Source text, re-emitted as written
+    int64_t intValue; // Decoded once by the lexer
+    bool overflow;    // Text did not fit in int64_t; intValue is saturated
+    NumberLiteralExpr(StrRef v, int64_t intValue, bool overflow)
+        : Expression(NodeKind::NumberLiteralExpr), value(std::move(v)), intValue(intValue), overflow(overflow) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "NumberLiteralExpr";
         j["value"] = value;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::NumberLiteralExpr);
+        w.string(value);
+        w.integer(intValue);
+        w.boolean(overflow);
+    }
 };
 
 struct StringLiteralExpr : public Expression {
-    std::string value;
-    StringLiteralExpr(std::string v) : value(std::move(v)) {}
+    static constexpr NodeKind Kind = NodeKind::StringLiteralExpr;
+    StrRef value;
+    StringLiteralExpr(StrRef v) : Expression(NodeKind::StringLiteralExpr), value(std::move(v)) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "StringLiteralExpr";
         j["value"] = value;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::StringLiteralExpr);
+        w.string(value);
+    }
 };
 
 struct FloatLiteralExpr : public Expression {
-    std::string value;
-    FloatLiteralExpr(std::string v) : value(std::move(v)) {}
+    static constexpr NodeKind Kind = NodeKind::FloatLiteralExpr;
+    StrRef value;     // Source text, re-emitted as written
+    double realValue; // Decoded once by the lexer
+    bool overflow;    // Out of float range; realValue is +-infinity
+    FloatLiteralExpr(StrRef v, double realValue, bool overflow)
+        : Expression(NodeKind::FloatLiteralExpr), value(std::move(v)), realValue(realValue), overflow(overflow) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "FloatLiteralExpr";
         j["value"] = value;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::FloatLiteralExpr);
+        w.string(value);
+        w.real(realValue);
+        w.boolean(overflow);
+    }
 };
 
 struct DoubleLiteralExpr : public Expression {
-    std::string value;
-    DoubleLiteralExpr(std::string v) : value(std::move(v)) {}
+    static constexpr NodeKind Kind = NodeKind::DoubleLiteralExpr;
+    StrRef value;     // Source text, re-emitted as written
+    double realValue; // Decoded once by the lexer
+    bool overflow;    // Out of double range; realValue is +-infinity
+    DoubleLiteralExpr(StrRef v, double realValue, bool overflow)
+        : Expression(NodeKind::DoubleLiteralExpr), value(std::move(v)), realValue(realValue), overflow(overflow) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;   
         j["node_type"] = "DoubleLiteralExpr";
         j["value"] = value;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::DoubleLiteralExpr);
+        w.string(value);
+        w.real(realValue);
+        w.boolean(overflow);
+    }
 };
 
 
 struct BooleanLiteralExpr : public Expression {
+    static constexpr NodeKind Kind = NodeKind::BooleanLiteralExpr;
     bool value;
-    BooleanLiteralExpr(bool v) : value(v) {}
+    BooleanLiteralExpr(bool v) : Expression(NodeKind::BooleanLiteralExpr), value(v) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "BooleanLiteralExpr";
         j["value"] = value;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::BooleanLiteralExpr);
+        w.boolean(value);
+    }
 };
 
 struct BinaryOpExpr : public Expression {
+    static constexpr NodeKind Kind = NodeKind::BinaryOpExpr;
     TokenType op;
-    std::unique_ptr<Expression> left;
-    std::unique_ptr<Expression> right;
-    BinaryOpExpr(TokenType o, std::unique_ptr<Expression> l, std::unique_ptr<Expression> r)
-        : op(o), left(std::move(l)), right(std::move(r)) {}
+    NodePtr<Expression> left;
+    NodePtr<Expression> right;
+    BinaryOpExpr(TokenType o, NodePtr<Expression> l, NodePtr<Expression> r)
+        : Expression(NodeKind::BinaryOpExpr), op(o), left(std::move(l)), right(std::move(r)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "BinaryOpExpr";
@@ -123,12 +250,19 @@ struct BinaryOpExpr : public Expression {
         j["right"] = right ? right->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::BinaryOpExpr);
+        w.enumValue(op);
+        w.child(left);
+        w.child(right);
+    }
 };
 
 struct FunctionCallExpr : public Expression {
-    std::unique_ptr<Expression> callee; 
-    std::vector<std::unique_ptr<Expression>> arguments;
-    FunctionCallExpr(std::unique_ptr<Expression> c) : callee(std::move(c)) {}
+    static constexpr NodeKind Kind = NodeKind::FunctionCallExpr;
+    NodePtr<Expression> callee; 
+    ArenaVector<NodePtr<Expression>> arguments;
+    FunctionCallExpr(NodePtr<Expression> c) : Expression(NodeKind::FunctionCallExpr), callee(std::move(c)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "FunctionCallExpr";
@@ -139,13 +273,19 @@ struct FunctionCallExpr : public Expression {
         }
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::FunctionCallExpr);
+        w.child(callee);
+        w.children(arguments);
+    }
 };
 
 struct MemberAccessExpr : public Expression {
-    std::unique_ptr<Expression> object; 
-    std::unique_ptr<IdentifierExpr> member;
-    MemberAccessExpr(std::unique_ptr<Expression> obj, std::unique_ptr<IdentifierExpr> mem)
-        : object(std::move(obj)), member(std::move(mem)) {}
+    static constexpr NodeKind Kind = NodeKind::MemberAccessExpr;
+    NodePtr<Expression> object; 
+    NodePtr<IdentifierExpr> member;
+    MemberAccessExpr(NodePtr<Expression> obj, NodePtr<IdentifierExpr> mem)
+        : Expression(NodeKind::MemberAccessExpr), object(std::move(obj)), member(std::move(mem)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "MemberAccessExpr";
@@ -153,10 +293,16 @@ struct MemberAccessExpr : public Expression {
         j["member"] = member ? member->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::MemberAccessExpr);
+        w.child(object);
+        w.child(member);
+    }
 };
 
 // --- Statements ---
 struct Statement : public ASTNode {
+    explicit Statement(NodeKind k = NodeKind::Statement) : ASTNode(k) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "Statement";
@@ -165,7 +311,9 @@ struct Statement : public ASTNode {
 };
 
 struct ProgramNode : public Statement {
-    std::vector<std::unique_ptr<Statement>> statements;
+    static constexpr NodeKind Kind = NodeKind::ProgramNode;
+    ProgramNode() : Statement(NodeKind::ProgramNode) {}
+    ArenaVector<NodePtr<Statement>> statements;
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "ProgramNode";
@@ -175,32 +323,48 @@ struct ProgramNode : public Statement {
         }
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::ProgramNode);
+        w.children(statements);
+    }
 };
 
 struct StyleIncludeStmt : public Statement {
-    std::string path;
-    StyleIncludeStmt(std::string p) : path(std::move(p)) {}
+    static constexpr NodeKind Kind = NodeKind::StyleIncludeStmt;
+    StrRef path;
+    StyleIncludeStmt(StrRef p) : Statement(NodeKind::StyleIncludeStmt), path(std::move(p)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "StyleIncludeStmt";
         j["path"] = path;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::StyleIncludeStmt);
+        w.string(path);
+    }
 };
 
 struct GardenDeclStmt : public Statement {
-    std::string name;
-    GardenDeclStmt(std::string n) : name(std::move(n)) {}
+    static constexpr NodeKind Kind = NodeKind::GardenDeclStmt;
+    Symbol name;
+    GardenDeclStmt(Symbol n) : Statement(NodeKind::GardenDeclStmt), name(n) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "GardenDeclStmt";
-        j["name"] = name;
+        j["name"] = name.str();
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::GardenDeclStmt);
+        w.string(name);
+    }
 };
 
 struct BlockStmt : public Statement {
-    std::vector<std::unique_ptr<Statement>> statements;
+    static constexpr NodeKind Kind = NodeKind::BlockStmt;
+    BlockStmt() : Statement(NodeKind::BlockStmt) {}
+    ArenaVector<NodePtr<Statement>> statements;
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "BlockStmt";
@@ -210,13 +374,18 @@ struct BlockStmt : public Statement {
         }
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::BlockStmt);
+        w.children(statements);
+    }
 };
 
 
 struct VisibilityBlockStmt : public Statement {
+    static constexpr NodeKind Kind = NodeKind::VisibilityBlockStmt;
     TokenType visibility; 
-    std::unique_ptr<BlockStmt> block;
-    VisibilityBlockStmt(TokenType v, std::unique_ptr<BlockStmt> b) : visibility(v), block(std::move(b)) {}
+    NodePtr<BlockStmt> block;
+    VisibilityBlockStmt(TokenType v, NodePtr<BlockStmt> b) : Statement(NodeKind::VisibilityBlockStmt), visibility(v), block(std::move(b)) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "VisibilityBlockStmt";
@@ -225,47 +394,66 @@ struct VisibilityBlockStmt : public Statement {
         j["block"] = block ? block->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::VisibilityBlockStmt);
+        w.enumValue(visibility);
+        w.child(block);
+    }
 };
 
 
 struct SpeciesDeclStmt : public Statement {
-    std::string name;
-    std::vector<std::unique_ptr<VisibilityBlockStmt>> sections; 
-    SpeciesDeclStmt(std::string n) : name(std::move(n)) {}
+    static constexpr NodeKind Kind = NodeKind::SpeciesDeclStmt;
+    Symbol name;
+    ArenaVector<NodePtr<VisibilityBlockStmt>> sections; 
+    SpeciesDeclStmt(Symbol n) : Statement(NodeKind::SpeciesDeclStmt), name(n) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "SpeciesDeclStmt";
-        j["name"] = name;
+        j["name"] = name.str();
         j["sections"] = nlohmann::json::array();
          for(const auto& section : sections) {
             j["sections"].push_back(section ? section->toJson() : nullptr);
         }
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::SpeciesDeclStmt);
+        w.string(name);
+        w.children(sections);
+    }
 };
 
 
 struct VariableDeclStmt : public Statement {
-    std::string typeName; 
-    std::string varName;
-    std::unique_ptr<Expression> initializer; 
-    VariableDeclStmt(std::string type, std::string name, std::unique_ptr<Expression> init = nullptr)
-        : typeName(std::move(type)), varName(std::move(name)), initializer(std::move(init)) {}
+    static constexpr NodeKind Kind = NodeKind::VariableDeclStmt;
+    Symbol typeName; 
+    Symbol varName;
+    NodePtr<Expression> initializer; 
+    VariableDeclStmt(Symbol type, Symbol name, NodePtr<Expression> init = nullptr)
+        : Statement(NodeKind::VariableDeclStmt), typeName(type), varName(name), initializer(std::move(init)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "VariableDeclStmt";
-        j["typeName"] = typeName;
-        j["varName"] = varName;
+        j["typeName"] = typeName.str();
+        j["varName"] = varName.str();
         j["initializer"] = initializer ? initializer->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::VariableDeclStmt);
+        w.string(typeName);
+        w.string(varName);
+        w.child(initializer);
+    }
 };
 
 struct AssignmentStmt : public Expression { 
-    std::unique_ptr<Expression> left; 
-    std::unique_ptr<Expression> right;
-    AssignmentStmt(std::unique_ptr<Expression> l, std::unique_ptr<Expression> r)
-        : left(std::move(l)), right(std::move(r)) {}
+    static constexpr NodeKind Kind = NodeKind::AssignmentStmt;
+    NodePtr<Expression> left; 
+    NodePtr<Expression> right;
+    AssignmentStmt(NodePtr<Expression> l, NodePtr<Expression> r)
+        : Expression(NodeKind::AssignmentStmt), left(std::move(l)), right(std::move(r)) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "AssignmentStmt";
@@ -273,34 +461,44 @@ struct AssignmentStmt : public Expression {
         j["right"] = right ? right->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::AssignmentStmt);
+        w.child(left);
+        w.child(right);
+    }
 };
 
 
 struct Parameter {
-    std::string typeName;
-    std::string paramName;
-    Parameter(std::string type, std::string name) : typeName(std::move(type)), paramName(std::move(name)) {}
+    Symbol typeName;
+    Symbol paramName;
+    Parameter(Symbol type, Symbol name) : typeName(type), paramName(name) {}
     nlohmann::json toJson() const {
          nlohmann::json j;
-         j["typeName"] = typeName;
-         j["paramName"] = paramName;
+         j["typeName"] = typeName.str();
+         j["paramName"] = paramName.str();
          return j;
     }
+    void writeBinary(BinaryAstWriter& w) const {
+        w.string(typeName);
+        w.string(paramName);
+    }
 };
 
 
 struct FunctionDefStmt : public Statement {
-    std::string name;
-    std::vector<Parameter> parameters;
-    std::string returnType;
-    std::unique_ptr<BlockStmt> body;
-    FunctionDefStmt(std::string n, std::string retType, std::unique_ptr<BlockStmt> b)
-        : name(std::move(n)), returnType(std::move(retType)), body(std::move(b)) {}
+    static constexpr NodeKind Kind = NodeKind::FunctionDefStmt;
+    Symbol name;
+    ArenaVector<Parameter> parameters;
+    Symbol returnType;
+    NodePtr<BlockStmt> body;
+    FunctionDefStmt(Symbol n, Symbol retType, NodePtr<BlockStmt> b)
+        : Statement(NodeKind::FunctionDefStmt), name(n), returnType(retType), body(std::move(b)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "FunctionDefStmt";
-        j["name"] = name;
-        j["returnType"] = returnType;
+        j["name"] = name.str();
+        j["returnType"] = returnType.str();
         j["parameters"] = nlohmann::json::array();
         for(const auto& param : parameters) {
             j["parameters"].push_back(param.toJson());
@@ -308,35 +506,53 @@ struct FunctionDefStmt : public Statement {
         j["body"] = body ? body->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::FunctionDefStmt);
+        w.string(name);
+        w.string(returnType);
+        w.varint(parameters.size());
+        for (const auto& param : parameters) param.writeBinary(w);
+        w.child(body);
+    }
 };
 
 struct ReturnStmt : public Statement { 
-    std::unique_ptr<Expression> returnValue; 
-    ReturnStmt(std::unique_ptr<Expression> val = nullptr) : returnValue(std::move(val)) {}
+    static constexpr NodeKind Kind = NodeKind::ReturnStmt;
+    NodePtr<Expression> returnValue; 
+    ReturnStmt(NodePtr<Expression> val = nullptr) : Statement(NodeKind::ReturnStmt), returnValue(std::move(val)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "ReturnStmt";
         j["returnValue"] = returnValue ? returnValue->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::ReturnStmt);
+        w.child(returnValue);
+    }
 };
 
 struct ExpressionStmt : public Statement {
-    std::unique_ptr<Expression> expression;
-    ExpressionStmt(std::unique_ptr<Expression> expr) : expression(std::move(expr)) {}
+    static constexpr NodeKind Kind = NodeKind::ExpressionStmt;
+    NodePtr<Expression> expression;
+    ExpressionStmt(NodePtr<Expression> expr) : Statement(NodeKind::ExpressionStmt), expression(std::move(expr)) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "ExpressionStmt";
         j["expression"] = expression ? expression->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::ExpressionStmt);
+        w.child(expression);
+    }
 };
 
 
 struct IfBranch {
-     std::unique_ptr<Expression> condition; 
-     std::unique_ptr<BlockStmt> body;
-     IfBranch(std::unique_ptr<Expression> cond, std::unique_ptr<BlockStmt> b)
+     NodePtr<Expression> condition; 
+     NodePtr<BlockStmt> body;
+     IfBranch(NodePtr<Expression> cond, NodePtr<BlockStmt> b)
          : condition(std::move(cond)), body(std::move(b)) {}
      nlohmann::json toJson() const {
          nlohmann::json j;
@@ -344,10 +560,16 @@ struct IfBranch {
          j["body"] = body ? body->toJson() : nullptr;
          return j;
      }
+     void writeBinary(BinaryAstWriter& w) const {
+         w.child(condition);
+         w.child(body);
+     }
 };
 
 struct BranchStmt : public Statement { 
-    std::vector<IfBranch> branches;
+    static constexpr NodeKind Kind = NodeKind::BranchStmt;
+    BranchStmt() : Statement(NodeKind::BranchStmt) {}
+    ArenaVector<IfBranch> branches;
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "BranchStmt";
@@ -357,13 +579,19 @@ struct BranchStmt : public Statement {
         }
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::BranchStmt);
+        w.varint(branches.size());
+        for (const auto& branch : branches) branch.writeBinary(w);
+    }
 };
 
 struct IOStmt : public Statement { 
+    static constexpr NodeKind Kind = NodeKind::IOStmt;
     TokenType ioType; 
     TokenType direction; 
-    std::vector<std::unique_ptr<Expression>> expressions; 
-    IOStmt(TokenType type, TokenType dir) : ioType(type), direction(dir) {}
+    ArenaVector<NodePtr<Expression>> expressions; 
+    IOStmt(TokenType type, TokenType dir) : Statement(NodeKind::IOStmt), ioType(type), direction(dir) {}
      nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "IOStmt";
@@ -376,13 +604,20 @@ struct IOStmt : public Statement {
         }
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::IOStmt);
+        w.enumValue(ioType);
+        w.enumValue(direction);
+        w.children(expressions);
+    }
 };
 
 struct WhileStmt : public Statement {
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<BlockStmt> body;
-    WhileStmt(std::unique_ptr<Expression> cond, std::unique_ptr<BlockStmt> b)
-        : condition(std::move(cond)), body(std::move(b)) {}
+    static constexpr NodeKind Kind = NodeKind::WhileStmt;
+    NodePtr<Expression> condition;
+    NodePtr<BlockStmt> body;
+    WhileStmt(NodePtr<Expression> cond, NodePtr<BlockStmt> b)
+        : Statement(NodeKind::WhileStmt), condition(std::move(cond)), body(std::move(b)) {}
     nlohmann::json toJson() const override {
         nlohmann::json j;
         j["node_type"] = "WhileStmt";
@@ -390,18 +625,24 @@ struct WhileStmt : public Statement {
         j["body"] = body ? body->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::WhileStmt);
+        w.child(condition);
+        w.child(body);
+    }
 };
 
 // Optional: ForStmt (more complex)
 struct ForStmt : public Statement {
-    std::unique_ptr<Statement> initializer; // Can be VariableDeclStmt or ExpressionStmt
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<Expression> increment;
-    std::unique_ptr<BlockStmt> body;
-
-    ForStmt(std::unique_ptr<Statement> init, std::unique_ptr<Expression> cond,
-            std::unique_ptr<Expression> incr, std::unique_ptr<BlockStmt> b)
-        : initializer(std::move(init)), condition(std::move(cond)),
+    static constexpr NodeKind Kind = NodeKind::ForStmt;
+    NodePtr<Statement> initializer; // Can be VariableDeclStmt or ExpressionStmt
+    NodePtr<Expression> condition;
+    NodePtr<Expression> increment;
+    NodePtr<BlockStmt> body;
+
+    ForStmt(NodePtr<Statement> init, NodePtr<Expression> cond,
+            NodePtr<Expression> incr, NodePtr<BlockStmt> b)
+        : Statement(NodeKind::ForStmt), initializer(std::move(init)), condition(std::move(cond)),
           increment(std::move(incr)), body(std::move(b)) {}
 
     nlohmann::json toJson() const override {
@@ -413,6 +654,21 @@ struct ForStmt : public Statement {
         j["body"] = body ? body->toJson() : nullptr;
         return j;
     }
+    void writeBinary(BinaryAstWriter& w) const override {
+        w.tag(AstTag::ForStmt);
+        w.child(initializer);
+        w.child(condition);
+        w.child(increment);
+        w.child(body);
+    }
 };
 
+// --- Kind-checked downcast ---
+// Stand-in for dynamic_cast to a concrete node type: compares the NodeKind tag
+// instead of walking RTTI. Returns nullptr for null or mismatching nodes.
+template <typename T>
+T* nodeCast(ASTNode* node) {
+    return (node && node->kind == T::Kind) ? static_cast<T*>(node) : nullptr;
+}
+
 #endif // AST_H 
\ No newline at end of file
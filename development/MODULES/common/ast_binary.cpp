@@ -0,0 +1,457 @@
+#include "ast_binary.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "ast.h"
+
+// --- Writer ---
+
+void BinaryAstWriter::varint(uint64_t value) {
+    // LEB128: 7 bits per byte, high bit set on all but the last byte
+    while (value >= 0x80) {
+        body_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    body_.push_back(static_cast<char>(value));
+}
+
+void BinaryAstWriter::string(std::string_view s) {
+    auto it = index_.find(s);
+    if (it == index_.end()) {
+        it = index_.emplace(s, static_cast<uint32_t>(strings_.size())).first;
+        strings_.push_back(s);
+    }
+    varint(it->second);
+}
+
+std::string BinaryAstWriter::finish() const {
+    BinaryAstWriter table; // Reuse varint() to encode the header section
+    table.body_.append(AST_FILE_MAGIC, sizeof(AST_FILE_MAGIC));
+    uint32_t version = AST_FILE_VERSION;
+    table.body_.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    table.varint(strings_.size());
+    for (std::string_view s : strings_) {
+        table.varint(s.size());
+        table.body_.append(s.data(), s.size());
+    }
+    return table.body_ + body_;
+}
+
+bool isBinaryAstFile(const char* data, size_t size) {
+    return size >= sizeof(AST_FILE_MAGIC) &&
+           std::memcmp(data, AST_FILE_MAGIC, sizeof(AST_FILE_MAGIC)) == 0;
+}
+
+bool writeBinaryAst(const std::string& filename, const ASTNode& root) {
+    BinaryAstWriter writer;
+    root.writeBinary(writer);
+    std::string bytes = writer.finish();
+
+    std::ofstream outFile(filename, std::ios::binary);
+    if (!outFile) {
+        return false;
+    }
+    outFile.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(outFile);
+}
+
+// --- Reader ---
+
+namespace {
+
+// Rebuilds nodes straight from the buffer; mirrors the writeBinary() methods in ast.h.
+class BinaryAstReader {
+public:
+    BinaryAstReader(const char* data, size_t size) : pos_(data), end_(data + size) {}
+
+    NodePtr<ASTNode> readFile() {
+        if (!isBinaryAstFile(pos_, end_ - pos_)) {
+            throw std::runtime_error("Not a binary AST file (missing header)");
+        }
+        pos_ += sizeof(AST_FILE_MAGIC);
+        uint32_t version;
+        need(sizeof(version));
+        std::memcpy(&version, pos_, sizeof(version));
+        pos_ += sizeof(version);
+        if (version != AST_FILE_VERSION) {
+            throw std::runtime_error("Unsupported binary AST version: " + std::to_string(version));
+        }
+
+        size_t stringCount = count();
+        table_.reserve(stringCount);
+        for (size_t i = 0; i < stringCount; ++i) {
+            uint64_t length = varint();
+            need(length);
+            table_.emplace_back(pos_, length);
+            pos_ += length;
+        }
+        strings_.resize(stringCount);
+        symbols_.resize(stringCount);
+
+        if (peekTag() != AstTag::ProgramNode) {
+            throw std::runtime_error("Expected ProgramNode at the top level of binary AST");
+        }
+        NodePtr<ASTNode> root = readStatement();
+        if (pos_ != end_) {
+            throw std::runtime_error("Trailing bytes after binary AST root");
+        }
+        return root;
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+    std::vector<std::string_view> table_; // Views into the buffer
+    // Filled on first use: literals are copied into the arena, names interned,
+    // each once however many nodes share them
+    std::vector<StrRef> strings_;
+    std::vector<Symbol> symbols_;
+
+    // A crafted file could nest nodes deep enough to overflow the stack, so
+    // nesting is limited the way the parser limits it. Statements count every
+    // level below the program. Expressions count only right-hand operands and
+    // arguments: left operands, callees and member objects can chain without
+    // limit (a + b + c, f()(), a.b.c), so those are read in a loop instead.
+    size_t statementDepth_ = 0;
+    size_t expressionDepth_ = 0;
+
+    // Counts one level in depth for as long as it lives
+    class NestingGuard {
+    public:
+        NestingGuard(size_t& depth, const char* kind) : depth_(depth) {
+            if (depth_ >= MAX_NESTING_DEPTH) {
+                throw std::runtime_error(std::string("Binary AST ") + kind + " nesting too deep");
+            }
+            ++depth_;
+        }
+        ~NestingGuard() { --depth_; }
+        NestingGuard(const NestingGuard&) = delete;
+        NestingGuard& operator=(const NestingGuard&) = delete;
+    private:
+        size_t& depth_;
+    };
+
+    // Left-edge nodes of the expression being read whose other children still follow
+    struct PendingExpression {
+        AstTag tag;
+        TokenType op; // BinaryOpExpr only
+    };
+    std::vector<PendingExpression> pending_;
+
+    void need(uint64_t bytes) const {
+        if (bytes > static_cast<uint64_t>(end_ - pos_)) {
+            throw std::runtime_error("Binary AST is truncated");
+        }
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            need(1);
+            uint8_t byte = static_cast<uint8_t>(*pos_++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("Binary AST has a malformed varint");
+    }
+
+    size_t stringIndex() {
+        uint64_t index = varint();
+        if (index >= table_.size()) {
+            throw std::runtime_error("Binary AST string index out of range");
+        }
+        return static_cast<size_t>(index);
+    }
+
+    StrRef string() {
+        size_t index = stringIndex();
+        if (strings_[index].size() != table_[index].size()) strings_[index] = StrRef(table_[index]);
+        return strings_[index];
+    }
+
+    Symbol symbol() {
+        size_t index = stringIndex();
+        if (symbols_[index].empty()) symbols_[index] = Symbol(table_[index]);
+        return symbols_[index];
+    }
+
+    bool boolean() {
+        need(1);
+        return *pos_++ != 0;
+    }
+
+    int64_t integer() {
+        uint64_t zigzag = varint();
+        return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    }
+
+    double real() {
+        double value;
+        need(sizeof(value));
+        std::memcpy(&value, pos_, sizeof(value));
+        pos_ += sizeof(value);
+        return value;
+    }
+
+    TokenType tokenType() {
+        uint64_t type = varint();
+        if (type >= TOKEN_TYPE_COUNT) {
+            throw std::runtime_error("Binary AST token type out of range");
+        }
+        return static_cast<TokenType>(type);
+    }
+
+    AstTag peekTag() const {
+        need(1);
+        return static_cast<AstTag>(*pos_);
+    }
+
+    AstTag readTag() {
+        need(1);
+        return static_cast<AstTag>(*pos_++);
+    }
+
+    // Counts come from the file, so never reserve more than the bytes left could hold
+    size_t count() {
+        uint64_t n = varint();
+        if (n > static_cast<uint64_t>(end_ - pos_)) {
+            throw std::runtime_error("Binary AST list count exceeds remaining data");
+        }
+        return static_cast<size_t>(n);
+    }
+
+    // Each node is written before its children, so the left edge of
+    // a + b + c comes first: every tag down it is stacked, then the leftmost
+    // operand is read and the stacked nodes are finished from the inside out.
+    NodePtr<Expression> readExpression() {
+        size_t base = pending_.size();
+        AstTag tag = readTag();
+        while (tag == AstTag::BinaryOpExpr || tag == AstTag::FunctionCallExpr ||
+               tag == AstTag::MemberAccessExpr || tag == AstTag::AssignmentStmt) {
+            TokenType op = tag == AstTag::BinaryOpExpr ? tokenType() : TokenType::ERROR;
+            pending_.push_back({tag, op});
+            tag = readTag();
+        }
+        NodePtr<Expression> expr = readOperand(tag);
+        while (pending_.size() > base) {
+            PendingExpression node = pending_.back();
+            pending_.pop_back();
+            expr = finishExpression(node, std::move(expr));
+        }
+        return expr;
+    }
+
+    NodePtr<Expression> readNestedExpression() {
+        NestingGuard nesting(expressionDepth_, "expression");
+        return readExpression();
+    }
+
+    // The rest of a node from the left edge, once its first child is read
+    NodePtr<Expression> finishExpression(const PendingExpression& node, NodePtr<Expression> first) {
+        switch (node.tag) {
+            case AstTag::BinaryOpExpr: {
+                auto right = readNestedExpression();
+                return makeNode<BinaryOpExpr>(node.op, std::move(first), std::move(right));
+            }
+            case AstTag::FunctionCallExpr: {
+                auto call = makeNode<FunctionCallExpr>(std::move(first));
+                size_t n = count();
+                call->arguments.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    call->arguments.push_back(readNestedExpression());
+                }
+                return call;
+            }
+            case AstTag::MemberAccessExpr: {
+                auto member = readIdentifier();
+                return makeNode<MemberAccessExpr>(std::move(first), std::move(member));
+            }
+            default: { // AssignmentStmt
+                auto right = readNestedExpression();
+                return makeNode<AssignmentStmt>(std::move(first), std::move(right));
+            }
+        }
+    }
+
+    // An expression that does not start with another expression
+    NodePtr<Expression> readOperand(AstTag tag) {
+        switch (tag) {
+            case AstTag::Null:
+                return nullptr;
+            case AstTag::IdentifierExpr:
+                return makeNode<IdentifierExpr>(symbol());
+            case AstTag::NumberLiteralExpr: {
+                StrRef text = string();
+                int64_t value = integer();
+                return makeNode<NumberLiteralExpr>(text, value, boolean());
+            }
+            case AstTag::StringLiteralExpr:
+                return makeNode<StringLiteralExpr>(string());
+            case AstTag::FloatLiteralExpr: {
+                StrRef text = string();
+                double value = real();
+                return makeNode<FloatLiteralExpr>(text, value, boolean());
+            }
+            case AstTag::DoubleLiteralExpr: {
+                StrRef text = string();
+                double value = real();
+                return makeNode<DoubleLiteralExpr>(text, value, boolean());
+            }
+            case AstTag::BooleanLiteralExpr:
+                return makeNode<BooleanLiteralExpr>(boolean());
+            default:
+                throw std::runtime_error("Binary AST: expected an expression, found tag " +
+                                         std::to_string(static_cast<int>(tag)));
+        }
+    }
+
+    NodePtr<IdentifierExpr> readIdentifier() {
+        AstTag tag = readTag();
+        if (tag == AstTag::Null) return nullptr;
+        if (tag != AstTag::IdentifierExpr) {
+            throw std::runtime_error("Binary AST: MemberAccessExpr member must be an IdentifierExpr");
+        }
+        return makeNode<IdentifierExpr>(symbol());
+    }
+
+    NodePtr<BlockStmt> readBlock() {
+        AstTag tag = readTag();
+        if (tag == AstTag::Null) return nullptr;
+        if (tag != AstTag::BlockStmt) {
+            throw std::runtime_error("Binary AST: expected a BlockStmt");
+        }
+        return readBlockBody();
+    }
+
+    NodePtr<BlockStmt> readBlockBody() {
+        auto block = makeNode<BlockStmt>();
+        size_t n = count();
+        block->statements.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            block->statements.push_back(readNestedStatement());
+        }
+        return block;
+    }
+
+    NodePtr<VisibilityBlockStmt> readVisibilityBlock() {
+        AstTag tag = readTag();
+        if (tag == AstTag::Null) return nullptr;
+        if (tag != AstTag::VisibilityBlockStmt) {
+            throw std::runtime_error("Binary AST: expected a VisibilityBlockStmt inside SpeciesDeclStmt");
+        }
+        TokenType visibility = tokenType();
+        auto block = readBlock();
+        return makeNode<VisibilityBlockStmt>(visibility, std::move(block));
+    }
+
+    NodePtr<Statement> readNestedStatement() {
+        NestingGuard nesting(statementDepth_, "statement");
+        return readStatement();
+    }
+
+    NodePtr<Statement> readStatement() {
+        AstTag tag = readTag();
+        switch (tag) {
+            case AstTag::Null:
+                return nullptr;
+            case AstTag::ProgramNode: {
+                auto program = makeNode<ProgramNode>();
+                size_t n = count();
+                program->statements.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    program->statements.push_back(readNestedStatement());
+                }
+                return program;
+            }
+            case AstTag::StyleIncludeStmt:
+                return makeNode<StyleIncludeStmt>(string());
+            case AstTag::GardenDeclStmt:
+                return makeNode<GardenDeclStmt>(symbol());
+            case AstTag::BlockStmt:
+                return readBlockBody();
+            case AstTag::VisibilityBlockStmt:
+                throw std::runtime_error("Binary AST: VisibilityBlockStmt found outside SpeciesDeclStmt");
+            case AstTag::SpeciesDeclStmt: {
+                auto species = makeNode<SpeciesDeclStmt>(symbol());
+                size_t n = count();
+                species->sections.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    species->sections.push_back(readVisibilityBlock());
+                }
+                return species;
+            }
+            case AstTag::VariableDeclStmt: {
+                Symbol typeName = symbol();
+                Symbol varName = symbol();
+                auto initializer = readExpression();
+                return makeNode<VariableDeclStmt>(typeName, varName, std::move(initializer));
+            }
+            case AstTag::FunctionDefStmt: {
+                Symbol name = symbol();
+                Symbol returnType = symbol();
+                ArenaVector<Parameter> parameters;
+                size_t n = count();
+                parameters.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    Symbol typeName = symbol();
+                    Symbol paramName = symbol();
+                    parameters.emplace_back(typeName, paramName);
+                }
+                auto func = makeNode<FunctionDefStmt>(name, returnType, readBlock());
+                func->parameters = std::move(parameters);
+                return func;
+            }
+            case AstTag::ReturnStmt:
+                return makeNode<ReturnStmt>(readExpression());
+            case AstTag::ExpressionStmt:
+                return makeNode<ExpressionStmt>(readExpression());
+            case AstTag::BranchStmt: {
+                auto branchStmt = makeNode<BranchStmt>();
+                size_t n = count();
+                branchStmt->branches.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    auto condition = readExpression();
+                    auto body = readBlock();
+                    branchStmt->branches.emplace_back(std::move(condition), std::move(body));
+                }
+                return branchStmt;
+            }
+            case AstTag::IOStmt: {
+                TokenType ioType = tokenType();
+                TokenType direction = tokenType();
+                auto ioStmt = makeNode<IOStmt>(ioType, direction);
+                size_t n = count();
+                ioStmt->expressions.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    ioStmt->expressions.push_back(readExpression());
+                }
+                return ioStmt;
+            }
+            case AstTag::WhileStmt: {
+                auto condition = readExpression();
+                auto body = readBlock();
+                return makeNode<WhileStmt>(std::move(condition), std::move(body));
+            }
+            case AstTag::ForStmt: {
+                auto initializer = readNestedStatement();
+                auto condition = readExpression();
+                auto increment = readExpression();
+                auto body = readBlock();
+                return makeNode<ForStmt>(std::move(initializer), std::move(condition),
+                                                 std::move(increment), std::move(body));
+            }
+            default:
+                throw std::runtime_error("Binary AST: expected a statement, found tag " +
+                                         std::to_string(static_cast<int>(tag)));
+        }
+    }
+};
+
+} // namespace
+
+NodePtr<ASTNode> readBinaryAst(const char* data, size_t size, Arena& arena) {
+    ArenaScope scope(arena);
+    BinaryAstReader reader(data, size);
+    return reader.readFile();
+}
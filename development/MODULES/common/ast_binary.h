@@ -0,0 +1,99 @@
+#ifndef AST_BINARY_H
+#define AST_BINARY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+
+// --- Binary AST / IR format (.ast, .ir) ---
+// Written by the parser and the semantic analyzer by default (pretty JSON is
+// kept behind --json as a debug dump). Layout:
+//
+//   magic "HNAS", uint32 version (host byte order)
+//   varint stringCount, then stringCount x (varint length, bytes)
+//   root node
+//
+// A node is one AstTag byte followed by its fields in declaration order:
+//   strings    -> varint index into the string table
+//   TokenType  -> varint
+//   bool       -> one byte
+//   int64      -> zigzag varint
+//   double     -> 8 bytes (host byte order)
+//   child      -> a nested node, or AstTag::Null when absent
+//   child list -> varint count, then the nodes
+// Identifiers and literals are stored once in the string table however often
+// they occur in the tree.
+
+struct ASTNode;
+
+constexpr char AST_FILE_MAGIC[4] = {'H', 'N', 'A', 'S'};
+constexpr uint32_t AST_FILE_VERSION = 2; // 2: numeric literals carry their value
+
+enum class AstTag : uint8_t {
+    Null = 0,
+    // Expressions
+    IdentifierExpr, NumberLiteralExpr, StringLiteralExpr, FloatLiteralExpr,
+    DoubleLiteralExpr, BooleanLiteralExpr, BinaryOpExpr, FunctionCallExpr,
+    MemberAccessExpr, AssignmentStmt,
+    // Statements
+    ProgramNode, StyleIncludeStmt, GardenDeclStmt, BlockStmt, VisibilityBlockStmt,
+    SpeciesDeclStmt, VariableDeclStmt, FunctionDefStmt, ReturnStmt, ExpressionStmt,
+    BranchStmt, IOStmt, WhileStmt, ForStmt
+};
+
+// Encoder used by the writeBinary() methods in ast.h.
+// Node bodies go into one buffer while strings are collected into the table;
+// finish() prepends the header and the table.
+class BinaryAstWriter {
+public:
+    void tag(AstTag t) { body_.push_back(static_cast<char>(t)); }
+    void varint(uint64_t value);
+    void string(std::string_view s);
+    void boolean(bool value) { body_.push_back(value ? 1 : 0); }
+    void integer(int64_t value) { varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+    void real(double value) { body_.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    template <typename Enum>
+    void enumValue(Enum value) { varint(static_cast<uint64_t>(value)); }
+
+    // Optional child node (Null tag when absent)
+    template <typename Ptr>
+    void child(const Ptr& node) {
+        if (node) node->writeBinary(*this);
+        else tag(AstTag::Null);
+    }
+
+    // Counted list of child nodes
+    template <typename Vec>
+    void children(const Vec& nodes) {
+        varint(nodes.size());
+        for (const auto& node : nodes) child(node);
+    }
+
+    // Header + string table + node bodies
+    std::string finish() const;
+
+private:
+    std::string body_;
+    std::vector<std::string_view> strings_;               // Views into the written nodes
+    std::unordered_map<std::string_view, uint32_t> index_; // string -> table index
+};
+
+// True if the buffer starts with the binary AST magic.
+bool isBinaryAstFile(const char* data, size_t size);
+
+// Serializes the tree rooted at root. Returns false if the file could not be written.
+bool writeBinaryAst(const std::string& filename, const ASTNode& root);
+
+// Rebuilds the tree from an in-memory binary AST (typically a MappedFile),
+// allocating nodes and strings from arena.
+// Throws std::runtime_error on a malformed or truncated buffer.
+ArenaPtr<ASTNode> readBinaryAst(const char* data, size_t size, Arena& arena);
+
+#endif // AST_BINARY_H
@@ -0,0 +1,110 @@
+#ifndef AST_VISITOR_H
+#define AST_VISITOR_H
+
+#include "ast.h"
+
+// --- Switch-based AST visitor (CRTP) ---
+// Shared by the semantic analyzer and the code generators. dispatch() jumps
+// straight to Derived::visitXxx() with a single switch on ASTNode::kind, so
+// there is no dynamic_cast chain and no virtual call per node.
+//
+//   class MyPass : public ASTVisitor<MyPass, std::string> {
+//       friend class ASTVisitor<MyPass, std::string>; // if visit methods are private
+//       std::string visitProgram(ProgramNode* node) { ... }
+//       ...
+//   };
+//
+// Any visit method the derived class leaves out falls through to
+// visitUnsupported(), which it may also override (the default returns R()).
+template <typename Derived, typename R>
+class ASTVisitor {
+public:
+    R dispatch(ASTNode* node) {
+        if (!node) return R();
+        switch (node->kind) {
+            case NodeKind::ProgramNode: return self().visitProgram(static_cast<ProgramNode*>(node));
+            case NodeKind::StyleIncludeStmt: return self().visitStyleInclude(static_cast<StyleIncludeStmt*>(node));
+            case NodeKind::GardenDeclStmt: return self().visitGardenDecl(static_cast<GardenDeclStmt*>(node));
+            case NodeKind::SpeciesDeclStmt: return self().visitSpeciesDecl(static_cast<SpeciesDeclStmt*>(node));
+            case NodeKind::VisibilityBlockStmt: return self().visitVisibilityBlock(static_cast<VisibilityBlockStmt*>(node));
+            case NodeKind::BlockStmt: return self().visitBlock(static_cast<BlockStmt*>(node));
+            case NodeKind::VariableDeclStmt: return self().visitVariableDecl(static_cast<VariableDeclStmt*>(node));
+            case NodeKind::FunctionDefStmt: return self().visitFunctionDef(static_cast<FunctionDefStmt*>(node));
+            case NodeKind::ReturnStmt: return self().visitReturn(static_cast<ReturnStmt*>(node));
+            case NodeKind::ExpressionStmt: return self().visitExpressionStmt(static_cast<ExpressionStmt*>(node));
+            case NodeKind::BranchStmt: return self().visitBranch(static_cast<BranchStmt*>(node));
+            case NodeKind::IOStmt: return self().visitIO(static_cast<IOStmt*>(node));
+            case NodeKind::WhileStmt: return self().visitWhileStmt(static_cast<WhileStmt*>(node));
+            case NodeKind::ForStmt: return self().visitForStmt(static_cast<ForStmt*>(node));
+
+            case NodeKind::IdentifierExpr:
+            case NodeKind::NumberLiteralExpr:
+            case NodeKind::StringLiteralExpr:
+            case NodeKind::FloatLiteralExpr:
+            case NodeKind::DoubleLiteralExpr:
+            case NodeKind::BooleanLiteralExpr:
+            case NodeKind::BinaryOpExpr:
+            case NodeKind::FunctionCallExpr:
+            case NodeKind::MemberAccessExpr:
+            case NodeKind::AssignmentStmt:
+                return dispatchExpr(static_cast<Expression*>(node));
+
+            default:
+                return self().visitUnsupported(node);
+        }
+    }
+
+    // Expressions only; statements reaching here go to visitUnsupportedExpr().
+    R dispatchExpr(Expression* node) {
+        if (!node) return R();
+        switch (node->kind) {
+            case NodeKind::IdentifierExpr: return self().visitIdentifierExpr(static_cast<IdentifierExpr*>(node));
+            case NodeKind::NumberLiteralExpr: return self().visitNumberLiteralExpr(static_cast<NumberLiteralExpr*>(node));
+            case NodeKind::StringLiteralExpr: return self().visitStringLiteralExpr(static_cast<StringLiteralExpr*>(node));
+            case NodeKind::FloatLiteralExpr: return self().visitFloatLiteralExpr(static_cast<FloatLiteralExpr*>(node));
+            case NodeKind::DoubleLiteralExpr: return self().visitDoubleLiteralExpr(static_cast<DoubleLiteralExpr*>(node));
+            case NodeKind::BooleanLiteralExpr: return self().visitBooleanLiteralExpr(static_cast<BooleanLiteralExpr*>(node));
+            case NodeKind::BinaryOpExpr: return self().visitBinaryOpExpr(static_cast<BinaryOpExpr*>(node));
+            case NodeKind::FunctionCallExpr: return self().visitFunctionCallExpr(static_cast<FunctionCallExpr*>(node));
+            case NodeKind::MemberAccessExpr: return self().visitMemberAccessExpr(static_cast<MemberAccessExpr*>(node));
+            case NodeKind::AssignmentStmt: return self().visitAssignmentStmt(static_cast<AssignmentStmt*>(node));
+            default:
+                return self().visitUnsupportedExpr(node);
+        }
+    }
+
+protected:
+    Derived& self() { return static_cast<Derived&>(*this); }
+
+    // Fallbacks, hidden by same-named members in Derived
+    R visitUnsupported(ASTNode* node) { return R(); }
+    R visitUnsupportedExpr(Expression* node) { return self().visitUnsupported(node); }
+
+    R visitProgram(ProgramNode* node) { return self().visitUnsupported(node); }
+    R visitStyleInclude(StyleIncludeStmt* node) { return self().visitUnsupported(node); }
+    R visitGardenDecl(GardenDeclStmt* node) { return self().visitUnsupported(node); }
+    R visitSpeciesDecl(SpeciesDeclStmt* node) { return self().visitUnsupported(node); }
+    R visitVisibilityBlock(VisibilityBlockStmt* node) { return self().visitUnsupported(node); }
+    R visitBlock(BlockStmt* node) { return self().visitUnsupported(node); }
+    R visitVariableDecl(VariableDeclStmt* node) { return self().visitUnsupported(node); }
+    R visitFunctionDef(FunctionDefStmt* node) { return self().visitUnsupported(node); }
+    R visitReturn(ReturnStmt* node) { return self().visitUnsupported(node); }
+    R visitExpressionStmt(ExpressionStmt* node) { return self().visitUnsupported(node); }
+    R visitBranch(BranchStmt* node) { return self().visitUnsupported(node); }
+    R visitIO(IOStmt* node) { return self().visitUnsupported(node); }
+    R visitWhileStmt(WhileStmt* node) { return self().visitUnsupported(node); }
+    R visitForStmt(ForStmt* node) { return self().visitUnsupported(node); }
+
+    R visitIdentifierExpr(IdentifierExpr* node) { return self().visitUnsupported(node); }
+    R visitNumberLiteralExpr(NumberLiteralExpr* node) { return self().visitUnsupported(node); }
+    R visitStringLiteralExpr(StringLiteralExpr* node) { return self().visitUnsupported(node); }
+    R visitFloatLiteralExpr(FloatLiteralExpr* node) { return self().visitUnsupported(node); }
+    R visitDoubleLiteralExpr(DoubleLiteralExpr* node) { return self().visitUnsupported(node); }
+    R visitBooleanLiteralExpr(BooleanLiteralExpr* node) { return self().visitUnsupported(node); }
+    R visitBinaryOpExpr(BinaryOpExpr* node) { return self().visitUnsupported(node); }
+    R visitFunctionCallExpr(FunctionCallExpr* node) { return self().visitUnsupported(node); }
+    R visitMemberAccessExpr(MemberAccessExpr* node) { return self().visitUnsupported(node); }
+    R visitAssignmentStmt(AssignmentStmt* node) { return self().visitUnsupported(node); }
+};
+
+#endif // AST_VISITOR_H
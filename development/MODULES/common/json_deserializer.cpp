@@ -1,109 +1,149 @@
 #include "json_deserializer.h"
 #include <stdexcept>
 #include <iostream>
+#include <unordered_map>
 #include "ast.h"
 #include "utils.h"
+#include "ast_binary.h"
+#include "mapped_file.h"
+#include "log.h"
+#include "numeric_literal.h"
 
 // --- JSON Deserialization Implementation --- 
 
-std::unique_ptr<Expression> expressionFromJson(const nlohmann::json& j) {
+namespace {
+
+// Maps a "node_type" string to its NodeKind once, so the deserializers below
+// can switch on the kind instead of comparing the string against every type.
+bool nodeKindFromName(const std::string& name, NodeKind& kind) {
+    static const std::unordered_map<std::string, NodeKind> kinds = [] {
+        std::unordered_map<std::string, NodeKind> m;
+        for (int k = static_cast<int>(NodeKind::ASTNode); k <= static_cast<int>(NodeKind::ForStmt); ++k) {
+            m.emplace(nodeKindName(static_cast<NodeKind>(k)), static_cast<NodeKind>(k));
+        }
+        return m;
+    }();
+    auto it = kinds.find(name);
+    if (it == kinds.end()) return false;
+    kind = it->second;
+    return true;
+}
+
+} // namespace
+
+NodePtr<Expression> expressionFromJson(const nlohmann::json& j) {
     if (!j.is_object() || !j.contains("node_type")) return nullptr;
     std::string node_type = j["node_type"].get<std::string>();
 
+    NodeKind kind = NodeKind::ASTNode;
+    nodeKindFromName(node_type, kind); // Unknown names fall through to the error below
+
     try {
-        if (node_type == "IdentifierExpr") {
-            return std::make_unique<IdentifierExpr>(j.at("name").get<std::string>());
-        } else if (node_type == "NumberLiteralExpr") {
+        switch (kind) {
+        case NodeKind::IdentifierExpr:
+            return makeNode<IdentifierExpr>(j.at("name").get<std::string>());
+        case NodeKind::NumberLiteralExpr: {
             std::string val_str = j.value("value", ""); 
-            return std::make_unique<NumberLiteralExpr>(val_str);
-        } else if (node_type == "StringLiteralExpr") {
-            return std::make_unique<StringLiteralExpr>(j.at("value").get<std::string>());
-        } else if (node_type == "BooleanLiteralExpr") {
-            return std::make_unique<BooleanLiteralExpr>(j.at("value").get<bool>());
-        } else if (node_type == "FloatLiteralExpr") {
-            return std::make_unique<FloatLiteralExpr>(j.at("value").get<std::string>());
-        } else if (node_type == "DoubleLiteralExpr") {
-            return std::make_unique<DoubleLiteralExpr>(j.at("value").get<std::string>());
-        } else if (node_type == "BinaryOpExpr") {
+            NumericLiteral literal = decodeNumericLiteral(TokenType::NUMBER, val_str); // JSON keeps only the text
+            return makeNode<NumberLiteralExpr>(val_str, literal.value.integer, literal.overflow);
+        }
+        case NodeKind::StringLiteralExpr:
+            return makeNode<StringLiteralExpr>(j.at("value").get<std::string>());
+        case NodeKind::BooleanLiteralExpr:
+            return makeNode<BooleanLiteralExpr>(j.at("value").get<bool>());
+        case NodeKind::FloatLiteralExpr: {
+            std::string text = j.at("value").get<std::string>();
+            NumericLiteral literal = decodeNumericLiteral(TokenType::FLOAT_LITERAL, text);
+            return makeNode<FloatLiteralExpr>(text, literal.value.real, literal.overflow);
+        }
+        case NodeKind::DoubleLiteralExpr: {
+            std::string text = j.at("value").get<std::string>();
+            NumericLiteral literal = decodeNumericLiteral(TokenType::DOUBLE_LITERAL, text);
+            return makeNode<DoubleLiteralExpr>(text, literal.value.real, literal.overflow);
+        }
+        case NodeKind::BinaryOpExpr: {
             auto left = expressionFromJson(j.at("left"));
             auto right = expressionFromJson(j.at("right"));
             std::string opStr = j.at("operator").get<std::string>();
             TokenType op = stringToTokenType(opStr); 
-            return std::make_unique<BinaryOpExpr>(op, std::move(left), std::move(right));
-        } else if (node_type == "FunctionCallExpr") {
+            return makeNode<BinaryOpExpr>(op, std::move(left), std::move(right));
+        }
+        case NodeKind::FunctionCallExpr: {
             auto callee = expressionFromJson(j.at("callee"));
-            auto callExpr = std::make_unique<FunctionCallExpr>(std::move(callee));
+            auto callExpr = makeNode<FunctionCallExpr>(std::move(callee));
             if (j.contains("arguments") && j.at("arguments").is_array()) {
                 for (const auto& argJson : j["arguments"]) {
                     callExpr->arguments.push_back(expressionFromJson(argJson));
                 }
             }
             return callExpr;
-        } else if (node_type == "MemberAccessExpr") {
+        }
+        case NodeKind::MemberAccessExpr: {
             auto object = expressionFromJson(j.at("object"));
             auto member = expressionFromJson(j.at("member")); 
-            IdentifierExpr* identMember = dynamic_cast<IdentifierExpr*>(member.release());
-            if (!identMember) {
+            if (!nodeCast<IdentifierExpr>(member.get())) {
                  throw std::runtime_error("MemberAccessExpr member must be an IdentifierExpr");
             }
-            return std::make_unique<MemberAccessExpr>(std::move(object), 
-                       std::unique_ptr<IdentifierExpr>(identMember));
-        } else if (node_type == "AssignmentStmt") { 
+            return makeNode<MemberAccessExpr>(std::move(object), 
+                       NodePtr<IdentifierExpr>(static_cast<IdentifierExpr*>(member.release())));
+        }
+        case NodeKind::AssignmentStmt: { 
              auto left = expressionFromJson(j.at("left"));
              auto right = expressionFromJson(j.at("right"));
-             return std::make_unique<AssignmentStmt>(std::move(left), std::move(right));
+             return makeNode<AssignmentStmt>(std::move(left), std::move(right));
         }
         // --- Add other expression types defined in ast.h --- 
-         else if (node_type == "Expression") { // Base class, shouldn't be instantiated directly usually
-             std::cerr << "Warning: Deserializing base 'Expression' node type." << std::endl;
-             return std::make_unique<Expression>();
-         }
-        // ... 
+        case NodeKind::Expression: // Base class, shouldn't be instantiated directly usually
+             LOG_WARN("Warning: Deserializing base 'Expression' node type.");
+             return makeNode<Expression>();
+        default:
+            break;
+        }
         
         throw std::runtime_error("Unknown or unhandled expression node_type: " + node_type);
 
     } catch (const nlohmann::json::exception& e) {
-         std::cerr << "JSON access error during expression deserialization ('" << node_type << "'): " << e.what() << std::endl;
+         LOG_ERROR("JSON access error during expression deserialization ('" << node_type << "'): " << e.what());
          return nullptr;
      } catch (const std::exception& e) {
-          std::cerr << "Error during expression deserialization ('" << node_type << "'): " << e.what() << std::endl;
+          LOG_ERROR("Error during expression deserialization ('" << node_type << "'): " << e.what());
          return nullptr;
      }
 }
 
-std::unique_ptr<BlockStmt> blockStmtFromJson(const nlohmann::json& j) {
+NodePtr<BlockStmt> blockStmtFromJson(const nlohmann::json& j) {
     if (!j.is_object() || !j.contains("node_type") || j.at("node_type") != "BlockStmt") {
          throw std::runtime_error("Invalid JSON for BlockStmt deserialization.");
     }
-    auto block = std::make_unique<BlockStmt>();
+    auto block = makeNode<BlockStmt>();
     if (j.contains("statements") && j.at("statements").is_array()) {
         for (const auto& stmtJson : j["statements"]) {
             auto statement = statementFromJson(stmtJson); // Use the main statement deserializer
             if (statement) { // Only add if successfully deserialized
                  block->statements.push_back(std::move(statement));
             } else {
-                 std::cerr << "Warning: Failed to deserialize a statement within BlockStmt." << std::endl;
+                 LOG_WARN("Warning: Failed to deserialize a statement within BlockStmt.");
             }
         }
     }
     return block;
 }
 
-std::unique_ptr<VisibilityBlockStmt> visibilityBlockFromJson(const nlohmann::json& j) {
+NodePtr<VisibilityBlockStmt> visibilityBlockFromJson(const nlohmann::json& j) {
      if (!j.is_object() || !j.contains("node_type") || j.at("node_type") != "VisibilityBlockStmt") {
          throw std::runtime_error("Invalid JSON for VisibilityBlockStmt deserialization.");
      }
      std::string visStr = j.at("visibility").get<std::string>();
      TokenType visibility = stringToTokenType(visStr);
      auto block = blockStmtFromJson(j.at("block"));
-     return std::make_unique<VisibilityBlockStmt>(visibility, std::move(block));
+     return makeNode<VisibilityBlockStmt>(visibility, std::move(block));
 }
 
 IfBranch ifBranchFromJson(const nlohmann::json& j) {
      if (!j.is_object()) {
          throw std::runtime_error("Invalid JSON for IfBranch deserialization.");
      }
-     std::unique_ptr<Expression> condition = nullptr;
+     NodePtr<Expression> condition = nullptr;
      // Use .value() to handle potentially null condition safely
      if(!j.value("condition", nlohmann::json()).is_null()) {
          condition = expressionFromJson(j.at("condition"));
@@ -112,60 +152,59 @@ IfBranch ifBranchFromJson(const nlohmann::json& j) {
      return IfBranch(std::move(condition), std::move(body));
 }
 
-std::unique_ptr<Statement> statementFromJson(const nlohmann::json& j) {
+NodePtr<Statement> statementFromJson(const nlohmann::json& j) {
     if (!j.is_object() || !j.contains("node_type")) return nullptr;
     std::string node_type = j.at("node_type").get<std::string>();
 
+    NodeKind kind = NodeKind::ASTNode;
+    nodeKindFromName(node_type, kind); // Unknown names fall through to the expression fallback
+
     try {
-        if (node_type == "ProgramNode") {
+        switch (kind) {
+        case NodeKind::ProgramNode:
             throw std::runtime_error("ProgramNode found within statement list during deserialization.");
-        }
-        if (node_type == "StyleIncludeStmt") {
-            return std::make_unique<StyleIncludeStmt>(j.at("path").get<std::string>());
-        }
-        if (node_type == "GardenDeclStmt") {
-             return std::make_unique<GardenDeclStmt>(j.at("name").get<std::string>());
-        }
-        if (node_type == "BlockStmt") {
+        case NodeKind::StyleIncludeStmt:
+            return makeNode<StyleIncludeStmt>(j.at("path").get<std::string>());
+        case NodeKind::GardenDeclStmt:
+             return makeNode<GardenDeclStmt>(j.at("name").get<std::string>());
+        case NodeKind::BlockStmt:
             return blockStmtFromJson(j);
-        }
-         if (node_type == "VisibilityBlockStmt") {
+        case NodeKind::VisibilityBlockStmt:
              throw std::runtime_error("VisibilityBlockStmt found outside SpeciesDeclStmt during deserialization.");
-         }
-         if (node_type == "SpeciesDeclStmt") {
-              auto species = std::make_unique<SpeciesDeclStmt>(j.at("name").get<std::string>());
+        case NodeKind::SpeciesDeclStmt: {
+              auto species = makeNode<SpeciesDeclStmt>(j.at("name").get<std::string>());
                if (j.contains("sections") && j.at("sections").is_array()) {
                    for (const auto& sectionJson : j["sections"]) {
                         species->sections.push_back(visibilityBlockFromJson(sectionJson));
                    }
                }
                return species;
-         }
-         if (node_type == "VariableDeclStmt") {
-              std::unique_ptr<Expression> initializer = nullptr;
+        }
+        case NodeKind::VariableDeclStmt: {
+              NodePtr<Expression> initializer = nullptr;
               if (!j.value("initializer", nlohmann::json()).is_null()) {
                   initializer = expressionFromJson(j.at("initializer"));
               }
-              return std::make_unique<VariableDeclStmt>(j.at("typeName").get<std::string>(), 
+              return makeNode<VariableDeclStmt>(j.at("typeName").get<std::string>(), 
                                                       j.at("varName").get<std::string>(), 
                                                       std::move(initializer));
-         }
-          if (node_type == "AssignmentStmt") { 
+        }
+        case NodeKind::AssignmentStmt: { 
                // Assignment is an expression, handle via ExpressionStmt
                auto left = expressionFromJson(j.at("left"));
                auto right = expressionFromJson(j.at("right"));
-               auto assignExpr = std::make_unique<AssignmentStmt>(std::move(left), std::move(right));
-               return std::make_unique<ExpressionStmt>(std::move(assignExpr));
-          }
-          if (node_type == "FunctionDefStmt") {
-               std::unique_ptr<BlockStmt> blockBody = nullptr;
+               auto assignExpr = makeNode<AssignmentStmt>(std::move(left), std::move(right));
+               return makeNode<ExpressionStmt>(std::move(assignExpr));
+        }
+        case NodeKind::FunctionDefStmt: {
+               NodePtr<BlockStmt> blockBody = nullptr;
                if (j.contains("body") && j.at("body").is_object()) {
                    blockBody = blockStmtFromJson(j.at("body"));
                } else {
                     throw std::runtime_error("Function definition body is missing or not a BlockStmt.");
                }
                
-               auto func = std::make_unique<FunctionDefStmt>(j.at("name").get<std::string>(), 
+               auto func = makeNode<FunctionDefStmt>(j.at("name").get<std::string>(), 
                                                            j.at("returnType").get<std::string>(),
                                                            std::move(blockBody));
                                                            
@@ -176,68 +215,69 @@ std::unique_ptr<Statement> statementFromJson(const nlohmann::json& j) {
                      }
                 }
                 return func;
-          }
-           if (node_type == "ReturnStmt") {
-                std::unique_ptr<Expression> returnValue = nullptr;
+        }
+        case NodeKind::ReturnStmt: {
+                NodePtr<Expression> returnValue = nullptr;
                  if (!j.value("returnValue", nlohmann::json()).is_null()) {
                      returnValue = expressionFromJson(j.at("returnValue"));
                  }
-                return std::make_unique<ReturnStmt>(std::move(returnValue));
-           }
-           if (node_type == "ExpressionStmt") {
-               return std::make_unique<ExpressionStmt>(expressionFromJson(j.at("expression")));
-           }
-            if (node_type == "BranchStmt") {
-                 auto branchStmt = std::make_unique<BranchStmt>();
+                return makeNode<ReturnStmt>(std::move(returnValue));
+        }
+        case NodeKind::ExpressionStmt:
+               return makeNode<ExpressionStmt>(expressionFromJson(j.at("expression")));
+        case NodeKind::BranchStmt: {
+                 auto branchStmt = makeNode<BranchStmt>();
                   if (j.contains("branches") && j.at("branches").is_array()) {
                       for (const auto& branchJson : j["branches"]) {
                           branchStmt->branches.push_back(ifBranchFromJson(branchJson));
                       }
                   }
                   return branchStmt;
-            }
-             if (node_type == "IOStmt") {
+        }
+        case NodeKind::IOStmt: {
                   std::string ioTypeStr = j.at("ioType").get<std::string>();
                   std::string directionStr = j.at("direction").get<std::string>();
                   TokenType ioType = stringToTokenType(ioTypeStr);
                   TokenType direction = stringToTokenType(directionStr);
-                  auto ioStmt = std::make_unique<IOStmt>(ioType, direction);
+                  auto ioStmt = makeNode<IOStmt>(ioType, direction);
                   if (j.contains("expressions") && j.at("expressions").is_array()) {
                       for (const auto& exprJson : j["expressions"]) {
                           ioStmt->expressions.push_back(expressionFromJson(exprJson));
                       }
                   }
                   return ioStmt;
-             }
-             if (node_type == "WhileStmt") {
+        }
+        case NodeKind::WhileStmt: {
                  auto condition = expressionFromJson(j.at("condition"));
                  auto body = blockStmtFromJson(j.at("body"));
-                 return std::make_unique<WhileStmt>(std::move(condition), std::move(body));
-             }
-              if (node_type == "ForStmt") {
-                 std::unique_ptr<Statement> initializer = nullptr;
+                 return makeNode<WhileStmt>(std::move(condition), std::move(body));
+        }
+        case NodeKind::ForStmt: {
+                 NodePtr<Statement> initializer = nullptr;
                  if (!j.value("initializer", nlohmann::json()).is_null()) {
                       // Initializer could be VarDecl or ExprStmt
                       initializer = statementFromJson(j.at("initializer"));
                  }
                  auto condition = expressionFromJson(j.at("condition"));
-                 std::unique_ptr<Expression> increment = nullptr;
+                 NodePtr<Expression> increment = nullptr;
                   if (!j.value("increment", nlohmann::json()).is_null()) {
                      increment = expressionFromJson(j.at("increment"));
                  }
                  auto body = blockStmtFromJson(j.at("body"));
-                 return std::make_unique<ForStmt>(std::move(initializer), std::move(condition), std::move(increment), std::move(body));
-             }
+                 return makeNode<ForStmt>(std::move(initializer), std::move(condition), std::move(increment), std::move(body));
+        }
         // --- Add other statement types --- 
-         else if (node_type == "Statement") { // Base class
-              std::cerr << "Warning: Deserializing base 'Statement' node type." << std::endl;
-             return std::make_unique<Statement>();
-         }
+        case NodeKind::Statement: // Base class
+              LOG_WARN("Warning: Deserializing base 'Statement' node type.");
+             return makeNode<Statement>();
+        default:
+            break;
+        }
         // --- Fallback for Expressions used as Statements --- 
         auto expr = expressionFromJson(j); 
         if(expr) {
-            if (node_type == "FunctionCallExpr" || node_type == "MemberAccessExpr") {
-                 return std::make_unique<ExpressionStmt>(std::move(expr));
+            if (kind == NodeKind::FunctionCallExpr || kind == NodeKind::MemberAccessExpr) {
+                 return makeNode<ExpressionStmt>(std::move(expr));
             } else {
                  throw std::runtime_error("Unhandled expression type ('" + node_type + "') found where statement expected.");
             }
@@ -246,28 +286,29 @@ std::unique_ptr<Statement> statementFromJson(const nlohmann::json& j) {
         throw std::runtime_error("Unknown or unhandled statement node_type: " + node_type);
         
      } catch (const nlohmann::json::exception& e) {
-         std::cerr << "JSON access error during statement deserialization ('" << node_type << "'): " << e.what() << std::endl;
+         LOG_ERROR("JSON access error during statement deserialization ('" << node_type << "'): " << e.what());
          return nullptr;
      } catch (const std::exception& e) {
-          std::cerr << "Error during statement deserialization ('" << node_type << "'): " << e.what() << std::endl;
+          LOG_ERROR("Error during statement deserialization ('" << node_type << "'): " << e.what());
          return nullptr;
      }
 }
 
-std::unique_ptr<ASTNode> fromJson(const nlohmann::json& j) {
+NodePtr<ASTNode> fromJson(const nlohmann::json& j, Arena& arena) {
      if (!j.is_object() || !j.contains("node_type")) return nullptr;
+     ArenaScope scope(arena);
      std::string node_type = j.at("node_type").get<std::string>();
 
     try {
          if (node_type == "ProgramNode") {
-              auto program = std::make_unique<ProgramNode>();
+              auto program = makeNode<ProgramNode>();
               if (j.contains("statements") && j.at("statements").is_array()) {
                  for (const auto& stmtJson : j["statements"]) {
                      auto statement = statementFromJson(stmtJson);
                      if(statement) { 
                         program->statements.push_back(std::move(statement));
                      } else {
-                          std::cerr << "Warning: Failed to deserialize a statement within ProgramNode." << std::endl;
+                          LOG_WARN("Warning: Failed to deserialize a statement within ProgramNode.");
                      }
                  }
               }
@@ -277,10 +318,20 @@ std::unique_ptr<ASTNode> fromJson(const nlohmann::json& j) {
          throw std::runtime_error("Expected 'ProgramNode' at the top level of AST JSON, found: " + node_type);
 
      } catch (const nlohmann::json::exception& e) {
-         std::cerr << "JSON access error during top-level deserialization ('" << node_type << "'): " << e.what() << std::endl;
+         LOG_ERROR("JSON access error during top-level deserialization ('" << node_type << "'): " << e.what());
          return nullptr;
      } catch (const std::exception& e) {
-          std::cerr << "Error during top-level deserialization ('" << node_type << "'): " << e.what() << std::endl;
+          LOG_ERROR("Error during top-level deserialization ('" << node_type << "'): " << e.what());
          return nullptr;
      }
-} 
\ No newline at end of file
+}
+
+NodePtr<ASTNode> readAstFile(const std::string& filename, Arena& arena) {
+    MappedFile file(filename);
+    if (isBinaryAstFile(file.data(), file.size())) {
+        return readBinaryAst(file.data(), file.size(), arena);
+    }
+    // JSON dump (parser/semantic analyzer run with --json)
+    nlohmann::json j = nlohmann::json::parse(file.data(), file.data() + file.size());
+    return fromJson(j, arena);
+}
@@ -2,7 +2,9 @@
 #define JSON_DESERIALIZER_H
 
 #include <memory>
+#include <string>
 #include "../common/json.hpp"
+#include "../common/arena.h"
 
 // Forward declare AST nodes instead of including ast.h directly
 // This avoids circular dependencies if ast.h needed json utils in the future
@@ -17,17 +19,24 @@ struct ForStmt;
 
 // --- Deserialization Function Declarations --- 
 
-std::unique_ptr<ASTNode> fromJson(const nlohmann::json& j);
+// Nodes and strings are allocated from arena (the AST lives as long as it does).
+ArenaPtr<ASTNode> fromJson(const nlohmann::json& j, Arena& arena);
 
-// Internal helpers (could be in .cpp if not needed outside)
-std::unique_ptr<Expression> expressionFromJson(const nlohmann::json& j);
-std::unique_ptr<Statement> statementFromJson(const nlohmann::json& j);
-std::unique_ptr<BlockStmt> blockStmtFromJson(const nlohmann::json& j);
-std::unique_ptr<VisibilityBlockStmt> visibilityBlockFromJson(const nlohmann::json& j);
+// Loads an AST/IR file in either the binary format (default) or the JSON debug dump,
+// detected from the file header. Throws if the file cannot be opened or parsed;
+// returns nullptr if JSON deserialization fails. The tree is allocated from arena.
+ArenaPtr<ASTNode> readAstFile(const std::string& filename, Arena& arena);
+
+// Internal helpers (could be in .cpp if not needed outside); they allocate
+// from the current arena (see ArenaScope)
+ArenaPtr<Expression> expressionFromJson(const nlohmann::json& j);
+ArenaPtr<Statement> statementFromJson(const nlohmann::json& j);
+ArenaPtr<BlockStmt> blockStmtFromJson(const nlohmann::json& j);
+ArenaPtr<VisibilityBlockStmt> visibilityBlockFromJson(const nlohmann::json& j);
 IfBranch ifBranchFromJson(const nlohmann::json& j);
 
 // Forward declare helpers if needed, though likely handled within statementFromJson
-// std::unique_ptr<WhileStmt> whileStmtFromJson(const nlohmann::json& j);
-// std::unique_ptr<ForStmt> forStmtFromJson(const nlohmann::json& j);
+// ArenaPtr<WhileStmt> whileStmtFromJson(const nlohmann::json& j);
+// ArenaPtr<ForStmt> forStmtFromJson(const nlohmann::json& j);
 
 #endif // JSON_DESERIALIZER_H 
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "line_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+LineTable::LineTable(std::vector<uint32_t> lineStarts) : lineStarts_(std::move(lineStarts)) {
+    if (lineStarts_.empty() || lineStarts_.front() != 0) {
+        lineStarts_.insert(lineStarts_.begin(), 0);
+    }
+}
+
+LineTable::LineTable(std::string_view source) : lineStarts_{0} {
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    for (const char* p = begin; p < end; ++p) {
+        p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!p) break;
+        lineStarts_.push_back(static_cast<uint32_t>(p + 1 - begin));
+    }
+}
+
+SourcePosition LineTable::position(uint32_t offset) const {
+    if (!tail_.empty() && offset >= tail_.back() + tailShift_) {
+        // tail_ runs from the last line back: find the first entry at or before offset
+        auto at = std::lower_bound(tail_.begin(), tail_.end(), offset,
+            [this](uint32_t stored, uint32_t value) { return stored + tailShift_ > value; });
+        size_t index = lineStarts_.size() + static_cast<size_t>(tail_.end() - at) - 1;
+        return {static_cast<int>(index + 1), static_cast<int>(offset - (*at + tailShift_) + 1)};
+    }
+    // Last line starting at or before offset
+    auto next = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), offset);
+    size_t index = static_cast<size_t>(next - lineStarts_.begin()) - 1;
+    return {static_cast<int>(index + 1), static_cast<int>(offset - lineStarts_[index] + 1)};
+}
+
+void LineTable::replace(uint32_t offset, uint32_t removedLength, std::string_view insertedText) {
+    // Move the split to the edit: lineStarts_ keeps the lines starting at or before it
+    auto later = std::partition_point(tail_.begin(), tail_.end(),
+        [this, offset](uint32_t stored) { return stored + tailShift_ > offset; });
+    for (auto it = tail_.end(); it != later; ) {
+        lineStarts_.push_back(*--it + tailShift_);
+    }
+    tail_.erase(later, tail_.end());
+    auto earlier = std::upper_bound(lineStarts_.begin() + 1, lineStarts_.end(), offset);
+    for (auto it = lineStarts_.end(); it != earlier; ) {
+        tail_.push_back(*--it - tailShift_);
+    }
+    lineStarts_.erase(earlier, lineStarts_.end());
+    // Lines that began after a removed newline are gone; inserted newlines start new ones
+    while (!tail_.empty() && tail_.back() + tailShift_ <= offset + removedLength) {
+        tail_.pop_back();
+    }
+    const char* begin = insertedText.data();
+    const char* end = begin + insertedText.size();
+    for (const char* p = begin; p < end; ++p) {
+        p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!p) break;
+        lineStarts_.push_back(static_cast<uint32_t>(offset + (p + 1 - begin)));
+    }
+    tailShift_ += static_cast<uint32_t>(insertedText.size()) - removedLength;
+}
+
+std::vector<uint32_t> LineTable::lineStarts() const {
+    std::vector<uint32_t> starts;
+    starts.reserve(lineCount());
+    starts.assign(lineStarts_.begin(), lineStarts_.end());
+    for (auto it = tail_.rbegin(); it != tail_.rend(); ++it) {
+        starts.push_back(*it + tailShift_);
+    }
+    return starts;
+}
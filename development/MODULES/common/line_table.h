@@ -0,0 +1,46 @@
+#ifndef LINE_TABLE_H
+#define LINE_TABLE_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 1-based line and column of a byte in the source.
+struct SourcePosition {
+    int line;
+    int column;
+};
+
+// --- Line table ---
+// Sorted byte offsets at which each source line starts (line 1 starts at 0).
+// Tokens only carry a byte offset; the lexer records this table once and
+// diagnostics or the text token dump turn offsets back into line/column with
+// a binary search, so nothing tracks lines while scanning.
+class LineTable {
+public:
+    LineTable() : lineStarts_{0} {}
+    // lineStarts must be sorted and begin with 0.
+    explicit LineTable(std::vector<uint32_t> lineStarts);
+    // Builds the table by finding every '\n' in source.
+    explicit LineTable(std::string_view source);
+
+    SourcePosition position(uint32_t offset) const;
+
+    // Patches the table for an edit of its source: the bytes [offset,
+    // offset + removedLength) were replaced by insertedText. Costs the
+    // inserted text plus the lines between this edit and the previous one.
+    void replace(uint32_t offset, uint32_t removedLength, std::string_view insertedText);
+
+    size_t lineCount() const { return lineStarts_.size() + tail_.size(); }
+    std::vector<uint32_t> lineStarts() const; // Every line start, in order
+
+private:
+    // Lines starting up to the last replace() are in lineStarts_. The rest
+    // are in tail_, last line first, stored relative to tailShift_, so an
+    // edit before them only moves tailShift_.
+    std::vector<uint32_t> lineStarts_;
+    std::vector<uint32_t> tail_;
+    uint32_t tailShift_ = 0; // Added (mod 2^32) to a tail_ entry gives its offset
+};
+
+#endif // LINE_TABLE_H
@@ -0,0 +1,49 @@
+#include "log.h"
+
+#include <cstdio>
+#include <iostream>
+
+LogLevel currentLogLevel = LogLevel::Info;
+
+void logMessage(LogLevel level, const std::string& message) {
+    const char* prefix = "";
+    switch (level) {
+        case LogLevel::Trace: prefix = "[trace] "; break;
+        case LogLevel::Debug: prefix = "[debug] "; break;
+        default: break; // info/warn/error messages carry their own wording
+    }
+    // One buffered write per message instead of a flush per << (stderr is unbuffered)
+    std::string line = prefix + message + "\n";
+    std::fwrite(line.data(), 1, line.size(), stderr);
+}
+
+bool parseLogLevel(const std::string& name, LogLevel& level) {
+    if (name == "trace") level = LogLevel::Trace;
+    else if (name == "debug") level = LogLevel::Debug;
+    else if (name == "info") level = LogLevel::Info;
+    else if (name == "warn") level = LogLevel::Warn;
+    else if (name == "error") level = LogLevel::Error;
+    else if (name == "off") level = LogLevel::Off;
+    else return false;
+    return true;
+}
+
+bool applyLogFlag(const std::string& arg) {
+    const std::string flag = "--log=";
+    if (arg.compare(0, flag.size(), flag) != 0) {
+        return false;
+    }
+    LogLevel level;
+    if (!parseLogLevel(arg.substr(flag.size()), level)) {
+        LOG_WARN("Warning: Unknown log level '" << arg.substr(flag.size())
+                 << "' (expected trace, debug, info, warn, error or off)");
+        return true;
+    }
+#ifdef NDEBUG
+    if (level < LogLevel::Info) {
+        LOG_WARN("Warning: trace/debug logging is compiled out of release builds");
+    }
+#endif
+    currentLogLevel = level;
+    return true;
+}
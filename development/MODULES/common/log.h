@@ -0,0 +1,57 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <sstream>
+#include <string>
+
+// --- Leveled logging shared by all modules ---
+// Usage: LOG_DEBUG("parsed " << count << " statements");
+// LOG_TRACE and LOG_DEBUG compile to nothing when NDEBUG is defined
+// (make BUILD=release), so they are safe to leave in hot loops.
+// The active level defaults to info and can be changed with --log=<level>.
+
+enum class LogLevel { Trace, Debug, Info, Warn, Error, Off };
+
+extern LogLevel currentLogLevel;
+
+inline bool logEnabled(LogLevel level) {
+    return level >= currentLogLevel;
+}
+
+// Writes one message to stderr (trace/debug lines get a level prefix).
+void logMessage(LogLevel level, const std::string& message);
+
+// Parses "trace", "debug", "info", "warn", "error" or "off". Returns false if unknown.
+bool parseLogLevel(const std::string& name, LogLevel& level);
+
+// Handles a "--log=<level>" command line argument.
+// Returns true if arg was a --log flag (valid or not) so callers can skip it.
+bool applyLogFlag(const std::string& arg);
+
+// The stream lives in a lambda so it takes stack space only while a message
+// is being written, not in every frame of the (possibly deeply recursive)
+// function that logs.
+#define HANAMI_LOG(level, expr) \
+    do { \
+        if (logEnabled(level)) { \
+            [&]() { \
+                std::ostringstream hanamiLogStream; \
+                hanamiLogStream << expr; \
+                logMessage(level, hanamiLogStream.str()); \
+            }(); \
+        } \
+    } while (0)
+
+#ifdef NDEBUG
+#define LOG_TRACE(expr) do { } while (0)
+#define LOG_DEBUG(expr) do { } while (0)
+#else
+#define LOG_TRACE(expr) HANAMI_LOG(LogLevel::Trace, expr)
+#define LOG_DEBUG(expr) HANAMI_LOG(LogLevel::Debug, expr)
+#endif
+
+#define LOG_INFO(expr)  HANAMI_LOG(LogLevel::Info, expr)
+#define LOG_WARN(expr)  HANAMI_LOG(LogLevel::Warn, expr)
+#define LOG_ERROR(expr) HANAMI_LOG(LogLevel::Error, expr)
+
+#endif // LOG_H
@@ -0,0 +1,103 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HANAMI_HAS_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string& filename) {
+    if (filename == "-") {
+        readAll(std::cin);
+        return;
+    }
+#ifdef HANAMI_HAS_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ == 0) { // mmap rejects empty mappings; an empty view is enough
+            ::close(fd);
+            return;
+        }
+        void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            ::close(fd);
+            data_ = static_cast<const char*>(mapping);
+            mapped_ = true;
+            return;
+        }
+    }
+    ::close(fd);
+    size_ = 0;
+#endif
+    // Fallback: read the whole file into an owned buffer
+    std::ifstream inFile(filename, std::ios::binary);
+    if (!inFile) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    readAll(inFile);
+}
+
+void MappedFile::readAll(std::istream& in) {
+    // Read straight into fallback_ in growing chunks, so the contents are held
+    // once (a stringstream would hold them twice while copying out)
+    size_t chunk = 64 * 1024;
+    size_t used = 0;
+    while (in) {
+        fallback_.resize(used + chunk);
+        in.read(&fallback_[used], static_cast<std::streamsize>(chunk));
+        used += static_cast<size_t>(in.gcount());
+        if (chunk < 16 * 1024 * 1024) chunk *= 2;
+    }
+    if (in.bad()) {
+        throw std::runtime_error("Could not read input");
+    }
+    fallback_.resize(used);
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapped_ = other.mapped_;
+        size_ = other.size_;
+        fallback_ = std::move(other.fallback_);
+        data_ = mapped_ ? other.data_ : fallback_.data();
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+#ifdef HANAMI_HAS_MMAP
+    if (mapped_ && data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    fallback_.clear();
+}
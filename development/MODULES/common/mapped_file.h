@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <iosfwd>
+
+// Read-only view over the full contents of a file.
+// On POSIX systems the file is mmap'ed, so large inputs are paged in by the OS
+// instead of being copied into a std::string. Everywhere else (or if mapping
+// fails, e.g. for pipes) the contents are read into an owned buffer and exposed
+// the same way. The filename "-" reads standard input.
+class MappedFile {
+public:
+    MappedFile() = default;
+    // Throws std::runtime_error if the file cannot be opened or read.
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+    bool isMapped() const { return mapped_; }
+
+private:
+    void release();
+    void readAll(std::istream& in); // Fallback: fill fallback_ from a stream
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string fallback_; // Owns the bytes when the file could not be mapped
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,104 @@
+#include "numeric_literal.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+namespace {
+
+int digitValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+NumericLiteral decodeInteger(std::string_view text) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+    unsigned base = 10;
+    if (text.size() - i >= 2 && text[i] == '0') {
+        switch (text[i + 1]) {
+            case 'x': case 'X': base = 16; break;
+            case 'b': case 'B': base = 2; break;
+            case 'o': case 'O': base = 8; break;
+        }
+        if (base != 10) i += 2;
+    }
+
+    // Accumulate the magnitude; the first non-digit starts the l/L/u/U suffix
+    const uint64_t limit = negative ? uint64_t(std::numeric_limits<int64_t>::max()) + 1
+                                    : uint64_t(std::numeric_limits<int64_t>::max());
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    for (; i < text.size(); ++i) {
+        if (text[i] == '\'') continue;
+        int digit = digitValue(text[i]);
+        if (digit < 0 || digit >= static_cast<int>(base)) break;
+        if (magnitude > (limit - digit) / base) {
+            overflow = true;
+            magnitude = limit;
+            break;
+        }
+        magnitude = magnitude * base + digit;
+    }
+
+    NumericLiteral literal;
+    literal.overflow = overflow;
+    if (negative && magnitude > 0) {
+        literal.value.integer = -static_cast<int64_t>(magnitude - 1) - 1; // Reaches INT64_MIN without overflow
+    } else {
+        literal.value.integer = static_cast<int64_t>(magnitude);
+    }
+    return literal;
+}
+
+NumericLiteral decodeReal(TokenType type, std::string_view text) {
+    // strto{f,d} need a NUL-terminated copy without the ' separators; they
+    // read decimal and hex (0x...p...) forms and stop at the f/F suffix.
+    char small[64];
+    std::string large;
+    char* buffer = small;
+    if (text.size() >= sizeof(small)) {
+        large.resize(text.size() + 1);
+        buffer = &large[0];
+    }
+    size_t length = 0;
+    for (char c : text) {
+        if (c != '\'') buffer[length++] = c;
+    }
+    buffer[length] = '\0';
+
+    NumericLiteral literal;
+    errno = 0;
+    if (type == TokenType::FLOAT_LITERAL) {
+        float value = std::strtof(buffer, nullptr);
+        literal.value.real = value;
+        literal.overflow = errno == ERANGE && std::isinf(value);
+    } else {
+        double value = std::strtod(buffer, nullptr);
+        literal.value.real = value;
+        literal.overflow = errno == ERANGE && std::isinf(value);
+    }
+    return literal;
+}
+
+} // namespace
+
+NumericLiteral decodeNumericLiteral(TokenType type, std::string_view text) {
+    switch (type) {
+        case TokenType::NUMBER:
+            return decodeInteger(text);
+        case TokenType::FLOAT_LITERAL:
+        case TokenType::DOUBLE_LITERAL:
+            return decodeReal(type, text);
+        default:
+            return NumericLiteral();
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef NUMERIC_LITERAL_H
+#define NUMERIC_LITERAL_H
+
+#include <cstdint>
+#include <string_view>
+
+#include "token.h"
+
+// --- Numeric literal values ---
+// The parser decodes every NUMBER, FLOAT_LITERAL and DOUBLE_LITERAL once, as
+// it builds the literal AST node, and the value travels in the node next to
+// the original text (which code generators keep emitting verbatim). Tokens
+// carry only the text, so the lexer's hot loop never pays for decoding.
+// Accepted spellings are the ones Lexer::Number produces: optional sign,
+// decimal / 0x / 0b / 0o digits with ' separators, hex or decimal fraction
+// and exponent, and f/F or l/L/u/U suffixes.
+
+// Decoded value of a numeric literal
+union NumericValue {
+    int64_t integer = 0; // NUMBER
+    double real;         // FLOAT_LITERAL, DOUBLE_LITERAL
+};
+
+struct NumericLiteral {
+    NumericValue value;    // integer for NUMBER, real for FLOAT_LITERAL / DOUBLE_LITERAL
+    bool overflow = false; // Did not fit: integers saturate at INT64_MIN/MAX, reals become +-infinity
+};
+
+// Decodes the text of a literal token of the given type. Other token types
+// decode to 0.
+NumericLiteral decodeNumericLiteral(TokenType type, std::string_view text);
+
+inline bool isNumericLiteral(TokenType type) {
+    return type == TokenType::NUMBER || type == TokenType::FLOAT_LITERAL ||
+           type == TokenType::DOUBLE_LITERAL;
+}
+
+#endif // NUMERIC_LITERAL_H
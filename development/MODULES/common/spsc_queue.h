@@ -0,0 +1,78 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+// --- Bounded single-producer/single-consumer queue ---
+// Ring buffer that hands values from exactly one producer thread to exactly
+// one consumer thread without locks: each side owns one index and publishes
+// it with a release store, and keeps a cached copy of the other side's index
+// so the shared cache line is only read when the ring looks full or empty.
+// push() and pop() yield while they have to wait.
+// Either side may close() the queue. After the producer closes it, the
+// consumer drains what is left and then pop() returns false. After the
+// consumer closes it (it is giving up), push() returns false, so the
+// producer is never left blocked on a full ring.
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Blocks while the ring is full; false if the queue is closed.
+    bool push(T value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (tail - headCache_ == Capacity) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ != Capacity) break;
+            if (closed_.load(std::memory_order_acquire)) return false;
+            std::this_thread::yield();
+        }
+        if (closed_.load(std::memory_order_relaxed)) return false;
+        slots_[tail & MASK] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Blocks while the ring is empty; false once it is closed
+    // and everything pushed before that has been popped.
+    bool pop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        while (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head != tailCache_) break;
+            if (closed_.load(std::memory_order_acquire)) {
+                // Values pushed just before close() are visible now
+                tailCache_ = tail_.load(std::memory_order_acquire);
+                if (head == tailCache_) return false;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        value = std::move(slots_[head & MASK]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+    static constexpr size_t CACHE_LINE = 64;
+
+    // Consumer-owned, producer-owned and shared state on separate cache lines
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t tailCache_ = 0;
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t headCache_ = 0;
+    alignas(CACHE_LINE) std::atomic<bool> closed_{false};
+    alignas(CACHE_LINE) T slots_[Capacity];
+};
+
+#endif // SPSC_QUEUE_H
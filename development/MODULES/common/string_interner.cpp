@@ -0,0 +1,97 @@
+#include "string_interner.h"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "arena.h"
+
+namespace {
+
+// Names live in fixed-size pages that never move once published, so name()
+// can read them without taking the lock that intern() holds while appending.
+constexpr SymbolId PAGE_BITS = 14;
+constexpr SymbolId PAGE_SIZE = SymbolId(1) << PAGE_BITS;
+constexpr SymbolId PAGE_COUNT = StringInterner::MAX_SYMBOLS / PAGE_SIZE;
+
+} // namespace
+
+struct StringInterner::Impl {
+    std::mutex mutex;                                   // Guards everything but the page slots' contents
+    Arena text;                                         // Interned bytes
+    std::unordered_map<std::string_view, SymbolId> ids; // Keys view into text
+    std::atomic<std::string_view*> pages[PAGE_COUNT] = {};
+    SymbolId count = 0;
+};
+
+StringInterner::StringInterner() : impl_(new Impl) {
+    // Order fixes the ids in the Symbols namespace
+    for (const char* name : {"", "int", "string", "bool", "float", "double", "void"}) {
+        intern(name);
+    }
+}
+
+StringInterner::~StringInterner() {
+    for (auto& page : impl_->pages) {
+        delete[] page.load(std::memory_order_relaxed);
+    }
+}
+
+SymbolId StringInterner::intern(std::string_view s) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->ids.find(s);
+    if (it != impl_->ids.end()) return it->second;
+
+    SymbolId id = impl_->count;
+    if (id >= MAX_SYMBOLS) {
+        throw std::length_error("StringInterner: too many distinct names");
+    }
+    std::atomic<std::string_view*>& slot = impl_->pages[id >> PAGE_BITS];
+    std::string_view* page = slot.load(std::memory_order_relaxed);
+    if (!page) {
+        page = new std::string_view[PAGE_SIZE];
+        slot.store(page, std::memory_order_release);
+    }
+    std::string_view stored = impl_->text.copyString(s);
+    page[id & (PAGE_SIZE - 1)] = stored;
+    impl_->ids.emplace(stored, id);
+    impl_->count = id + 1;
+    return id;
+}
+
+std::string_view StringInterner::name(SymbolId id) const {
+    return impl_->pages[id >> PAGE_BITS].load(std::memory_order_acquire)[id & (PAGE_SIZE - 1)];
+}
+
+size_t StringInterner::size() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->count;
+}
+
+StringInterner& globalInterner() {
+    static StringInterner interner;
+    return interner;
+}
+
+SymbolId SymbolCache::add(std::string_view s, size_t slot) {
+    if (s.size() > UINT32_MAX) {
+        throw std::length_error("SymbolCache: name too long");
+    }
+    entries_.push_back({s, 0});
+    SymbolId local = static_cast<SymbolId>(entries_.size());
+    slots_[slot] = {s.data(), static_cast<uint32_t>(s.size()), local};
+    if (entries_.size() * 2 > slots_.size()) {
+        // Keep the load under one half: rehash into twice the slots
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(old.size() * 2, Slot{nullptr, 0, 0});
+        size_t mask = slots_.size() - 1;
+        for (const Slot& kept : old) {
+            if (kept.local == 0) continue;
+            size_t i = hash(std::string_view(kept.data, kept.size)) & mask;
+            while (slots_[i].local != 0) i = (i + 1) & mask;
+            slots_[i] = kept;
+        }
+    }
+    return local;
+}
@@ -0,0 +1,188 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- String interning ---
+// Identifiers and type names are stored once per process in the global
+// StringInterner and named by a 32-bit SymbolId, so the AST and the symbol
+// table compare and hash them as integers. The lexer interns identifiers as
+// it scans; stages reading a .tokens/.ast file intern the names they load.
+// Ids are only meaningful inside the process that handed them out.
+using SymbolId = uint32_t;
+
+class StringInterner {
+public:
+    // intern() throws std::length_error once this many strings are stored
+    static constexpr SymbolId MAX_SYMBOLS = SymbolId(1) << 28;
+
+    StringInterner();
+    ~StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // Id of s, adding a copy of it on first sight. Thread-safe.
+    SymbolId intern(std::string_view s);
+
+    // Text of an id returned by intern(). Lock-free; safe from any thread the
+    // id was handed to. The view stays valid for the interner's lifetime.
+    std::string_view name(SymbolId id) const;
+
+    size_t size() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Interner shared by every stage in this process.
+StringInterner& globalInterner();
+
+// --- SymbolCache ---
+// Single-threaded front of globalInterner() for one lexer. A name seen
+// before costs one probe of this private table instead of the interner's
+// lock. Names get dense local ids (1, 2, ...) here; resolve() maps a local id
+// to the interner's id, interning the name the first time. A lexer whose
+// tokens may still be thrown away keeps local ids and resolves only the
+// tokens it keeps. Keys view the caller's text, which must outlive the cache.
+class SymbolCache {
+public:
+    // Local id of s, adding it on first sight. Never 0.
+    SymbolId local(std::string_view s) {
+        size_t mask = slots_.size() - 1; // slots_ is never empty
+        for (size_t i = hash(s) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (slot.local == 0) return add(s, i);
+            if (slot.size == s.size() && std::memcmp(slot.data, s.data(), s.size()) == 0) return slot.local;
+        }
+    }
+    // Interner id of the name with this local id; 0 stays 0
+    SymbolId resolve(SymbolId local) {
+        if (local == 0) return 0;
+        Entry& entry = entries_[local - 1];
+        if (entry.id == 0) entry.id = globalInterner().intern(entry.name);
+        return entry.id;
+    }
+    SymbolId intern(std::string_view s) { return resolve(local(s)); }
+
+private:
+    struct Slot {
+        const char* data;
+        uint32_t size;
+        SymbolId local; // 0 = empty
+    };
+    struct Entry {
+        std::string_view name;
+        SymbolId id; // 0 = not interned yet
+    };
+    std::vector<Slot> slots_ = std::vector<Slot>(256, Slot{nullptr, 0, 0}); // Open addressing, power-of-two size
+    std::vector<Entry> entries_; // By local id - 1
+
+    // Mixes the length with the first and last four bytes: cheap for the
+    // short names lexers see, and collisions only cost a compare
+    static size_t hash(std::string_view s) {
+        uint64_t h = s.size();
+        if (s.size() >= 4) {
+            uint32_t head, tail;
+            std::memcpy(&head, s.data(), 4);
+            std::memcpy(&tail, s.data() + s.size() - 4, 4);
+            h ^= (uint64_t(head) << 32 | tail);
+        } else {
+            for (char c : s) h = h << 8 | static_cast<unsigned char>(c);
+        }
+        h *= 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> 32);
+    }
+    SymbolId add(std::string_view s, size_t slot);
+};
+
+// --- Symbol ---
+// Interned string by value: equality and hashing use the id, and the text is
+// looked up on demand. Like StrRef it converts to std::string_view and
+// std::string wherever one is expected. The default Symbol is "".
+class Symbol {
+public:
+    constexpr Symbol() = default;
+    Symbol(std::string_view s) : id_(globalInterner().intern(s)) {}
+    Symbol(const std::string& s) : Symbol(std::string_view(s)) {}
+    Symbol(const char* s) : Symbol(std::string_view(s)) {}
+
+    static constexpr Symbol fromId(SymbolId id) {
+        Symbol symbol;
+        symbol.id_ = id;
+        return symbol;
+    }
+
+    SymbolId id() const { return id_; }
+    bool empty() const { return id_ == 0; }
+    std::string_view view() const { return globalInterner().name(id_); }
+    std::string str() const { return std::string(view()); }
+    operator std::string_view() const { return view(); }
+    operator std::string() const { return str(); }
+
+    friend bool operator==(Symbol a, Symbol b) { return a.id_ == b.id_; }
+    friend bool operator!=(Symbol a, Symbol b) { return a.id_ != b.id_; }
+    // Comparing with plain text compares the text and interns nothing
+    friend bool operator==(Symbol a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(Symbol a, std::string_view b) { return a.view() != b; }
+    friend bool operator==(Symbol a, const std::string& b) { return a.view() == b; }
+    friend bool operator!=(Symbol a, const std::string& b) { return a.view() != b; }
+    friend bool operator==(Symbol a, const char* b) { return a.view() == b; }
+    friend bool operator!=(Symbol a, const char* b) { return a.view() != b; }
+
+private:
+    SymbolId id_ = 0;
+};
+
+// Type names every stage checks for, interned first so their ids are fixed
+namespace Symbols {
+constexpr Symbol Int = Symbol::fromId(1);
+constexpr Symbol String = Symbol::fromId(2);
+constexpr Symbol Bool = Symbol::fromId(3);
+constexpr Symbol Float = Symbol::fromId(4);
+constexpr Symbol Double = Symbol::fromId(5);
+constexpr Symbol Void = Symbol::fromId(6);
+} // namespace Symbols
+
+inline std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+    return os << symbol.view();
+}
+
+inline std::string operator+(const std::string& a, Symbol b) {
+    std::string_view text = b.view();
+    std::string result;
+    result.reserve(a.size() + text.size());
+    result.append(a).append(text.data(), text.size());
+    return result;
+}
+inline std::string operator+(std::string&& a, Symbol b) {
+    std::string_view text = b.view();
+    a.append(text.data(), text.size());
+    return std::move(a);
+}
+inline std::string operator+(Symbol a, const std::string& b) {
+    return a.str().append(b);
+}
+inline std::string operator+(const char* a, Symbol b) {
+    return std::string(a) + b;
+}
+inline std::string operator+(Symbol a, const char* b) {
+    return a.str().append(b);
+}
+
+namespace std {
+template <>
+struct hash<Symbol> {
+    size_t operator()(Symbol symbol) const noexcept { return std::hash<SymbolId>()(symbol.id()); }
+};
+} // namespace std
+
+#endif // STRING_INTERNER_H
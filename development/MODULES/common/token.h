@@ -1,12 +1,17 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <unordered_map>
 
+#include "string_interner.h"
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     // Hanami Keywords
     GARDEN,     // namespace
     SPECIES,    // class
@@ -56,13 +61,44 @@ enum class TokenType {
     STYLE_INCLUDE, SCOPE_RESOLUTION, NEWLINE
 };
 
+constexpr size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::NEWLINE) + 1;
+static_assert(TOKEN_TYPE_COUNT <= 64, "TokenTypeSet needs one bit per TokenType");
+
+// A set of token types as a 64-bit mask, so membership is a single AND.
+// Build one from a braced list: TokenTypeSet{TokenType::PLUS, TokenType::MINUS}.
+class TokenTypeSet {
+public:
+    constexpr TokenTypeSet() = default;
+    constexpr TokenTypeSet(std::initializer_list<TokenType> types) {
+        for (TokenType type : types) bits_ |= bit(type);
+    }
+    constexpr bool contains(TokenType type) const { return (bits_ & bit(type)) != 0; }
+
+private:
+    static constexpr uint64_t bit(TokenType type) { return uint64_t(1) << static_cast<unsigned>(type); }
+    uint64_t bits_ = 0;
+};
 
 
 
+
+// The lexeme is a view, not a copy: it points into whatever produced the token
+// (the Lexer's source buffer, or a mapped .tokens file), which must outlive it.
+// The interned id of an IDENTIFIER shares a word with the type, keeping a
+// token at 24 bytes; 0 means "not interned" (tokens read back from a file, or
+// an id too large for the field), and the parser then interns the lexeme itself.
+// Numeric literals carry only their text; the parser decodes the value when it
+// builds the literal node (numeric_literal.h).
 struct Token
 {
+    static constexpr SymbolId MAX_SYMBOL = (SymbolId(1) << 24) - 1;
+
     TokenType type;
-    std::string lexeme; //string duoc phan loai roi
-    int line;   //
-    int column;
+    SymbolId symbol : 24;
+    uint32_t offset;         // byte offset of the token in the source; LineTable gives line/column
+    std::string_view lexeme; //string duoc phan loai roi
+
+    Token() : type(TokenType::ERROR), symbol(0), offset(0) {}
+    Token(TokenType type, uint32_t offset, std::string_view lexeme, SymbolId symbol = 0)
+        : type(type), symbol(symbol <= MAX_SYMBOL ? symbol : 0), offset(offset), lexeme(lexeme) {}
 };
@@ -0,0 +1,335 @@
+#include "token_io.h"
+#include "utils.h"
+#include "log.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+bool isBinaryTokenFile(const char* data, size_t size) {
+    return size >= sizeof(TOKEN_FILE_MAGIC) &&
+           std::memcmp(data, TOKEN_FILE_MAGIC, sizeof(TOKEN_FILE_MAGIC)) == 0;
+}
+
+bool writeBinaryTokens(const std::string& filename, const std::vector<Token>& tokens,
+                       const LineTable& lines) {
+    std::vector<PackedToken> records;
+    records.reserve(tokens.size());
+    std::string pool;
+    std::unordered_map<std::string_view, uint32_t> pooled; // lexeme -> offset in pool
+
+    // Keys view the source tokens' lexemes rather than the pool, which reallocates as it grows
+    for (const auto& token : tokens) {
+        std::string_view lexeme = token.lexeme;
+        auto it = pooled.find(lexeme);
+        uint32_t offset;
+        if (it != pooled.end()) {
+            offset = it->second;
+        } else {
+            offset = static_cast<uint32_t>(pool.size());
+            pool.append(lexeme.data(), lexeme.size());
+            pooled.emplace(lexeme, offset);
+        }
+        records.push_back({static_cast<uint32_t>(token.type), offset,
+                           static_cast<uint32_t>(lexeme.size()), token.offset});
+
+        // Stop writing after EOF_TOKEN (same as the text format)
+        if (token.type == TokenType::EOF_TOKEN) {
+            break;
+        }
+    }
+
+    TokenFileHeader header;
+    std::memcpy(header.magic, TOKEN_FILE_MAGIC, sizeof(header.magic));
+    header.version = TOKEN_FILE_VERSION;
+    header.tokenCount = static_cast<uint32_t>(records.size());
+    header.recordSize = sizeof(PackedToken);
+    header.lineCount = static_cast<uint32_t>(lines.lineCount());
+    header.reserved = 0;
+    header.stringPoolSize = pool.size();
+
+    std::ofstream outFile(filename, std::ios::binary);
+    if (!outFile) {
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(PackedToken)));
+    outFile.write(reinterpret_cast<const char*>(lines.lineStarts().data()),
+                  static_cast<std::streamsize>(lines.lineCount() * sizeof(uint32_t)));
+    outFile.write(pool.data(), static_cast<std::streamsize>(pool.size()));
+    return static_cast<bool>(outFile);
+}
+
+BinaryTokenReader::BinaryTokenReader(const char* data, size_t size) {
+    if (size < sizeof(TokenFileHeader) || !isBinaryTokenFile(data, size)) {
+        throw std::runtime_error("Not a binary token file (missing header)");
+    }
+    TokenFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != TOKEN_FILE_VERSION) {
+        throw std::runtime_error("Unsupported binary token file version: " + std::to_string(header.version));
+    }
+    if (header.recordSize != sizeof(PackedToken)) {
+        throw std::runtime_error("Binary token file record size mismatch");
+    }
+    size_t recordsBytes = static_cast<size_t>(header.tokenCount) * sizeof(PackedToken);
+    size_t linesBytes = static_cast<size_t>(header.lineCount) * sizeof(uint32_t);
+    size_t body = size - sizeof(TokenFileHeader);
+    if (body < recordsBytes || body - recordsBytes < linesBytes ||
+        body - recordsBytes - linesBytes < header.stringPoolSize) {
+        throw std::runtime_error("Binary token file is truncated");
+    }
+
+    // The header is 32 bytes, so records and line starts stay 4-byte aligned in a mapped file
+    records_ = reinterpret_cast<const PackedToken*>(data + sizeof(TokenFileHeader));
+    lineStarts_ = reinterpret_cast<const uint32_t*>(data + sizeof(TokenFileHeader) + recordsBytes);
+    lineCount_ = header.lineCount;
+    pool_ = data + sizeof(TokenFileHeader) + recordsBytes + linesBytes;
+    count_ = header.tokenCount;
+
+    for (size_t i = 1; i < lineCount_; ++i) {
+        if (lineStarts_[i] < lineStarts_[i - 1]) {
+            throw std::runtime_error("Binary token file has an unsorted line table");
+        }
+    }
+
+    // Validate types and lexeme ranges once so operator[] can stay unchecked
+    for (size_t i = 0; i < count_; ++i) {
+        const PackedToken& record = records_[i];
+        if (record.type >= TOKEN_TYPE_COUNT) {
+            throw std::runtime_error("Binary token file has an invalid token type at token " + std::to_string(i));
+        }
+        if (record.offset > header.stringPoolSize ||
+            record.length > header.stringPoolSize - record.offset) {
+            throw std::runtime_error("Binary token file has an out-of-range lexeme at token " + std::to_string(i));
+        }
+    }
+}
+
+Token BinaryTokenReader::operator[](size_t index) const {
+    const PackedToken& record = records_[index];
+    return Token(static_cast<TokenType>(record.type), record.sourceOffset,
+                 std::string_view(pool_ + record.offset, record.length));
+}
+
+LineTable BinaryTokenReader::lineTable() const {
+    return LineTable(std::vector<uint32_t>(lineStarts_, lineStarts_ + lineCount_));
+}
+
+namespace {
+
+bool isFieldSeparator(char c) {
+    return c == ' ' || c == '\t';
+}
+
+bool isLineSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// std::isspace in the "C" locale, without the call
+bool isAsciiSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+std::string_view trimSpace(std::string_view s) {
+    while (!s.empty() && isAsciiSpace(s.front())) s.remove_prefix(1);
+    while (!s.empty() && isAsciiSpace(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+// The fields of one "TYPE [lexeme] line column" line, still escaped
+struct TextTokenLine {
+    std::string_view typeName;
+    std::string_view lexeme;
+    int line = 0;
+    int column = 0;
+};
+
+// Reads the run of digits ending at `end` (at most 9, so it fits an int) and
+// the single space before it. Returns the position of that space, or nullptr.
+const char* parseTrailingNumber(const char* begin, const char* end, int& value) {
+    const char* p = end;
+    int scale = 1;
+    value = 0;
+    while (p > begin && isDigit(p[-1]) && end - p < 9) {
+        --p;
+        value += (*p - '0') * scale;
+        scale *= 10;
+    }
+    if (p == end || p == begin || p[-1] != ' ') return nullptr;
+    return p - 1;
+}
+
+// Fast path for lines as writeTextTokens produces them: an upper-case type
+// name, an optional lexeme and two plain numbers, separated by single spaces.
+// Returns false for anything else, which splitTokenLine then handles.
+bool splitWrittenTokenLine(std::string_view line, TextTokenLine& fields) {
+    const char* begin = line.data();
+    const char* columnSpace = parseTrailingNumber(begin, begin + line.size(), fields.column);
+    if (!columnSpace) return false;
+    const char* lineSpace = parseTrailingNumber(begin, columnSpace, fields.line);
+    if (!lineSpace) return false;
+
+    const char* typeEnd = begin;
+    while (typeEnd < lineSpace && ((*typeEnd >= 'A' && *typeEnd <= 'Z') || *typeEnd == '_')) ++typeEnd;
+    if (typeEnd == begin) return false;
+    fields.typeName = std::string_view(begin, typeEnd - begin);
+    if (typeEnd == lineSpace) {
+        fields.lexeme = std::string_view();
+    } else if (*typeEnd == ' ') {
+        fields.lexeme = trimSpace(std::string_view(typeEnd + 1, lineSpace - typeEnd - 1));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Position of the last ' ' or '\t' before `before`, or npos.
+size_t findLastSeparator(std::string_view line, size_t before) {
+    while (before > 0) {
+        if (isFieldSeparator(line[--before])) return before;
+    }
+    return std::string_view::npos;
+}
+
+// Reads a line/column number the way std::stoi did (leading whitespace, an
+// optional sign, digits up to the first non-digit), without throwing.
+bool parseTextInt(std::string_view field, int& value) {
+    const char* first = field.data();
+    const char* last = field.data() + field.size();
+    while (first != last && isAsciiSpace(*first)) ++first;
+    if (first != last && *first == '+') {
+        ++first;
+        if (first == last || !isDigit(*first)) return false;
+    }
+    return std::from_chars(first, last, value).ec == std::errc();
+}
+
+// Splits any line the old reader accepted: fields may be separated by runs of
+// spaces or tabs and the numbers may carry a sign. Warns and returns false if
+// the line is malformed. `lineNum` is the line's 1-based position in the file.
+bool splitTokenLine(std::string_view line, int lineNum, TextTokenLine& fields) {
+    // 1. The column number follows the last space
+    size_t lastSpacePos = findLastSeparator(line, line.size());
+    if (lastSpacePos == std::string_view::npos) {
+        LOG_WARN("Warning [L" << lineNum << "]: Malformed token line (no space before line/col?): '" << line << "'");
+        return false;
+    }
+    if (!parseTextInt(line.substr(lastSpacePos + 1), fields.column)) {
+        LOG_WARN("Warning [L" << lineNum << "]: Malformed token line (invalid column number?): '" << line << "'");
+        return false;
+    }
+
+    // 2. The line number sits between the last two spaces
+    size_t secondLastSpacePos = findLastSeparator(line, lastSpacePos);
+    if (secondLastSpacePos == std::string_view::npos) {
+        LOG_WARN("Warning [L" << lineNum << "]: Malformed token line (no space before line number?): '" << line << "'");
+        return false;
+    }
+    if (!parseTextInt(line.substr(secondLastSpacePos + 1, lastSpacePos - secondLastSpacePos - 1), fields.line)) {
+        LOG_WARN("Warning [L" << lineNum << "]: Malformed token line (invalid line number?): '" << line << "'");
+        return false;
+    }
+
+    // 3. The type runs up to the first space; anything before the line number is the lexeme
+    size_t firstSpacePos = 0;
+    while (!isFieldSeparator(line[firstSpacePos])) ++firstSpacePos; // Stops at secondLastSpacePos at the latest
+    fields.typeName = line.substr(0, firstSpacePos);
+    fields.lexeme = std::string_view();
+    if (firstSpacePos < secondLastSpacePos) {
+        fields.lexeme = trimSpace(line.substr(firstSpacePos + 1, secondLastSpacePos - firstSpacePos - 1));
+    }
+    return true;
+}
+
+// Undoes escapeStringForOutput for a STRING lexeme. Without a backslash the
+// lexeme is returned as is; otherwise it is unescaped straight into `text`.
+// Unknown escapes keep their backslash.
+std::string_view unescapeTextLexeme(std::string_view lexeme, Arena& text) {
+    size_t backslash = lexeme.find('\\');
+    if (backslash == std::string_view::npos) return lexeme;
+
+    char* out = static_cast<char*>(text.allocate(lexeme.size(), 1)); // Unescaping never grows it
+    std::memcpy(out, lexeme.data(), backslash);
+    size_t length = backslash;
+    for (size_t i = backslash; i < lexeme.size(); ++i) {
+        if (lexeme[i] == '\\' && i + 1 < lexeme.size()) {
+            char next = lexeme[++i];
+            switch (next) {
+                case '"': out[length++] = '"'; break;
+                case '\\': out[length++] = '\\'; break;
+                case 'n': out[length++] = '\n'; break;
+                case 'r': out[length++] = '\r'; break;
+                case 't': out[length++] = '\t'; break;
+                default:
+                    out[length++] = '\\';
+                    out[length++] = next;
+                    break;
+            }
+        } else {
+            out[length++] = lexeme[i];
+        }
+    }
+    return std::string_view(out, length);
+}
+
+} // namespace
+
+std::vector<Token> readTextTokens(const char* data, size_t size, Arena& text, LineTable& lines) {
+    std::vector<Token> tokens;
+    std::vector<uint32_t> lineStarts{0};
+    uint32_t lineEnd = 0; // One past the widest column used on the last line so far
+    int currentLineNum = 0;
+
+    const char* end = data + size;
+    tokens.reserve(std::count(data, end, '\n') + 1); // At most one token per line
+    const char* cursor = data;
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        const char* lineStop = newline ? newline : end;
+        std::string_view line(cursor, lineStop - cursor);
+        cursor = newline ? newline + 1 : end;
+        currentLineNum++;
+
+        while (!line.empty() && isLineSpace(line.front())) line.remove_prefix(1);
+        while (!line.empty() && isLineSpace(line.back())) line.remove_suffix(1);
+        if (line.empty()) {
+            continue;
+        }
+
+        TextTokenLine fields;
+        if (!splitWrittenTokenLine(line, fields) && !splitTokenLine(line, currentLineNum, fields)) {
+            continue;
+        }
+
+        TokenType currentType;
+        if (!tokenTypeFromName(fields.typeName, currentType)) {
+            currentType = stringToTokenType(std::string(fields.typeName)); // Numeric type values, or throws
+        }
+        std::string_view lexeme = fields.lexeme;
+        if (currentType == TokenType::STRING) {
+            lexeme = unescapeTextLexeme(lexeme, text);
+        }
+
+        // Place the token in the stand-in line table
+        int tokenLine = std::max(fields.line, 1);
+        int tokenColumn = std::max(fields.column, 1);
+        while (lineStarts.size() < static_cast<size_t>(tokenLine)) {
+            lineStarts.push_back(++lineEnd); // The '\n' ending the previous line takes one byte
+        }
+        uint32_t offset = lineStarts[std::min(lineStarts.size(), static_cast<size_t>(tokenLine)) - 1] + tokenColumn - 1;
+        if (static_cast<size_t>(tokenLine) == lineStarts.size()) lineEnd = std::max(lineEnd, offset + 1);
+        tokens.emplace_back(currentType, offset, lexeme);
+    }
+
+    lines = LineTable(std::move(lineStarts));
+    return tokens;
+}
@@ -0,0 +1,94 @@
+#ifndef TOKEN_IO_H
+#define TOKEN_IO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "token.h"
+#include "line_table.h"
+#include "arena.h"
+
+// --- Binary token stream (.tokens) ---
+// Written by the lexer by default (the old text format is kept behind --text).
+// Layout, in host byte order:
+//
+//   TokenFileHeader                   magic "HNTK", version, counts
+//   PackedToken[tokenCount]           fixed-size records
+//   uint32_t lineStarts[lineCount]    the source's LineTable
+//   char stringPool[stringPoolSize]   lexeme bytes, not NUL-terminated
+//
+// Each record points at its lexeme with (offset, length) into the pool, so a
+// reader can walk a mapped file without allocating. Identical lexemes share a
+// single copy in the pool. Records keep only the token's source offset; the
+// line table turns it back into line/column when a diagnostic needs one.
+
+constexpr char TOKEN_FILE_MAGIC[4] = {'H', 'N', 'T', 'K'};
+constexpr uint32_t TOKEN_FILE_VERSION = 2;
+
+struct TokenFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t tokenCount;
+    uint32_t recordSize;      // sizeof(PackedToken), checked on read
+    uint32_t lineCount;
+    uint32_t reserved;        // Zero; keeps stringPoolSize 8-byte aligned
+    uint64_t stringPoolSize;
+};
+
+struct PackedToken {
+    uint32_t type;            // TokenType value
+    uint32_t offset;          // Lexeme start in the string pool
+    uint32_t length;          // Lexeme length in bytes
+    uint32_t sourceOffset;    // Token::offset
+};
+
+static_assert(sizeof(TokenFileHeader) == 32, "TokenFileHeader must stay packed");
+static_assert(sizeof(PackedToken) == 16, "PackedToken must stay packed");
+
+// True if the buffer starts with the binary token file magic.
+bool isBinaryTokenFile(const char* data, size_t size);
+
+// Writes tokens (up to and including the first EOF_TOKEN) and the line table of
+// their source in the binary format. Returns false if the file could not be written.
+bool writeBinaryTokens(const std::string& filename, const std::vector<Token>& tokens,
+                       const LineTable& lines);
+
+// Zero-copy view over a binary token stream held in memory (typically a MappedFile).
+// The buffer must outlive the reader and every Token taken from it, since
+// their lexemes point into the buffer's string pool.
+class BinaryTokenReader {
+public:
+    // Validates the header, section sizes, token types and lexeme ranges;
+    // throws std::runtime_error if malformed.
+    BinaryTokenReader(const char* data, size_t size);
+
+    size_t size() const { return count_; }
+    Token operator[](size_t index) const;
+    LineTable lineTable() const;
+
+private:
+    const PackedToken* records_ = nullptr;
+    const uint32_t* lineStarts_ = nullptr;
+    size_t lineCount_ = 0;
+    const char* pool_ = nullptr;
+    size_t count_ = 0;
+};
+
+// --- Text token stream ---
+// Written by `lexer_executable --text`, one token per line:
+//
+//   TYPE [lexeme] line column
+//
+// Reads such a buffer (typically a MappedFile) in one pass. Lexemes point into
+// the buffer, except STRING lexemes with escapes, which are unescaped into
+// `text`; both must outlive the tokens. Malformed lines are skipped with a
+// warning; an unknown type name throws std::runtime_error.
+// The format has line/column instead of source offsets, so `lines` gets a
+// stand-in table: each line is laid out just wide enough for the columns seen
+// on it, and the offsets given to the tokens map back to the same line/column.
+std::vector<Token> readTextTokens(const char* data, size_t size, Arena& text, LineTable& lines);
+
+#endif // TOKEN_IO_H
@@ -0,0 +1,98 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "token.h"
+
+// --- Pull-based token input ---
+// A TokenSource hands out tokens one at a time, so a consumer can run while
+// they are being produced instead of after a whole vector has been built.
+// The Lexer is one: it lexes each token when it is asked for it.
+
+class TokenSource {
+public:
+    virtual ~TokenSource() = default;
+    // The next token. Once EOF_TOKEN has been returned, every later call
+    // returns EOF_TOKEN again.
+    virtual Token nextToken() = 0;
+};
+
+// Cursor over a TokenSource with a small window of buffered tokens: the
+// current token, at least MAX_LOOKAHEAD tokens after it and HISTORY tokens
+// before it. Tokens are pulled from the source a window at a time, so memory
+// stays O(WINDOW_SIZE) however long the input is. Tokens that are already in
+// a vector (e.g. read back from a .tokens file) are walked in place until the
+// last few, which are copied into the window and padded with EOF_TOKEN.
+// Either way peek() is a plain array access.
+// References returned by peek() and previous() are only good until the
+// cursor moves; copy a Token to keep it.
+class TokenStream {
+public:
+    static constexpr size_t MAX_LOOKAHEAD = 4;
+
+    explicit TokenStream(TokenSource& source) : source_(&source) {
+        refill();
+    }
+    // The vector must end with EOF_TOKEN and outlive the stream. Peeking past
+    // the end keeps returning that EOF_TOKEN, as a TokenSource would.
+    explicit TokenStream(const std::vector<Token>& tokens)
+        : begin_(tokens.data()), cursor_(tokens.data()), end_(tokens.data() + tokens.size()),
+          eof_(tokens.empty() ? Token(TokenType::EOF_TOKEN, 0, {}) : tokens.back()) {
+        if (cursor_ + MAX_LOOKAHEAD >= end_) refill();
+    }
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+
+    // The token `ahead` positions after the current one, for ahead <= MAX_LOOKAHEAD
+    const Token& peek(size_t ahead = 0) const { return cursor_[ahead]; }
+
+    // The token before the current one; requires position() > 0.
+    const Token& previous() const { return cursor_[-1]; }
+
+    void advance() {
+        ++position_;
+        if (++cursor_ + MAX_LOOKAHEAD >= end_) refill();
+    }
+
+    // Steps back onto previous(); only HISTORY steps are guaranteed to be available.
+    void retreat() {
+        --position_;
+        --cursor_;
+    }
+
+    // Number of tokens advanced past so far
+    size_t position() const { return position_; }
+
+private:
+    static constexpr size_t HISTORY = 2;
+    static constexpr size_t WINDOW_SIZE = 64;
+    static_assert(WINDOW_SIZE > HISTORY + MAX_LOOKAHEAD, "Window must hold history plus lookahead");
+
+    // Moves the history and the unread tail to the front of window_ and fills
+    // the rest from source_ (or with eof_ once a vector has run out).
+    void refill() {
+        size_t keep = std::min(static_cast<size_t>(cursor_ - begin_), HISTORY);
+        size_t count = static_cast<size_t>(end_ - cursor_) + keep;
+        if (count != 0) std::memmove(window_, cursor_ - keep, count * sizeof(Token));
+        for (size_t i = count; i < WINDOW_SIZE; ++i) {
+            window_[i] = source_ ? source_->nextToken() : eof_;
+        }
+        begin_ = window_;
+        cursor_ = window_ + keep;
+        end_ = window_ + WINDOW_SIZE;
+    }
+
+    TokenSource* source_ = nullptr; // Null when walking a vector
+    const Token* begin_ = nullptr;  // Oldest token still available, in window_ or the vector
+    const Token* cursor_ = nullptr; // Current token
+    const Token* end_ = nullptr;    // One past the last buffered token
+    Token eof_;                     // Padding once a vector has run out
+    size_t position_ = 0;           // Index of the current token in the whole stream
+    Token window_[WINDOW_SIZE];
+};
+
+#endif // TOKEN_STREAM_H
@@ -1,5 +1,5 @@
 #include "utils.h"
-#include <unordered_map>
+#include <array>
 #include <stdexcept>
 
 // Helper function definitions
@@ -65,46 +65,100 @@ std::string tokenTypeToString(TokenType type) {
     }
 }
 
-TokenType stringToTokenType(const std::string& str) {
-    // ... (Keep the existing map-based implementation) ...
-    // Use static to initialize the map only once
-    static const std::unordered_map<std::string, TokenType> map = {
-        {"GARDEN", TokenType::GARDEN}, {"SPECIES", TokenType::SPECIES},
-        {"OPEN", TokenType::OPEN}, {"HIDDEN", TokenType::HIDDEN},
-        {"GUARDED", TokenType::GUARDED}, {"GROW", TokenType::GROW},
-        {"BLOSSOM", TokenType::BLOSSOM}, {"STYLE", TokenType::STYLE},
-        {"BLOOM", TokenType::BLOOM}, {"WATER", TokenType::WATER},
-        {"BRANCH", TokenType::BRANCH}, {"ELSE", TokenType::ELSE},
-        {"WHILE", TokenType::WHILE}, {"FOR", TokenType::FOR},
-        {"IDENTIFIER", TokenType::IDENTIFIER}, {"NUMBER", TokenType::NUMBER},
-        {"STRING", TokenType::STRING}, {"TRUE", TokenType::TRUE},
-        {"FALSE", TokenType::FALSE}, {"PLUS", TokenType::PLUS},
-        {"MINUS", TokenType::MINUS}, {"STAR", TokenType::STAR},
-        {"SLASH", TokenType::SLASH}, {"ASSIGN", TokenType::ASSIGN},
-        {"EQUAL", TokenType::EQUAL}, {"NOT_EQUAL", TokenType::NOT_EQUAL},
-        {"LESS", TokenType::LESS}, {"LESS_EQUAL", TokenType::LESS_EQUAL},
-        {"GREATER", TokenType::GREATER}, {"GREATER_EQUAL", TokenType::GREATER_EQUAL},
-        {"AND", TokenType::AND}, {"OR", TokenType::OR}, {"NOT", TokenType::NOT},
-        {"MODULO", TokenType::MODULO},
-        {"STREAM_OUT", TokenType::STREAM_OUT}, {"STREAM_IN", TokenType::STREAM_IN},
-        {"ARROW", TokenType::ARROW},
-        {"LEFT_PAREN", TokenType::LEFT_PAREN}, {"RIGHT_PAREN", TokenType::RIGHT_PAREN},
-        {"LEFT_BRACE", TokenType::LEFT_BRACE}, {"RIGHT_BRACE", TokenType::RIGHT_BRACE},
-        {"LEFT_BRACKET", TokenType::LEFT_BRACKET}, {"RIGHT_BRACKET", TokenType::RIGHT_BRACKET},
-        {"COMMA", TokenType::COMMA}, {"SEMICOLON", TokenType::SEMICOLON},
-        {"DOT", TokenType::DOT}, {"COLON", TokenType::COLON},
-        {"COMMENT", TokenType::COMMENT}, {"EOF_TOKEN", TokenType::EOF_TOKEN},
-        {"ERROR", TokenType::ERROR},
-        {"STYLE_INCLUDE", TokenType::STYLE_INCLUDE}, {"SCOPE_RESOLUTION", TokenType::SCOPE_RESOLUTION},
-        {"UNKNOWN", TokenType::ERROR}, // Map UNKNOWN to ERROR for compatibility
-        {"FLOAT_LITERAL", TokenType::FLOAT_LITERAL}, // Make sure these are included
-        {"DOUBLE_LITERAL", TokenType::DOUBLE_LITERAL}
-    };
+namespace {
+
+// --- Token type names ---
+// Perfect hash over the names tokenTypeToString produces (plus "UNKNOWN"),
+// built at compile time the same way as the lexer's keyword table: length,
+// first, last and middle character pick one slot, one compare confirms it.
+
+struct TokenTypeName {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr TokenTypeName TOKEN_TYPE_NAMES[] = {
+    {"GARDEN", TokenType::GARDEN}, {"SPECIES", TokenType::SPECIES},
+    {"OPEN", TokenType::OPEN}, {"HIDDEN", TokenType::HIDDEN},
+    {"GUARDED", TokenType::GUARDED}, {"GROW", TokenType::GROW},
+    {"BLOSSOM", TokenType::BLOSSOM}, {"STYLE", TokenType::STYLE},
+    {"BLOOM", TokenType::BLOOM}, {"WATER", TokenType::WATER},
+    {"BRANCH", TokenType::BRANCH}, {"ELSE", TokenType::ELSE},
+    {"WHILE", TokenType::WHILE}, {"FOR", TokenType::FOR},
+    {"IDENTIFIER", TokenType::IDENTIFIER}, {"NUMBER", TokenType::NUMBER},
+    {"STRING", TokenType::STRING}, {"TRUE", TokenType::TRUE},
+    {"FALSE", TokenType::FALSE}, {"PLUS", TokenType::PLUS},
+    {"MINUS", TokenType::MINUS}, {"STAR", TokenType::STAR},
+    {"SLASH", TokenType::SLASH}, {"ASSIGN", TokenType::ASSIGN},
+    {"EQUAL", TokenType::EQUAL}, {"NOT_EQUAL", TokenType::NOT_EQUAL},
+    {"LESS", TokenType::LESS}, {"LESS_EQUAL", TokenType::LESS_EQUAL},
+    {"GREATER", TokenType::GREATER}, {"GREATER_EQUAL", TokenType::GREATER_EQUAL},
+    {"AND", TokenType::AND}, {"OR", TokenType::OR}, {"NOT", TokenType::NOT},
+    {"MODULO", TokenType::MODULO},
+    {"STREAM_OUT", TokenType::STREAM_OUT}, {"STREAM_IN", TokenType::STREAM_IN},
+    {"ARROW", TokenType::ARROW},
+    {"LEFT_PAREN", TokenType::LEFT_PAREN}, {"RIGHT_PAREN", TokenType::RIGHT_PAREN},
+    {"LEFT_BRACE", TokenType::LEFT_BRACE}, {"RIGHT_BRACE", TokenType::RIGHT_BRACE},
+    {"LEFT_BRACKET", TokenType::LEFT_BRACKET}, {"RIGHT_BRACKET", TokenType::RIGHT_BRACKET},
+    {"COMMA", TokenType::COMMA}, {"SEMICOLON", TokenType::SEMICOLON},
+    {"DOT", TokenType::DOT}, {"COLON", TokenType::COLON},
+    {"COMMENT", TokenType::COMMENT}, {"EOF_TOKEN", TokenType::EOF_TOKEN},
+    {"ERROR", TokenType::ERROR},
+    {"STYLE_INCLUDE", TokenType::STYLE_INCLUDE}, {"SCOPE_RESOLUTION", TokenType::SCOPE_RESOLUTION},
+    {"UNKNOWN", TokenType::ERROR}, // Map UNKNOWN to ERROR for compatibility
+    {"FLOAT_LITERAL", TokenType::FLOAT_LITERAL},
+    {"DOUBLE_LITERAL", TokenType::DOUBLE_LITERAL}
+};
+
+// Shortest and longest name above; anything outside is rejected before hashing
+constexpr size_t MIN_TOKEN_TYPE_NAME = 2;
+constexpr size_t MAX_TOKEN_TYPE_NAME = 16;
+constexpr size_t TOKEN_TYPE_NAME_TABLE_SIZE = 256;
+
+constexpr size_t tokenTypeNameHash(std::string_view name) {
+    return (name.size()
+            + static_cast<unsigned char>(name.front())
+            + static_cast<unsigned char>(name.back()) * 3
+            + static_cast<unsigned char>(name[name.size() / 2]) * 30) % TOKEN_TYPE_NAME_TABLE_SIZE;
+}
+
+constexpr std::array<TokenTypeName, TOKEN_TYPE_NAME_TABLE_SIZE> buildTokenTypeNameTable() {
+    std::array<TokenTypeName, TOKEN_TYPE_NAME_TABLE_SIZE> table{};
+    for (auto& slot : table) {
+        slot = {std::string_view(), TokenType::ERROR};
+    }
+    for (const auto& entry : TOKEN_TYPE_NAMES) {
+        table[tokenTypeNameHash(entry.text)] = entry;
+    }
+    return table;
+}
+
+constexpr std::array<TokenTypeName, TOKEN_TYPE_NAME_TABLE_SIZE> TOKEN_TYPE_NAME_TABLE = buildTokenTypeNameTable();
+
+constexpr bool tokenTypeNameTableIsPerfect() {
+    for (const auto& entry : TOKEN_TYPE_NAMES) {
+        if (TOKEN_TYPE_NAME_TABLE[tokenTypeNameHash(entry.text)].text != entry.text) return false;
+        if (entry.text.size() < MIN_TOKEN_TYPE_NAME || entry.text.size() > MAX_TOKEN_TYPE_NAME) return false;
+    }
+    return true;
+}
+static_assert(tokenTypeNameTableIsPerfect(), "Token type name hash collision: adjust tokenTypeNameHash");
 
-    auto it = map.find(str);
-    if (it != map.end()) {
-        return it->second;
-    } 
+} // namespace
+
+bool tokenTypeFromName(std::string_view name, TokenType& type) {
+    if (name.size() < MIN_TOKEN_TYPE_NAME || name.size() > MAX_TOKEN_TYPE_NAME) return false;
+    const TokenTypeName& entry = TOKEN_TYPE_NAME_TABLE[tokenTypeNameHash(name)];
+    if (entry.text != name) return false;
+    type = entry.type;
+    return true;
+}
+
+TokenType stringToTokenType(const std::string& str) {
+    TokenType type;
+    if (tokenTypeFromName(str, type)) {
+        return type;
+    }
     
     // Handle numeric token types by their integer value (for token files that use numbers)
     try {
@@ -2,10 +2,15 @@
 #define UTILS_H
 
 #include <string>
+#include <string_view>
 #include "token.h" // Needs TokenType
 
 // Helper function declarations
 std::string tokenTypeToString(TokenType type);
 TokenType stringToTokenType(const std::string& str);
 
+// Looks up a name written by tokenTypeToString ("UNKNOWN" reads as ERROR)
+// without allocating. Returns false, leaving type alone, if it is not one.
+bool tokenTypeFromName(std::string_view name, TokenType& type);
+
 #endif // UTILS_H 
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <charconv>
+
+#include "../common/token.h"
+#include "../common/ast.h"
+#include "../common/log.h"
+#include "../common/mapped_file.h"
+#include "../common/spsc_queue.h"
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+#include "../semantic_analyzer/semantic_analyzer.h"
+#include "../codegen/codegen.h"
+
+// hanamic: runs lexer -> parser -> semantic analyzer -> codegen in a single
+// process. Tokens and the AST are handed from stage to stage in memory, so
+// there are no intermediate .tokens/.ast/.ir files and no JSON round trips.
+
+static void reportLexError(const Token& token, const LineTable& lines) {
+    SourcePosition pos = lines.position(token.offset);
+    LOG_ERROR("Lexing error encountered: " << token.lexeme
+              << " at line " << pos.line << ", column " << pos.column);
+}
+
+// Thrown out of the parser when the token stream hit a lexing error
+struct LexingFailed {};
+
+// Feeds the parser straight from the lexer. Lexing errors are reported as
+// after a full scan: at the first ERROR token the rest of the source is lexed
+// (without keeping the tokens) to report every error, then parsing stops.
+class CheckedLexerSource : public TokenSource {
+public:
+    explicit CheckedLexerSource(Lexer& lexer) : lexer_(lexer) {}
+
+    Token nextToken() override {
+        Token token = lexer_.nextToken();
+        if (token.type == TokenType::ERROR) {
+            reportLexError(token, lexer_.lineTable());
+            reportRemainingErrors();
+            throw LexingFailed();
+        }
+        return token;
+    }
+
+    // Lexes whatever the parser has not pulled yet, only to report its
+    // lexing errors. Returns how many there were.
+    size_t reportRemainingErrors() {
+        size_t errors = 0;
+        for (Token token = lexer_.nextToken(); token.type != TokenType::EOF_TOKEN; token = lexer_.nextToken()) {
+            if (token.type == TokenType::ERROR) {
+                reportLexError(token, lexer_.lineTable());
+                ++errors;
+            }
+        }
+        return errors;
+    }
+
+private:
+    Lexer& lexer_;
+};
+
+// The generators selected by --target. They are fed one top-level
+// declaration at a time, so the pipelined compile can generate code while
+// the rest of the program is still being parsed.
+struct TargetGenerators {
+    explicit TargetGenerators(const std::string& target)
+        : java(target == "all" || target == "java"), python(target == "all" || target == "python"),
+          cpp(target == "all" || target == "cpp"), js(target == "all" || target == "js") {}
+
+    void begin() {
+        if (java) javaGen.begin();
+        if (python) pythonGen.begin();
+        if (cpp) cppGen.begin();
+        if (js) jsGen.begin();
+    }
+
+    void addDeclaration(Statement* declaration) {
+        if (java) javaGen.addDeclaration(declaration);
+        if (python) pythonGen.addDeclaration(declaration);
+        if (cpp) cppGen.addDeclaration(declaration);
+        if (js) jsGen.addDeclaration(declaration);
+    }
+
+    // Finishes every selected target and writes it to outputDir
+    bool write(const std::string& outputDir) {
+        std::error_code dirError;
+        std::filesystem::create_directories(outputDir, dirError); // writeToFile reports any real failure
+        bool success = true;
+        if (java) {
+            std::string javaCode = javaGen.finish();
+            success &= writeToFile(outputDir + javaGen.getClassName() + ".java", javaCode);
+        }
+        if (python) success &= writeToFile(outputDir + "output.py", pythonGen.finish());
+        if (cpp) success &= writeToFile(outputDir + "output.cpp", cppGen.finish());
+        if (js) success &= writeToFile(outputDir + "output.js", jsGen.finish());
+        return success;
+    }
+
+    bool java, python, cpp, js;
+    JavaCodeGenerator javaGen;
+    PythonCodeGenerator pythonGen;
+    CppCodeGenerator cppGen;
+    JavaScriptCodeGenerator jsGen;
+};
+
+// --- Pipelined compile (--threads=N with N > 1) ---
+// Lexing, parsing and semantic analysis each get a thread and code generation
+// runs on the calling one. The stages are joined by bounded lock-free SPSC
+// queues: the lexer hands on batches of tokens, the parser each top-level
+// declaration as soon as it is complete, and the analyzer each declaration it
+// has checked. A declaration is only read after it has been handed on and is
+// never written again, so the stages share no mutable state (the interner,
+// which they all use, is thread-safe).
+
+constexpr size_t TOKEN_BATCH_SIZE = 1024;
+using TokenBatch = std::vector<Token>;
+using TokenQueue = SpscQueue<TokenBatch, 16>;
+using DeclarationQueue = SpscQueue<Statement*, 256>;
+
+// The parser's end of the token queue
+class QueuedTokenSource : public TokenSource {
+public:
+    QueuedTokenSource(TokenQueue& queue, const std::atomic<bool>& lexFailed)
+        : queue_(queue), lexFailed_(lexFailed) {}
+
+    Token nextToken() override {
+        while (next_ == batch_.size()) {
+            if (!queue_.pop(batch_)) {
+                // The lexer stops handing on tokens at its first error
+                if (lexFailed_.load(std::memory_order_relaxed)) throw LexingFailed();
+                return eof_;
+            }
+            next_ = 0;
+        }
+        const Token& token = batch_[next_++];
+        if (token.type == TokenType::EOF_TOKEN) eof_ = token;
+        return token;
+    }
+
+private:
+    TokenQueue& queue_;
+    const std::atomic<bool>& lexFailed_;
+    TokenBatch batch_;
+    size_t next_ = 0;
+    Token eof_{TokenType::EOF_TOKEN, 0, ""};
+};
+
+// Lexes the whole source. Tokens are handed on up to the first lexing error,
+// so the parser sees the same tokens as from CheckedLexerSource and reports
+// the same syntax errors before it; every error is collected in errors for
+// the caller to report.
+static void lexStage(Lexer& lexer, TokenQueue& out, std::vector<Token>& errors, std::atomic<bool>& failed) {
+    TokenBatch batch;
+    batch.reserve(TOKEN_BATCH_SIZE);
+    bool forwarding = true;
+    for (;;) {
+        Token token = lexer.nextToken();
+        if (token.type == TokenType::ERROR) {
+            errors.push_back(token);
+            if (forwarding && !batch.empty()) {
+                out.push(std::move(batch)); // The tokens before the error
+            }
+            forwarding = false;
+        } else if (forwarding) {
+            batch.push_back(token);
+            if (batch.size() == TOKEN_BATCH_SIZE || token.type == TokenType::EOF_TOKEN) {
+                forwarding = out.push(std::move(batch)); // false: the parser has stopped
+                batch = TokenBatch();
+                batch.reserve(TOKEN_BATCH_SIZE);
+            }
+        }
+        if (token.type == TokenType::EOF_TOKEN) break;
+    }
+    if (!errors.empty()) failed.store(true, std::memory_order_relaxed); // Published by close()
+    out.close();
+}
+
+// Runs every stage at once over program (allocated in astArena) and leaves
+// the generators holding the generated code. Reports errors the same way as
+// the stage-after-stage compile and returns false on any of them.
+static bool compilePipelined(Lexer& lexer, Arena& astArena, ProgramNode& program,
+                             SemanticAnalyzerVisitor& analyzer, TargetGenerators& generators) {
+    TokenQueue tokens;
+    DeclarationQueue parsed;
+    DeclarationQueue checked;
+
+    std::vector<Token> lexErrors;
+    std::atomic<bool> lexFailed{false};
+    std::thread lexerThread(lexStage, std::ref(lexer), std::ref(tokens), std::ref(lexErrors), std::ref(lexFailed));
+
+    bool parseFailed = false;
+    std::string parseException;
+    std::thread parserThread([&] {
+        QueuedTokenSource source(tokens, lexFailed);
+        try {
+            Parser parser(source, lexer.lineTable(), astArena);
+            while (Statement* declaration = parser.parseNext(program)) {
+                if (!parsed.push(declaration)) break;
+            }
+        } catch (const LexingFailed&) {
+            // Reported from lexErrors below
+        } catch (const ParseError&) {
+            parseFailed = true; // Parser::error already printed details
+        } catch (const std::exception& e) {
+            parseException = e.what();
+        }
+        parsed.close();
+        tokens.close(); // The lexer goes on only to collect errors
+    });
+
+    std::thread analyzerThread([&] {
+        analyzer.beginProgram();
+        bool forwarding = true;
+        Statement* declaration = nullptr;
+        while (parsed.pop(declaration)) {
+            analyzer.analyzeDeclaration(declaration);
+            // Nothing is written once there are errors; keep checking to report them all
+            if (forwarding && analyzer.hasErrors()) forwarding = false;
+            if (forwarding) checked.push(declaration);
+        }
+        analyzer.endProgram();
+        checked.close();
+    });
+
+    generators.begin();
+    Statement* declaration = nullptr;
+    while (checked.pop(declaration)) {
+        generators.addDeclaration(declaration);
+    }
+
+    lexerThread.join();
+    parserThread.join();
+    analyzerThread.join();
+
+    if (!parseException.empty()) {
+        LOG_ERROR("An unexpected error occurred during parsing: " << parseException);
+        return false;
+    }
+    for (const Token& token : lexErrors) {
+        reportLexError(token, lexer.lineTable());
+    }
+    if (!lexErrors.empty()) {
+        LOG_ERROR("Lexing failed due to errors.");
+    }
+    if (parseFailed) {
+        LOG_ERROR("Parsing failed due to syntax errors.");
+    }
+    if (!lexErrors.empty() || parseFailed) {
+        return false;
+    }
+    LOG_DEBUG("AST arena: " << astArena.bytesUsed() << " bytes used in " << astArena.blockCount() << " block(s)");
+
+    if (analyzer.hasErrors()) {
+        std::cout << "Semantic analysis finished with errors:" << std::endl;
+        analyzer.printErrors();
+        return false;
+    }
+    return true;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <input.hanami|-> [output_dir] [--target=all|cpp|java|python|js] [--threads=N] [--log=level]" << std::endl;
+}
+
+// Reads the N of --threads=N; false unless text is a whole non-negative number
+static bool parseThreadCount(std::string_view text, unsigned& count) {
+    const char* last = text.data() + text.size();
+    auto result = std::from_chars(text.data(), last, count);
+    return !text.empty() && result.ec == std::errc() && result.ptr == last;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFilename = "input/test.hanami"; // Default input source file
+    std::string outputDir = "output/";               // Default output directory
+    std::string target = "all";
+    unsigned threadCount = 0; // 1 runs the stages one after another, more runs them as a pipeline (0 = one per core)
+
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--target=", 0) == 0) {
+            target = arg.substr(9);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            if (!parseThreadCount(std::string_view(arg).substr(10), threadCount)) {
+                std::cerr << "Error: Invalid thread count in " << arg << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (applyLogFlag(arg)) {
+            // --log=<level> handled
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() > 0) inputFilename = positional[0];
+    if (positional.size() > 1) outputDir = positional[1];
+    if (!outputDir.empty() && outputDir.back() != '/' && outputDir.back() != '\\') {
+        outputDir += '/';
+    }
+
+    if (target != "all" && target != "cpp" && target != "java" && target != "python" && target != "js") {
+        LOG_ERROR("Error: Unknown target '" << target << "'.");
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::cout << "Hanami Compiler" << std::endl;
+    std::cout << "Reading source from: " << inputFilename << std::endl;
+
+    // Mapped rather than copied; tokens view it until codegen is done
+    MappedFile sourceFile;
+    try {
+        sourceFile = MappedFile(inputFilename);
+    } catch (const std::exception&) {
+        LOG_ERROR("Error: Could not open input file: " << inputFilename);
+        return 1;
+    }
+    std::string_view sourceCode = sourceFile.view();
+
+    //start_time
+    auto start_time = std::chrono::steady_clock::now();
+
+    Lexer lexer(sourceCode);
+    Arena astArena; // Owns the whole AST; released at once when main returns
+    SemanticAnalyzerVisitor analyzer;
+    TargetGenerators generators(target);
+
+    unsigned threads = threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    if (threads > 1) {
+        // --- Steps 1 to 4 at once, as a pipeline ---
+        NodePtr<ProgramNode> programRoot;
+        {
+            ArenaScope scope(astArena);
+            programRoot = makeNode<ProgramNode>();
+        }
+        if (!compilePipelined(lexer, astArena, *programRoot, analyzer, generators)) {
+            return 1;
+        }
+    } else {
+        // --- Steps 1 and 2: Lexical Analysis and Parsing ---
+        // The lexer feeds the parser token by token, so no token vector is built.
+        NodePtr<ProgramNode> programRoot = nullptr;
+        CheckedLexerSource lexerSource(lexer);
+        try {
+            Parser parser(lexerSource, lexer.lineTable(), astArena);
+            programRoot = parser.parse();
+        } catch (const LexingFailed&) {
+            LOG_ERROR("Lexing failed due to errors.");
+            return 1;
+        } catch (const ParseError& e) {
+            // Parser::error already printed details. The source may still
+            // hold lexing errors past the syntax error; report those too.
+            if (lexerSource.reportRemainingErrors() > 0) {
+                LOG_ERROR("Lexing failed due to errors.");
+            }
+            LOG_ERROR("Parsing failed due to syntax errors.");
+            return 1;
+        } catch (const std::exception& e) {
+            LOG_ERROR("An unexpected error occurred during parsing: " << e.what());
+            return 1;
+        }
+        if (!programRoot) {
+            LOG_ERROR("Error: Parsing resulted in a null AST root.");
+            return 1;
+        }
+        LOG_DEBUG("AST arena: " << astArena.bytesUsed() << " bytes used in " << astArena.blockCount() << " block(s)");
+
+        // --- Step 3: Semantic Analysis ---
+        analyzer.analyze(programRoot.get());
+        if (analyzer.hasErrors()) {
+            std::cout << "Semantic analysis finished with errors:" << std::endl;
+            analyzer.printErrors();
+            return 1;
+        }
+
+        // --- Step 4: Code Generation ---
+        generators.begin();
+        for (const auto& declaration : programRoot->statements) {
+            generators.addDeclaration(declaration.get());
+        }
+    }
+
+    if (!generators.write(outputDir)) {
+        LOG_ERROR("Code generation failed for one or more languages.");
+        return 1;
+    }
+
+    //end_time
+    auto end_time = std::chrono::steady_clock::now();
+    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+
+    std::cout << "Compilation completed successfully." << std::endl;
+    std::cout << "Time execution: " << duration_ms.count() << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "../common/token.h"
+
+// --- Character classes ---
+// One table lookup tells the lexer what a byte can start, so scanToken
+// dispatches with a single switch instead of a chain of isdigit/isalpha and
+// character comparisons. Bytes >= 0x80 and control characters are Other.
+
+enum class CharClass : uint8_t {
+    Other,       // Not valid here: reported as "Unexpected character"
+    Space,       // ' ', '\t', '\r'
+    Newline,     // '\n'
+    Digit,       // 0-9
+    IdentStart,  // A-Z, a-z, _
+    Quote,       // "
+    Slash,       // / (division or comment)
+    Less,        // < << <=
+    Greater,     // > >> >=
+    Equal,       // = ==
+    Bang,        // ! !=
+    Minus,       // - ->
+    Colon,       // : ::
+    Punct,       // Always a one-character token: + * % . , ; ( ) { } [ ]
+};
+
+constexpr std::array<CharClass, 256> buildCharClassTable() {
+    std::array<CharClass, 256> table{};
+    for (auto& entry : table) entry = CharClass::Other;
+    table[' '] = table['\t'] = table['\r'] = CharClass::Space;
+    table['\n'] = CharClass::Newline;
+    for (int c = '0'; c <= '9'; ++c) table[c] = CharClass::Digit;
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = CharClass::IdentStart;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = CharClass::IdentStart;
+    table['_'] = CharClass::IdentStart;
+    table['"'] = CharClass::Quote;
+    table['/'] = CharClass::Slash;
+    table['<'] = CharClass::Less;
+    table['>'] = CharClass::Greater;
+    table['='] = CharClass::Equal;
+    table['!'] = CharClass::Bang;
+    table['-'] = CharClass::Minus;
+    table[':'] = CharClass::Colon;
+    for (unsigned char c : {'+', '*', '%', '.', ',', ';', '(', ')', '{', '}', '[', ']'}) {
+        table[c] = CharClass::Punct;
+    }
+    return table;
+}
+
+inline constexpr std::array<CharClass, 256> CHAR_CLASS = buildCharClassTable();
+
+// Token type of each CharClass::Punct character.
+constexpr std::array<TokenType, 256> buildPunctTypeTable() {
+    std::array<TokenType, 256> table{};
+    for (auto& entry : table) entry = TokenType::ERROR;
+    table['+'] = TokenType::PLUS;
+    table['*'] = TokenType::STAR;
+    table['%'] = TokenType::MODULO;
+    table['.'] = TokenType::DOT;
+    table[','] = TokenType::COMMA;
+    table[';'] = TokenType::SEMICOLON;
+    table['('] = TokenType::LEFT_PAREN;
+    table[')'] = TokenType::RIGHT_PAREN;
+    table['{'] = TokenType::LEFT_BRACE;
+    table['}'] = TokenType::RIGHT_BRACE;
+    table['['] = TokenType::LEFT_BRACKET;
+    table[']'] = TokenType::RIGHT_BRACKET;
+    return table;
+}
+
+inline constexpr std::array<TokenType, 256> PUNCT_TYPE = buildPunctTypeTable();
+
+inline CharClass charClass(char c) {
+    return CHAR_CLASS[static_cast<unsigned char>(c)];
+}
+
+// Letters, digits and '_': the characters that continue an identifier.
+inline bool isIdentChar(char c) {
+    CharClass cls = charClass(c);
+    return cls == CharClass::IdentStart || cls == CharClass::Digit;
+}
+
+// Letters and digits only; the 'style' keyword check stops at anything else.
+inline bool isAlnumChar(char c) {
+    return isIdentChar(c) && c != '_';
+}
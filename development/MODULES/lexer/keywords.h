@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "../common/token.h"
+
+// --- Keyword recognition ---
+// Perfect hash over the Hanami keywords, built entirely at compile time.
+// A word is hashed from its length and its first and last characters, which
+// picks at most one candidate slot; one string compare then confirms it.
+// There is nothing to construct at runtime and nothing shared between lexers.
+
+struct KeywordEntry {
+    std::string_view text;
+    TokenType type;
+};
+
+inline constexpr KeywordEntry KEYWORD_LIST[] = {
+    // Hanami keywords
+    {"garden", TokenType::GARDEN},
+    {"species", TokenType::SPECIES},
+    {"open", TokenType::OPEN},
+    {"hidden", TokenType::HIDDEN},
+    {"guarded", TokenType::GUARDED},
+    {"grow", TokenType::GROW},
+    {"blossom", TokenType::BLOSSOM},
+    {"style", TokenType::STYLE},
+    {"bloom", TokenType::BLOOM},
+    {"water", TokenType::WATER},
+    {"branch", TokenType::BRANCH},
+    // Original keywords
+    {"else", TokenType::ELSE},
+    {"while", TokenType::WHILE},
+    {"for", TokenType::FOR},
+    {"true", TokenType::TRUE},
+    {"false", TokenType::FALSE},
+};
+
+// Table size and multipliers were chosen so that every keyword above lands in
+// its own slot; the static_assert below fails if a new keyword collides.
+inline constexpr size_t KEYWORD_TABLE_SIZE = 32;
+
+constexpr size_t keywordHash(std::string_view word) {
+    return (word.size() * 3
+            + static_cast<unsigned char>(word.front()) * 30
+            + static_cast<unsigned char>(word.back())) % KEYWORD_TABLE_SIZE;
+}
+
+constexpr std::array<KeywordEntry, KEYWORD_TABLE_SIZE> buildKeywordTable() {
+    std::array<KeywordEntry, KEYWORD_TABLE_SIZE> table{};
+    for (auto& slot : table) {
+        slot = {std::string_view(), TokenType::IDENTIFIER};
+    }
+    for (const auto& entry : KEYWORD_LIST) {
+        table[keywordHash(entry.text)] = entry;
+    }
+    return table;
+}
+
+inline constexpr std::array<KeywordEntry, KEYWORD_TABLE_SIZE> KEYWORD_TABLE = buildKeywordTable();
+
+constexpr bool keywordTableIsPerfect() {
+    for (const auto& entry : KEYWORD_LIST) {
+        if (KEYWORD_TABLE[keywordHash(entry.text)].text != entry.text) return false;
+    }
+    return true;
+}
+static_assert(keywordTableIsPerfect(), "Keyword hash collision: adjust keywordHash or KEYWORD_TABLE_SIZE");
+
+// Returns the keyword's token type, or TokenType::IDENTIFIER if word is not a keyword.
+constexpr TokenType lookupKeyword(std::string_view word) {
+    if (word.size() < 3 || word.size() > 7) return TokenType::IDENTIFIER; // Shortest/longest keyword
+    const KeywordEntry& entry = KEYWORD_TABLE[keywordHash(word)];
+    return entry.text == word ? entry.type : TokenType::IDENTIFIER;
+}
+
+static_assert(lookupKeyword("blossom") == TokenType::BLOSSOM, "lookupKeyword is broken");
+static_assert(lookupKeyword("blossoms") == TokenType::IDENTIFIER, "lookupKeyword is broken");
@@ -1,67 +1,23 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
 #include "../common/token.h"
 #include "../common/utils.h"
+#include "../common/log.h"
 #include "lexer.h"
+#include "keywords.h"
+#include "char_class.h"
+#include "simd_scan.h"
 
 // Add the constructor definition
-Lexer::Lexer(const std::string& source) : source(source), current(0), line(1), column(1) {
-    // Initialize keyword map
-    initKeywords();
+Lexer::Lexer(std::string_view source) : source(source), current(0), ownLines_(source), lines_(ownLines_), scan_(scanKernels()) {
 }
 
-void Lexer::initKeywords(){
-    // Các từ khóa Hanami
-    keywords["garden"] = TokenType::GARDEN;
-    keywords["species"] = TokenType::SPECIES;
-    keywords["open"] = TokenType::OPEN;
-    keywords["hidden"] = TokenType::HIDDEN;
-    keywords["guarded"] = TokenType::GUARDED;
-    keywords["grow"] = TokenType::GROW;
-    keywords["blossom"] = TokenType::BLOSSOM;
-    keywords["style"] = TokenType::STYLE;
-    keywords["bloom"] = TokenType::BLOOM;
-    keywords["water"] = TokenType::WATER;
-    keywords["branch"] = TokenType::BRANCH;
-    
-    // Các từ khóa gốc
-    keywords["else"] = TokenType::ELSE;
-    keywords["while"] = TokenType::WHILE;
-    keywords["for"] = TokenType::FOR;
-    keywords["true"] = TokenType::TRUE;
-    keywords["false"] = TokenType::FALSE;
-
-    //Math operator
-    keywords["+"] = TokenType::PLUS;
-    keywords["-"] = TokenType::MINUS;
-    keywords["*"] = TokenType::STAR;
-    keywords["/"] = TokenType::SLASH;
-    keywords["%"] = TokenType::MODULO;
-
-    //Assign 
-    keywords["="] = TokenType::ASSIGN;
-
-    //Compare
-    keywords["!="] = TokenType::NOT_EQUAL;
-    keywords["<="] = TokenType::LESS_EQUAL;
-    keywords[">="] = TokenType::GREATER_EQUAL;
-
-    // Thêm vào hàm initKeywords
-    keywords["::"] = TokenType::SCOPE_RESOLUTION;
-    keywords["<<"] = TokenType::STREAM_OUT;
-    keywords[">>"] = TokenType::STREAM_IN;
-    keywords["->"] = TokenType::ARROW;
-    keywords[":"] = TokenType::COLON;
-
-    // Thêm các dấu câu khác
-    keywords["("] = TokenType::LEFT_PAREN;
-    keywords[")"] = TokenType::RIGHT_PAREN;
-    keywords["{"] = TokenType::LEFT_BRACE;
-    keywords["}"] = TokenType::RIGHT_BRACE;
-    keywords["["] = TokenType::LEFT_BRACKET;
-    keywords["]"] = TokenType::RIGHT_BRACKET;
-    keywords[","] = TokenType::COMMA;
-    keywords[";"] = TokenType::SEMICOLON;
-    keywords["."] = TokenType::DOT;
-
+Lexer::Lexer(std::string_view source, size_t begin, const LineTable& lines, bool chunk)
+    : source(source), current(begin), lines_(lines), scan_(scanKernels()), chunk_(chunk) {
 }
 
 
@@ -71,16 +27,7 @@ char Lexer::advance() {
         return '\0';  // Hoặc throw một exception
     }
     
-    char c = source[current++];
-    
-    if (c == '\n') {
-        line++;
-        column = 1;
-    } else {
-        column++;
-    }
-    
-    return c;
+    return source[current++];
 }
 
 
@@ -102,11 +49,10 @@ char Lexer::advance() {
     }        // check if source is end or not
 
     bool Lexer::match(char expected) {
-        if(isEnd()) return false;
+        if(current + 1 >= source.length()) return false;
         if(source[current + 1] != expected) return false;
 
         current++;
-        column++;
         return true;
 
     }       //check and read if match
@@ -116,8 +62,41 @@ char Lexer::advance() {
         return source[current + 2];
     }
 
+    std::string_view Lexer::lexemeFrom(size_t start) const {
+        return std::string_view(source.data() + start, current - start);
+    }
+
+    Token Lexer::makeToken(TokenType type, size_t start, std::string_view lexeme) const {
+        return {type, static_cast<uint32_t>(start), lexeme};
+    }
+
+    std::string_view Lexer::keepText(const std::string& text) {
+        return text_.copyString(text);
+    }
+
 
     std::vector<Token> Lexer::scanTokens() {
+        tokens.reserve(source.length() / 8 + 1); // Typical source averages 8-10 bytes per token
+        scanLoop();
+        tokens.push_back(makeToken(TokenType::EOF_TOKEN, current, ""));
+        return std::move(tokens); // The Lexer has no further use for them
+    }
+
+    Token Lexer::nextToken() {
+        if (isEnd() || exhausted_) {
+            return makeToken(TokenType::EOF_TOKEN, current, "");
+        }
+        try {
+            return scanToken();
+        } catch (const std::exception& e) {
+            // Same as scanLoop: report it and end the stream here
+            LOG_ERROR("Fatal error during lexical analysis: " << e.what());
+            exhausted_ = true;
+            return makeToken(TokenType::EOF_TOKEN, current, "");
+        }
+    }
+
+    void Lexer::scanLoop() {
         int callCount = 0;
         int lastPosition = -1;
         int stuckCounter = 0;
@@ -129,13 +108,13 @@ char Lexer::advance() {
                 // THÊM DEBUG: Theo dõi vị trí để phát hiện lexer bị kẹt
                 if (current == lastPosition) {
                     stuckCounter++;
-                    std::cerr << "WARNING: Lexer possibly stuck at position " << current 
+                    LOG_WARN("WARNING: Lexer possibly stuck at position " << current 
                               << " (" << stuckCounter << " times), char: '" 
-                              << (current < source.length() ? source[current] : '\0') << "'" << std::endl;
+                              << (current < source.length() ? source[current] : '\0') << "'");
                     
                     // Nếu kẹt quá nhiều lần tại cùng một vị trí, buộc phải thoát
                     if (stuckCounter > 5) {
-                        std::cerr << "ERROR: Lexer definitively stuck, breaking loop" << std::endl;
+                        LOG_ERROR("ERROR: Lexer definitively stuck, breaking loop");
                         break;
                     }
                 } else {
@@ -144,281 +123,480 @@ char Lexer::advance() {
                 lastPosition = current;
                 
                 // THÊM DEBUG: In thông tin trước khi gọi scanToken()
-                std::cerr << "--- DEBUG: scanToken() call #" << callCount 
+                LOG_TRACE("scanToken() call #" << callCount 
                           << " at position: " << current 
-                          << ", line: " << line 
-                          << ", column: " << column << std::endl;
-                
-                if (!isEnd()) {
-                    std::cerr << "Current char: '" << peek() 
-                              << "' (ASCII: " << (int)peek() << ")" << std::endl;
-                }
+                          << ", line: " << lines_.position(current).line 
+                          << ", column: " << lines_.position(current).column
+                          << ", current char: '" << peek() << "' (ASCII: " << (int)peek() << ")");
                 
                 // Gọi scanToken() và ghi log kết quả
+                size_t callStart = current;
                 Token token = scanToken();
-                std::cerr << "Generated token with type " << tokenTypeToString(token.type) 
-                          << " (\"" << token.lexeme << "\") at line " << token.line 
-                          << ", column " << token.column << std::endl;
+                if (spilled_ && chunk_) {
+                    // The construct continues past this chunk; scanTokensParallel redoes the call
+                    spillFrom_ = callStart;
+                    break;
+                }
+                LOG_TRACE("Generated token with type " << tokenTypeToString(token.type) 
+                          << " (\"" << token.lexeme << "\") at line " << lines_.position(token.offset).line 
+                          << ", column " << lines_.position(token.offset).column);
                 
                 if (token.type != TokenType::ERROR) {
                     tokens.push_back(token);
                 } else {
                     tokens.push_back(token);
-                    std::cerr << "Error at line " << token.line << ", column " << token.column 
-                              << ": " << token.lexeme << std::endl;
+                    LOG_DEBUG("Error at line " << lines_.position(token.offset).line
+                              << ", column " << lines_.position(token.offset).column 
+                              << ": " << token.lexeme);
                 }
                 
                 // THÊM DEBUG: Kiểm tra vị trí sau khi xử lý token
-                std::cerr << "After token: current=" << current 
-                          << ", next char: '" << peek() << "'" << std::endl;
+                LOG_TRACE("After token: current=" << current 
+                          << ", next char: '" << peek() << "'");
             }
         } catch (const std::exception& e) {
-            std::cerr << "Fatal error during lexical analysis: " << e.what() << std::endl;
+            LOG_ERROR("Fatal error during lexical analysis: " << e.what());
         }
-        
-        tokens.push_back({TokenType::EOF_TOKEN, "", line, column});
-        return tokens;
+    }
+
+    // --- Parallel chunked lexing ---
+    // Only two constructs can carry lexer state across a newline: a block
+    // comment, and the whitespace between 'style' and its path. Every chunk
+    // starts right after a '\n' and is lexed speculatively as if neither were
+    // open. The chunks are then stitched in order, tracking where the serial
+    // lexer would make its next scanToken() call:
+    //  - a chunk that ran into its end inside one of those constructs
+    //    ("spilled") has that call redone over the whole buffer, which tells
+    //    where the serial lexer resumes;
+    //  - a chunk whose start does not match that resume point was guessed
+    //    wrong and is re-lexed from it; chunks swallowed whole are skipped.
+    // Spills are rare, so almost all chunks are used as lexed.
+    std::vector<Token> Lexer::scanTokensParallel(unsigned threadCount) {
+        constexpr size_t MIN_CHUNK_BYTES = 256 * 1024;
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        size_t length = source.length();
+        // A few chunks per thread, so one slow chunk does not idle the others
+        size_t chunkCount = std::min<size_t>(size_t(threadCount) * 4, length / MIN_CHUNK_BYTES);
+        if (threadCount < 2 || chunkCount < 2 || current != 0 || chunk_) {
+            return scanTokens();
+        }
+
+        // Chunk boundaries: just past the first newline at or after each even split
+        std::vector<size_t> bounds{0};
+        for (size_t i = 1; i < chunkCount; ++i) {
+            size_t from = std::max(length / chunkCount * i, bounds.back());
+            const void* newline = std::memchr(source.data() + from, '\n', length - from);
+            if (!newline) break;
+            size_t bound = static_cast<const char*>(newline) - source.data() + 1;
+            if (bound > bounds.back() && bound < length) bounds.push_back(bound);
+        }
+        bounds.push_back(length);
+        chunkCount = bounds.size() - 1;
+
+        auto chunkLexer = [&](size_t begin, size_t end) {
+            chunks_.push_back(std::unique_ptr<Lexer>(new Lexer(source.substr(0, end), begin, lines_, true)));
+            return chunks_.back().get();
+        };
+        std::vector<Lexer*> guesses;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            guesses.push_back(chunkLexer(bounds[i], bounds[i + 1]));
+        }
+
+        std::atomic<size_t> nextChunk{0};
+        auto worker = [&]() {
+            for (size_t i; (i = nextChunk.fetch_add(1)) < chunkCount;) {
+                Lexer& part = *guesses[i];
+                part.tokens.reserve((bounds[i + 1] - bounds[i]) / 8 + 1);
+                part.scanLoop();
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < std::min<size_t>(threadCount, chunkCount); ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) thread.join();
+
+        // Stitch. EOF tokens from a chunk's trailing whitespace are dropped;
+        // only those at the real end of the buffer are kept, as in scanTokens().
+        tokens.reserve(length / 8 + 1);
+        // Identifiers get their interner ids here, so discarded guesses intern nothing.
+        auto append = [&](const Token& token, Lexer& from) {
+            if (token.type == TokenType::IDENTIFIER) {
+                tokens.emplace_back(token.type, token.offset, token.lexeme, from.symbols_.resolve(token.symbol));
+            } else if (token.type != TokenType::EOF_TOKEN || token.offset == length) {
+                tokens.push_back(token);
+            }
+        };
+        size_t resume = 0; // Where the serial lexer makes its next scanToken() call
+        for (size_t i = 0; i < chunkCount; ++i) {
+            if (resume >= bounds[i + 1]) continue; // Inside a comment or path that spilled over it
+            Lexer* part = guesses[i];
+            if (resume != bounds[i]) {
+                LOG_DEBUG("Re-lexing chunk " << i << " from offset " << resume);
+                part = chunkLexer(resume, bounds[i + 1]);
+                part->scanLoop();
+            }
+            for (const Token& token : part->tokens) append(token, *part);
+            part->tokens = std::vector<Token>(); // Merged; free it early
+            resume = bounds[i + 1];
+            if (part->spilled_) {
+                Lexer* tail = chunkLexer(part->spillFrom_, length);
+                append(tail->scanToken(), *tail);
+                resume = tail->current;
+            }
+        }
+        current = length;
+        tokens.push_back(makeToken(TokenType::EOF_TOKEN, current, ""));
+        return std::move(tokens);
+    }
+
+    // --- Incremental re-lexing ---
+    // Lexing restarts a few tokens before the edit (a token's end and its
+    // lookahead of up to two characters may reach into the edited bytes) and
+    // stops at the first new token past the edit that the old stream also has
+    // at the same shifted offset: from an identical position over identical
+    // text the rest of the stream is identical too. Style paths and error
+    // tokens are never used as restart or sync points, since their offset is
+    // not where lexing of them began.
+    static bool isRelexAnchor(TokenType type) {
+        return type != TokenType::ERROR && type != TokenType::STYLE_INCLUDE && type != TokenType::EOF_TOKEN;
+    }
+
+    IncrementalLexer::IncrementalLexer(std::string_view source) : source_(source), lines_(source) {
+        Lexer lexer(source, 0, lines_, false);
+        std::vector<Token> tokens = lexer.scanTokens();
+        // Either side may come to hold every token; with room reserved up
+        // front a far jump does not reallocate (untouched pages cost nothing)
+        head_.reserve(tokens.size());
+        tail_.reserve(tokens.size());
+        for (const Token& token : tokens) head_.push_back(store(token));
+    }
+
+    IncrementalLexer::StoredToken IncrementalLexer::store(const Token& token) {
+        StoredToken stored{token.type, token.symbol, token.offset, 0, static_cast<uint32_t>(token.lexeme.size()), nullptr};
+        const char* data = token.lexeme.data();
+        if (token.lexeme.empty()) return stored;
+        if (data >= source_.data() && data + token.lexeme.size() <= source_.data() + source_.size()) {
+            stored.lexemeAt = static_cast<uint32_t>(data - source_.data()) - token.offset;
+        } else {
+            stored.text = text_.copyString(token.lexeme).data();
+        }
+        return stored;
+    }
+
+    Token IncrementalLexer::load(const StoredToken& stored, uint32_t offset) const {
+        std::string_view lexeme;
+        if (stored.text) {
+            lexeme = std::string_view(stored.text, stored.length);
+        } else if (stored.length > 0) {
+            lexeme = source_.substr(offset + stored.lexemeAt, stored.length);
+        }
+        return Token(stored.type, offset, lexeme, stored.symbol);
+    }
+
+    Token IncrementalLexer::token(size_t index) const {
+        if (index < head_.size()) return load(head_[index], head_[index].offset);
+        const StoredToken& stored = tail_[tail_.size() - 1 - (index - head_.size())];
+        return load(stored, stored.offset + tailShift_);
+    }
+
+    std::vector<Token> IncrementalLexer::tokens() const {
+        std::vector<Token> all;
+        all.reserve(size());
+        for (size_t i = 0; i < size(); ++i) all.push_back(token(i));
+        return all;
+    }
+
+    // Moves the split to just before the first token at or after offset
+    void IncrementalLexer::moveSplit(uint32_t offset) {
+        // Moves from[first, end) onto the end of `to` in reverse order, adding shift
+        auto moveReversed = [](std::vector<StoredToken>& from, size_t first, std::vector<StoredToken>& to, uint32_t shift) {
+            size_t count = from.size() - first;
+            size_t base = to.size();
+            to.resize(base + count);
+            const StoredToken* in = from.data() + from.size();
+            for (StoredToken* out = to.data() + base, *end = out + count; out != end; ++out) {
+                *out = *--in;
+                out->offset += shift;
+            }
+            from.resize(first);
+        };
+        // tail_ holds later tokens first, so those starting before offset are at its back
+        auto later = std::partition_point(tail_.begin(), tail_.end(),
+            [this, offset](const StoredToken& token) { return token.offset + tailShift_ >= offset; });
+        moveReversed(tail_, later - tail_.begin(), head_, tailShift_);
+        auto earlier = std::partition_point(head_.begin(), head_.end(),
+            [offset](const StoredToken& token) { return token.offset < offset; });
+        moveReversed(head_, earlier - head_.begin(), tail_, 0 - tailShift_);
+    }
+
+    RelexResult IncrementalLexer::relex(std::string_view source, const SourceEdit& edit) {
+        if (edit.offset + edit.removedLength > source_.size() ||
+            source_.size() - edit.removedLength + edit.insertedText.size() != source.size()) {
+            throw std::invalid_argument("relex: edit does not turn the old source into this one");
+        }
+        uint32_t editOffset = static_cast<uint32_t>(edit.offset);
+        uint32_t newEditEnd = static_cast<uint32_t>(edit.offset + edit.insertedText.size());
+        uint32_t shift = static_cast<uint32_t>(edit.insertedText.size()) - static_cast<uint32_t>(edit.removedLength);
+        auto toTail = [&]() {
+            StoredToken token = head_.back();
+            head_.pop_back();
+            token.offset -= tailShift_;
+            tail_.push_back(token);
+        };
+        // The i-th old token past the split, and its offset before the edit
+        auto oldToken = [&](size_t i) -> const StoredToken& { return tail_[tail_.size() - 1 - i]; };
+        auto oldOffset = [&](size_t i) -> uint32_t { return oldToken(i).offset + tailShift_; };
+
+        // Split before the first token at or after the edit, then three
+        // anchor tokens earlier, so the kept tokens' lookahead cannot reach
+        // the edited bytes
+        moveSplit(editOffset);
+        for (int backoff = 3; !head_.empty() && backoff > 0; ) {
+            if (isRelexAnchor(head_.back().type)) --backoff;
+            toTail();
+        }
+        while (!head_.empty() && !isRelexAnchor(oldToken(0).type)) toTail();
+        size_t first = head_.size();
+        size_t restart = first > 0 ? oldOffset(0) : 0;
+
+        lines_.replace(editOffset, static_cast<uint32_t>(edit.removedLength), edit.insertedText);
+        source_ = source;
+        Lexer lexer(source_, restart, lines_, false);
+        std::vector<Token> fresh;
+        size_t old = 0; // Candidate sync point, counted from the split
+        bool synced = false;
+        while (!lexer.isEnd()) {
+            Token token = lexer.scanToken();
+            fresh.push_back(token);
+            if (token.offset < newEditEnd || !isRelexAnchor(token.type)) continue;
+            uint32_t wasAt = token.offset - shift;
+            while (old < tail_.size() && oldOffset(old) < wasAt) ++old;
+            // Past the edit, an old token's source text sits at its shifted offset
+            if (old < tail_.size() && oldOffset(old) == wasAt && oldToken(old).type == token.type &&
+                load(oldToken(old), token.offset).lexeme == token.lexeme) {
+                synced = true;
+                break;
+            }
+        }
+        if (synced) {
+            fresh.pop_back(); // The matching token is carried over with the rest
+        } else {
+            fresh.push_back(lexer.makeToken(TokenType::EOF_TOKEN, lexer.current, ""));
+            old = tail_.size();
+        }
+
+        // Tokens re-lexed before the edit that came out the same are not
+        // changes. An old lexeme reaching into the edited bytes is taken as
+        // changed: only the new text is at hand to compare it with.
+        size_t same = 0;
+        while (same < fresh.size() && same < old) {
+            const Token& now = fresh[same];
+            const StoredToken& was = oldToken(same);
+            uint32_t wasAt = oldOffset(same);
+            if (now.offset >= editOffset || now.offset != wasAt || now.type != was.type ||
+                (!was.text && wasAt + was.lexemeAt + was.length > editOffset) ||
+                load(was, wasAt).lexeme != now.lexeme) {
+                break;
+            }
+            ++same;
+        }
+
+        // Drop the replaced tokens, shift the rest with one add, and put the
+        // new ones before the split
+        RelexResult result;
+        result.first = first + same;
+        result.oldEnd = first + old;
+        result.newEnd = first + fresh.size();
+        tail_.resize(tail_.size() - old);
+        tailShift_ += shift;
+        for (const Token& token : fresh) head_.push_back(store(token));
+        return result;
     }
     
     
 
     Token Lexer::scanToken() {
-        static int previousPosition = -1;
         // static int tokenCount = 0; // Keep for potential future debugging
 
+        // Comments restart the loop instead of recursing into scanToken
+        for (;;) {
         // Prevent infinite loops
-        if (current == previousPosition && !isEnd()) {
-            std::cerr << "WARNING: Lexer stuck at position " << current 
-                      << ", line " << line << ", col " << column 
-                      << ", char: '" << peek() << "'" << std::endl;
+        if (current == previousPosition_ && !isEnd()) {
+            LOG_WARN("WARNING: Lexer stuck at position " << current 
+                      << ", line " << lines_.position(current).line << ", col " << lines_.position(current).column 
+                      << ", char: '" << peek() << "'");
+            size_t stuckAt = current;
             char stuckChar = advance(); // Consume the problematic character
-            return {TokenType::ERROR, std::string("Lexer stuck on character: ") + stuckChar, line, column - 1};
+            return makeToken(TokenType::ERROR, stuckAt, keepText(std::string("Lexer stuck on character: ") + stuckChar));
         }
-        previousPosition = current;
+        previousPosition_ = current;
             
-        skipWhitespace();
+        if (!isEnd() && charClass(source[current]) <= CharClass::Newline) {
+            skipWhitespace();
+        }
 
         if (isEnd()) {
-            return {TokenType::EOF_TOKEN, "", line, column};
+            return makeToken(TokenType::EOF_TOKEN, current, "");
         }
     
-        int startColumn = column;
-        int startLine = line; // Capture start line for tokens
+        size_t start = current;
         char c = peek();
 
-        // --- Handle Comments First --- 
-        if (c == '/' && peekNext() == '/') {
-            while (peek() != '\n' && !isEnd()) advance();
-            return scanToken(); // Recursively call to get the next actual token
-        }
-        if (c == '/' && peekNext() == '*') {
-            advance(); advance(); // Consume /*
-            int commentStartLine = line;
-            int commentStartCol = startColumn;
-            while (!isEnd()) {
-                if (peek() == '*' && peekNext() == '/') {
-                    advance(); advance(); // Consume */
-                    break;
+        // Dispatch on the character class (char_class.h) of the first character
+        switch (charClass(c)) {
+
+        // --- Comments and Division ---
+        case CharClass::Slash:
+            if (peekNext() == '/') {
+                // Line comment: jump straight to the newline (it stays for skipWhitespace)
+                const char* text = source.data();
+                current = scan_.findNewline(text + current, text + source.length()) - text;
+                continue; // Get next actual token
             }
-                if (isEnd()) { // Unterminated comment
-                     return {TokenType::ERROR, "Unterminated block comment", commentStartLine, commentStartCol};
+            if (peekNext() == '*') {
+                advance(); advance(); // Consume /*
+                // Jump to the closing */ (or the end of an unterminated comment);
+                // the newlines inside are already in lines_
+                const char* text = source.data();
+                current = scan_.findCommentClose(text + current, text + source.length()) - text;
+                if (isEnd()) spilled_ = true; // Unterminated, or it goes on in the next chunk
+                if (!isEnd()) {
+                    advance(); advance(); // Consume */
                 }
-                advance(); // Consume comment character
+                continue; // Get next actual token
             }
-            return scanToken(); // Get next actual token
-        }
-        
-        // --- Handle STYLE Include --- 
-        // Check for 'style' keyword specifically
-        if (c == 's' && source.substr(current, 5) == "style") {
-             int keywordEndPos = current + 5;
-             // Check if it's followed by non-alphanumeric to confirm it's the keyword
-             if (keywordEndPos >= source.length() || !isalnum(source[keywordEndPos])) {
-                 // Consume "style"
-                 current = keywordEndPos;
-                 column += 5;
-                 skipWhitespace(); // Skip space before < or "
-                 startColumn = column; // Update start column for the path
-                 char pathDelimiter = peek();
-                 std::string pathLexeme;
-                 
-                 if (pathDelimiter == '<') {
-                     advance(); // Consume '<'
-                     while (!isEnd() && peek() != '>' && peek() != '\n') {
-                         pathLexeme += advance();
-                     }
-                if (peek() == '>') {
-                         advance(); // Consume '>'
-                         return {TokenType::STYLE_INCLUDE, pathLexeme, startLine, startColumn};
-                     } else {
-                         return {TokenType::ERROR, "Unterminated style path starting with <", startLine, startColumn};
-                     }
-                 } else if (pathDelimiter == '"') {
-                      advance(); // Consume '"'
-                      int pathStartLine = line; // Store line in case of multi-line path
-                      while (!isEnd() && peek() != '"' && peek() != '\n') {
-                         pathLexeme += advance();
-                      }
-                       if (peek() == '"') {
-                         advance(); // Consume '"'
-                         return {TokenType::STYLE_INCLUDE, pathLexeme, pathStartLine, startColumn};
-                     } else {
-                         return {TokenType::ERROR, "Unterminated style path starting with \"", pathStartLine, startColumn};
-                     }
-                 } else {
-                      // It was "style" but not followed by < or ", treat as identifier or error? 
-                      // For now, let it fall through to identifier handling if possible, 
-                      // or return error if context demands include path.
-                      // Let's return error for clarity, parser expects path here.
-                      return {TokenType::ERROR, "Expected '<' or '\"' after style keyword", startLine, column};
-                 }
-             }
-             // If it wasn't "style " or similar, fall through to general identifier handling
-        }
+            advance();
+            return makeToken(TokenType::SLASH, start, lexemeFrom(start));
 
-        // --- Handle Multi-Character Operators & Punctuation FIRST --- 
+        // --- Multi-Character Operators ---
         // Order matters: check longer tokens before shorter prefixes
-        if (c == '<') {
-             if (match('<')) {advance(); return {TokenType::STREAM_OUT, "<<", startLine, startColumn};}
-             if (match('=')) {advance(); return {TokenType::LESS_EQUAL, "<=", startLine, startColumn};}
+        case CharClass::Less:
+             if (match('<')) {advance(); return makeToken(TokenType::STREAM_OUT, start, lexemeFrom(start));}
+             if (match('=')) {advance(); return makeToken(TokenType::LESS_EQUAL, start, lexemeFrom(start));}
              // If neither match succeeded, consume c and return LESS
              advance();
-             return {TokenType::LESS, "<", startLine, startColumn};
-        }
-        if (c == '>') {
-             if (match('>')) {advance(); return {TokenType::STREAM_IN, ">>", startLine, startColumn};}
-             if (match('=')) {advance(); return {TokenType::GREATER_EQUAL, ">=", startLine, startColumn};}
+             return makeToken(TokenType::LESS, start, lexemeFrom(start));
+        case CharClass::Greater:
+             if (match('>')) {advance(); return makeToken(TokenType::STREAM_IN, start, lexemeFrom(start));}
+             if (match('=')) {advance(); return makeToken(TokenType::GREATER_EQUAL, start, lexemeFrom(start));}
              // If neither match succeeded, consume c and return GREATER
-                    advance();
-             return {TokenType::GREATER, ">", startLine, startColumn};
-        }
-        if (c == '=') {
-             if (match('=')) {advance(); return {TokenType::EQUAL, "==", startLine, startColumn};}
-              // If not '==', consume the original '=' and return ASSIGN
+             advance();
+             return makeToken(TokenType::GREATER, start, lexemeFrom(start));
+        case CharClass::Equal:
+             if (match('=')) {advance(); return makeToken(TokenType::EQUAL, start, lexemeFrom(start));}
+             // If not '==', consume the original '=' and return ASSIGN
              advance(); // Consume the '='
-             return {TokenType::ASSIGN, "=", startLine, startColumn};
-        }
-         if (c == '!') {
-             if (match('=')) {advance(); return {TokenType::NOT_EQUAL, "!=", startLine, startColumn};}
+             return makeToken(TokenType::ASSIGN, start, lexemeFrom(start));
+        case CharClass::Bang:
+             if (match('=')) {advance(); return makeToken(TokenType::NOT_EQUAL, start, lexemeFrom(start));}
              // If not '!=', consume c and return NOT
              advance();
-             return {TokenType::NOT, "!", startLine, startColumn};
-        }
-        if (c == '-') {
-             if (match('>')) {advance(); return {TokenType::ARROW, "->", startLine, startColumn};}
+             return makeToken(TokenType::NOT, start, lexemeFrom(start));
+        case CharClass::Minus:
+             if (match('>')) {advance(); return makeToken(TokenType::ARROW, start, lexemeFrom(start));}
              // Check if it's a negative number (BEFORE treating as minus operator)
              if (isdigit(peek()) || (peek() == '.' && isdigit(peekNext()))) {
                  return Number(); // Let Number() handle it, including the leading '-'
              }
              // If not '->' or start of number, consume c and return MINUS
              advance();
-             return {TokenType::MINUS, "-", startLine, startColumn};
-        }
-        if (c == ':') {
-            if (match(':')) {advance(); return {TokenType::SCOPE_RESOLUTION, "::", startLine, startColumn};}
+             return makeToken(TokenType::MINUS, start, lexemeFrom(start));
+        case CharClass::Colon:
+            if (match(':')) {advance(); return makeToken(TokenType::SCOPE_RESOLUTION, start, lexemeFrom(start));}
              // If not '::', consume c and return COLON
             advance();
-            return {TokenType::COLON, ":", startLine, startColumn};
-        }
+            return makeToken(TokenType::COLON, start, lexemeFrom(start));
 
-        // --- Check for Start of Number ---
-        if (isdigit(c) || (c == '.' && isdigit(peek()))) // Check current char or '.' followed by digit
-        {
+        // --- Numbers and Strings ---
+        case CharClass::Digit:
             return Number();
-            }
-    
-        // --- Handle Strings ---
-        if (c == '"') {
+        case CharClass::Quote:
             return string(); // string() handles consuming the rest
-        }
 
-        // --- Handle Identifiers & Other Keywords ---
-        // This should only be reached if c wasn't part of an operator, number, or string start
-        if (isalpha(c) || c == '_') { 
-            std::string lexeme;
-            lexeme += advance(); // Consume the first char (c)
-            while (isalnum(peek()) || peek() == '_') {
-                lexeme += advance();
-            }
-            auto it = keywords.find(lexeme);
-            if (it != keywords.end()) {
-                return {it->second, lexeme, startLine, startColumn};
+        // --- Identifiers, Keywords and STYLE Include ---
+        case CharClass::IdentStart: {
+            // 'style' followed by a non-alphanumeric character starts an include path
+            if (c == 's' && source.compare(current, 5, "style") == 0) {
+                size_t keywordEndPos = current + 5;
+                if (keywordEndPos >= source.length() || !isAlnumChar(source[keywordEndPos])) {
+                    return styleInclude();
                 }
-            return {TokenType::IDENTIFIER, lexeme, startLine, startColumn};
-        }
-
-        // --- Handle Remaining Single-Character Punctuation --- 
-        // These should be characters not starting any multi-char token handled above
-        // or prefixes of numbers/identifiers/strings
-        switch (c) {
-            case '+': advance(); return {TokenType::PLUS, "+", startLine, startColumn};
-            // case '-': // Handled above
-            case '*': advance(); return {TokenType::STAR, "*", startLine, startColumn};
-            case '/': advance(); return {TokenType::SLASH, "/", startLine, startColumn};
-            case '%': advance(); return {TokenType::MODULO, "%", startLine, startColumn};
-            // case '<': // Handled above
-            // case '>': // Handled above
-            // case '=': // Handled above
-            // case '!': // Handled above
-            case '.': advance(); return {TokenType::DOT, ".", startLine, startColumn}; // Standalone DOT
-            // case ':': // Handled above
-            case ',': advance(); return {TokenType::COMMA, ",", startLine, startColumn};
-            case ';': advance(); return {TokenType::SEMICOLON, ";", startLine, startColumn};
-            case '(': advance(); return {TokenType::LEFT_PAREN, "(", startLine, startColumn};
-            case ')': advance(); return {TokenType::RIGHT_PAREN, ")", startLine, startColumn};
-            case '{': advance(); return {TokenType::LEFT_BRACE, "{", startLine, startColumn};
-            case '}': advance(); return {TokenType::RIGHT_BRACE, "}", startLine, startColumn};
-            case '[': advance(); return {TokenType::LEFT_BRACKET, "[", startLine, startColumn};
-            case ']': advance(); return {TokenType::RIGHT_BRACKET, "]", startLine, startColumn};
+            }
+            const char* text = source.data();
+            current = scan_.skipIdentChars(text + current + 1, text + source.length()) - text;
+            std::string_view lexeme = lexemeFrom(start);
+            TokenType type = lookupKeyword(lexeme);
+            if (type != TokenType::IDENTIFIER) {
+                return makeToken(type, start, lexeme);
+            }
+            // Intern once here so later stages compare names by id. A chunk's
+            // guess may be thrown away, so it keeps local ids until stitched.
+            SymbolId symbol = chunk_ ? symbols_.local(lexeme) : symbols_.intern(lexeme);
+            return Token(type, static_cast<uint32_t>(start), lexeme, symbol);
         }
-        
-        // --- Error for Unknown Character --- 
-        // Consume the unknown character before returning error
-        advance(); 
-        return {TokenType::ERROR, "Unexpected character: " + std::string(1, c), startLine, startColumn};
-    }
-    
-    
-    
 
-    Token Lexer::identifier() {
-        int startLine = line;
-        int startColumn = column;
-        
-        //std::cerr << "DEBUG: identifier() start at: " << current << std::endl;
-        
-        std::string lexeme;
-        
-        // Đọc bắt buộc ký tự đầu tiên
-        if (!isEnd()) {
-            lexeme += advance();
-            //std::cerr << "DEBUG: First char: '" << lexeme << "'" << std::endl;
+        // --- Single-Character Punctuation ---
+        case CharClass::Punct:
+            advance();
+            return makeToken(PUNCT_TYPE[static_cast<unsigned char>(c)], start, lexemeFrom(start));
+
+        // --- Error for Unknown Character ---
+        default:
+            // Consume the unknown character before returning error
+            advance(); 
+            return makeToken(TokenType::ERROR, start, keepText("Unexpected character: " + std::string(1, c)));
         }
-        
-        // Đọc các ký tự còn lại
-        while (!isEnd() && (isalnum(peek()) || peek() == '_')) {
-            lexeme += advance();
         }
-        
-        // Kiểm tra từ khóa sử dụng map thay vì nhiều if-else
-        auto it = keywords.find(lexeme);
-        if (it != keywords.end()) {
-            //std::cerr << "DEBUG: identifier() end at: " << current << std::endl;
-            return {it->second, lexeme, startLine, startColumn};
+    }
+
+    // Called with `current` at the 's' of a 'style' keyword
+    Token Lexer::styleInclude() {
+        // Consume "style"
+        current += 5;
+        skipWhitespace(); // Skip space before < or "
+        if (isEnd()) spilled_ = true; // The path may be on a later line, in the next chunk
+        size_t start = current; // The token is reported at the path delimiter
+        char pathDelimiter = peek();
+
+        if (pathDelimiter == '<') {
+            advance(); // Consume '<'
+            size_t pathStart = current;
+            while (!isEnd() && peek() != '>' && peek() != '\n') {
+                advance();
+            }
+            if (peek() == '>') {
+                std::string_view pathLexeme = lexemeFrom(pathStart);
+                advance(); // Consume '>'
+                return makeToken(TokenType::STYLE_INCLUDE, start, pathLexeme);
+            } else {
+                return makeToken(TokenType::ERROR, start, "Unterminated style path starting with <");
+            }
+        } else if (pathDelimiter == '"') {
+            advance(); // Consume '"'
+            size_t pathStart = current;
+            while (!isEnd() && peek() != '"' && peek() != '\n') {
+                advance();
+            }
+            if (peek() == '"') {
+                std::string_view pathLexeme = lexemeFrom(pathStart);
+                advance(); // Consume '"'
+                return makeToken(TokenType::STYLE_INCLUDE, start, pathLexeme);
+            } else {
+                return makeToken(TokenType::ERROR, start, "Unterminated style path starting with \"");
+            }
+        } else {
+            // It was "style" but not followed by < or ", and the parser expects a path here
+            return makeToken(TokenType::ERROR, current, "Expected '<' or '\"' after style keyword");
         }
-        
-        // Nếu không phải từ khóa, return as identifier
-        //std::cerr << "DEBUG: identifier() end at: " << current << std::endl;
-        return {TokenType::IDENTIFIER, lexeme, startLine, startColumn};
     }
     
     
     
-    
+
     Token Lexer::Number() {
-        int startColumn = column;
-        int startLine = line;
-        std::string lexeme = "";
+        size_t start = current; // The lexeme is source[start, current)
         TokenType inferredType = TokenType::NUMBER; // Start assuming integer
         int startPos = current; // Initial position for loop detection
         
@@ -427,23 +605,23 @@ char Lexer::advance() {
             if (!isdigit(peekNext()) && peekNext() != '.') {
                 // Let scanToken handle it as an operator
                 // This should ideally not be reached if scanToken logic is correct
-                return {TokenType::ERROR, "Sign not followed by digit or dot", startLine, startColumn};
+                return makeToken(TokenType::ERROR, start, "Sign not followed by digit or dot");
             }
-            lexeme += advance();
+            advance();
         }
 
         // Check for Hex/Binary/Octal prefix AFTER potential sign
         if (peek() == '0' && (peekNext() == 'x' || peekNext() == 'X' || 
                             peekNext() == 'b' || peekNext() == 'B' || 
                             peekNext() == 'o' || peekNext() == 'O')) {
-            lexeme += advance(); // Consume '0'
-            return handleSpecialNumber(lexeme, startColumn); // This handles hex floats too
+            advance(); // Consume '0'
+            return handleSpecialNumber(start); // This handles hex floats too
         }
 
         // 2. Consume Integer Part (if any)
         bool hasLeadingDigits = isdigit(peek());
         if (hasLeadingDigits) {
-            consumeDigits(lexeme);
+            consumeDigits();
         }
 
         // 3. Consume Decimal Part (if present)
@@ -452,45 +630,45 @@ char Lexer::advance() {
             // Make sure it's not the '..' operator
             if (peekNext() == '.') {
                  // It's an integer followed by '..', return the integer part if any digits were read
-                 if (hasLeadingDigits || !lexeme.empty()) { // Need digits before or sign 
-                      return {TokenType::NUMBER, lexeme, startLine, startColumn};
+                 if (hasLeadingDigits || current > start) { // Need digits before or sign 
+                      return makeToken(TokenType::NUMBER, start, lexemeFrom(start));
                 } else {
                       // Just a lone '.' followed by '.'? Let scanToken handle it.
-                      return {TokenType::ERROR, "Invalid token start", startLine, startColumn};
+                      return makeToken(TokenType::ERROR, start, "Invalid token start");
                 }
             }
             // Check if there are digits *after* the dot
             if (isdigit(peekNext())) {
                  hasDecimalPoint = true;
                  inferredType = TokenType::DOUBLE_LITERAL; // Now it's a float/double
-                 lexeme += advance(); // Consume '.'
-                 consumeDigits(lexeme); // Consume digits AFTER the dot
-            } else if (hasLeadingDigits || !lexeme.empty()) {
+                 advance(); // Consume '.'
+                 consumeDigits(); // Consume digits AFTER the dot
+            } else if (hasLeadingDigits || current > start) {
                  // It's a number followed by a dot, but no digits after the dot (e.g., "123.")
                  // Still treat as a double literal in many languages
                  hasDecimalPoint = true;
                  inferredType = TokenType::DOUBLE_LITERAL;
-                 lexeme += advance(); // Consume the dot
+                 advance(); // Consume the dot
             } else {
                  // Just a lone dot, not followed by digits. Let scanToken handle it.
                  // If we started with a sign, it's an error here.
-                 if (!lexeme.empty()) { // Had a sign
+                 if (current > start) { // Had a sign
                        // Backtrack the sign
-                       current--; column--;
-                       char op = lexeme[0];
-                       return { op == '+' ? TokenType::PLUS : TokenType::MINUS, std::string(1, op), startLine, startColumn };
+                       current--;
+                       char op = source[start];
+                       return makeToken(op == '+' ? TokenType::PLUS : TokenType::MINUS, start, source.substr(start, 1));
                  }
                  // Otherwise, let scanToken handle the lone dot
-                 return {TokenType::ERROR, "Invalid token start", startLine, startColumn}; 
+                 return makeToken(TokenType::ERROR, start, "Invalid token start"); 
             }
         }
 
         // Ensure we consumed *something* if we started with digits or a dot that formed part of a number
-        if (!hasLeadingDigits && !hasDecimalPoint && lexeme.empty()) {
+        if (!hasLeadingDigits && !hasDecimalPoint && current == start) {
             // Didn't start with digit, didn't start with valid '.' + digit, didn't start with sign + digit/dot
             // This path indicates an error or logic flaw in scanToken calling Number()
             if (!isEnd()) advance(); // Prevent infinite loop
-            return {TokenType::ERROR, "Number() called inappropriately", startLine, startColumn};
+            return makeToken(TokenType::ERROR, start, "Number() called inappropriately");
             }
             
         // 4. Consume Exponent (if present)
@@ -501,10 +679,8 @@ char Lexer::advance() {
                 if (inferredType == TokenType::NUMBER) {
                     inferredType = TokenType::DOUBLE_LITERAL; // Int + exponent -> double
                 }
-                std::string beforeExp = lexeme;
-                handleExponent(lexeme, false); // false = decimal exponent
-                if (lexeme == beforeExp) { // handleExponent should have consumed digits
-                    return {TokenType::ERROR, "Invalid exponent format (missing digits)", startLine, startColumn};
+                if (!handleExponent(false)) { // false = decimal exponent
+                    return makeToken(TokenType::ERROR, start, "Invalid exponent format (missing digits)");
                     }
                 hasExponent = true;
             }
@@ -520,37 +696,35 @@ char Lexer::advance() {
         if (isFloatSuffix) {
             if (inferredType == TokenType::NUMBER) {
                 advance(); // Consume f/F
-                return {TokenType::ERROR, "Invalid suffix 'f'/'F' on integer literal", startLine, startColumn};
+                return makeToken(TokenType::ERROR, start, "Invalid suffix 'f'/'F' on integer literal");
             }
-            lexeme += advance(); // Consume suffix
+            advance(); // Consume suffix
             inferredType = TokenType::FLOAT_LITERAL;
             // Check for subsequent invalid suffixes
             if (peek() == 'l' || peek() == 'L' || peek() == 'u' || peek() == 'U') {
                 advance();
-                return {TokenType::ERROR, "Invalid suffix after 'f'/'F'", startLine, startColumn};
+                return makeToken(TokenType::ERROR, start, "Invalid suffix after 'f'/'F'");
             }
         } else if (isLongSuffix || isUnsignedSuffix) {
             if (inferredType == TokenType::FLOAT_LITERAL || inferredType == TokenType::DOUBLE_LITERAL) {
                 advance(); // Consume l/L/u/U
-                return {TokenType::ERROR, "Invalid suffix (l/L/u/U) on floating-point literal", startLine, startColumn};
+                return makeToken(TokenType::ERROR, start, "Invalid suffix (l/L/u/U) on floating-point literal");
             }
             // Consume the suffix sequence robustly (simplified)
-            std::string suffixCombo = "";
             bool firstL = false, secondL = false, firstU = false;
              while (true) {
                   char currentSuffix = peek();
                   if ((currentSuffix == 'l' || currentSuffix == 'L') && !secondL) {
                       if (!firstL) firstL = true;
                       else secondL = true;
-                      suffixCombo += advance();
+                      advance();
                   } else if ((currentSuffix == 'u' || currentSuffix == 'U') && !firstU) {
                       firstU = true;
-                      suffixCombo += advance();
+                      advance();
             } else {
                       break; 
                   }
              }
-            lexeme += suffixCombo;
             inferredType = TokenType::NUMBER; // Still integer type conceptually
         }
 
@@ -562,118 +736,110 @@ char Lexer::advance() {
         // Final check for progress to prevent infinite loops
         if (current == startPos) {
             if (!isEnd()) advance(); 
-            return {TokenType::ERROR, "Number parsing failed to advance", startLine, startColumn};
+            return makeToken(TokenType::ERROR, start, "Number parsing failed to advance");
         }
 
-        return {inferredType, lexeme, startLine, startColumn};
+        return makeToken(inferredType, start, lexemeFrom(start));
     }
 
 
 
     // Các hàm phụ trợ    
-    void Lexer::consumeDigits(std::string& lexeme) {
+    void Lexer::consumeDigits() {
         while (isdigit(peek()) || (peek() == '\'' && isdigit(peekNext()))) {
-            lexeme += advance();
+            advance();
         }
     }
     
-    void Lexer::consumeHexDigits(std::string& lexeme) {
+    void Lexer::consumeHexDigits() {
         while (isxdigit(peek()) || (peek() == '\'' && isxdigit(peekNext()))) {
-            lexeme += advance();
+            advance();
         }
     }
     
-    bool Lexer::consumeBinaryDigits(std::string& lexeme) {
+    bool Lexer::consumeBinaryDigits() {
         bool hasDigits = false;
         while ((peek() == '0' || peek() == '1') || 
                (peek() == '\'' && (peekNext() == '0' || peekNext() == '1'))) {
             hasDigits = true;
-            lexeme += advance();
+            advance();
         }
         return hasDigits;
     }
     
-    bool Lexer::consumeOctalDigits(std::string& lexeme) {
+    bool Lexer::consumeOctalDigits() {
         bool hasDigits = false;
         while ((peek() >= '0' && peek() <= '7') || 
                (peek() == '\'' && peekNext() >= '0' && peekNext() <= '7')) {
             hasDigits = true;
-            lexeme += advance();
+            advance();
         }
         return hasDigits;
     }
     
-    void Lexer::handleExponent(std::string& lexeme, bool isHexFloat) {
+    bool Lexer::handleExponent(bool isHexFloat) {
         char expChar = isHexFloat ? 'p' : 'e';
         char expCharUpper = isHexFloat ? 'P' : 'E';
         
         if ((peek() == expChar || peek() == expCharUpper) && 
             (isdigit(peekNext()) || peekNext() == '+' || peekNext() == '-' || 
              (peekNext() == '\'' && isdigit(peekNextNext())))) {
-            lexeme += advance();  // Tiêu thụ e/E hoặc p/P
+            advance();  // Tiêu thụ e/E hoặc p/P
             
             // Xử lý dấu sau e/p
             if (peek() == '+' || peek() == '-') {
-                lexeme += advance();
+                advance();
             }
             
             // Phải có ít nhất một chữ số sau e/p
             bool hasExponentDigits = false;
             while (isdigit(peek()) || (peek() == '\'' && isdigit(peekNext()))) {
                 hasExponentDigits = true;
-                lexeme += advance();
-            }
-            
-            // Nếu không có chữ số sau e/p, quay lại trạng thái trước đó
-            if (!hasExponentDigits) {
-                size_t lastExpPos = lexeme.find_last_of(isHexFloat ? "pP" : "eE");
-                if (lastExpPos != std::string::npos) {
-                    lexeme = lexeme.substr(0, lastExpPos);
-                }
+                advance();
             }
+            return hasExponentDigits;
         }
+        return false;
     }
     
-    void Lexer::handleTypeSuffix(std::string& lexeme) {
+    void Lexer::handleTypeSuffix() {
         // Float/double suffixes (f, F)
         if (peek() == 'f' || peek() == 'F') {
-            lexeme += advance();
+            advance();
         } 
         // Long/Long Long suffixes (l, L, ll, LL)
         else if (peek() == 'l' || peek() == 'L') {
-            lexeme += advance();
+            advance();
             
             // Kiểm tra "long long" (ll, LL)
             if (peek() == 'l' || peek() == 'L') {
-                lexeme += advance();
+                advance();
             }
             
             // Hậu tố unsigned sau long/long long (ul, uL, Ul, UL, ull, uLL, etc.)
             if (peek() == 'u' || peek() == 'U') {
-                lexeme += advance();
+                advance();
             }
         }
         // Unsigned suffixes (u, U) 
         else if (peek() == 'u' || peek() == 'U') {
-            lexeme += advance();
+            advance();
             
             // Long/long long sau unsigned (ul, uL, ull, uLL)
             if (peek() == 'l' || peek() == 'L') {
-                lexeme += advance();
+                advance();
                 
                 // Second l/L for long long
                 if (peek() == 'l' || peek() == 'L') {
-                    lexeme += advance();
+                    advance();
                 }
             }
         }
     }
     
-    Token Lexer::handleSpecialNumber(std::string& lexeme, int startColumn) {
-        // lexeme already contains "0"
-        int startLine = line;
+    Token Lexer::handleSpecialNumber(size_t start) {
+        // source[start, current) already holds the optional sign and "0"
         char prefix = advance(); // Consume x, b, or o
-        lexeme += prefix;
         TokenType type = TokenType::NUMBER; // Default
         bool hasDecimalPoint = false;
         bool hasExponent = false;
@@ -681,9 +847,9 @@ char Lexer::advance() {
         
         if (prefix == 'x' || prefix == 'X') {
             // Hex Floats (e.g., 0x1.Ap+3) or Hex Ints (e.g., 0xFF)
-            std::string beforeDigits = lexeme;
-            consumeHexDigits(lexeme);
-            bool hasMantissaDigits = (lexeme.size() > beforeDigits.size());
+            size_t digitsStart = current;
+            consumeHexDigits();
+            bool hasMantissaDigits = (current > digitsStart);
             
             if (peek() == '.') {
                 // Check if digits followed the dot
@@ -691,24 +857,24 @@ char Lexer::advance() {
                 if (isxdigit(nextAfterDot)) {
                      hasDecimalPoint = true;
                      type = TokenType::DOUBLE_LITERAL;
-                     lexeme += advance(); // consume dot
-                     std::string beforeFraction = lexeme;
-                consumeHexDigits(lexeme);
-                     hasMantissaDigits = hasMantissaDigits || (lexeme.size() > beforeFraction.size());
+                     advance(); // consume dot
+                     size_t fractionStart = current;
+                consumeHexDigits();
+                     hasMantissaDigits = hasMantissaDigits || (current > fractionStart);
                 } else if (hasMantissaDigits) {
                      // Digits before dot, but not after (e.g., 0xFF.) - treat as double
                      hasDecimalPoint = true;
                      type = TokenType::DOUBLE_LITERAL;
-                     lexeme += advance(); // consume dot
+                     advance(); // consume dot
                 } else {
                      // 0x. - Invalid
                      advance(); // Consume dot
-                     return {TokenType::ERROR, "Invalid hex literal (0x.)", startLine, startColumn};
+                     return makeToken(TokenType::ERROR, start, "Invalid hex literal (0x.)");
                 }
             }
 
             if (!hasMantissaDigits) {
-                 return {TokenType::ERROR, "Invalid hex literal (missing digits)", startLine, startColumn};
+                 return makeToken(TokenType::ERROR, start, "Invalid hex literal (missing digits)");
             }
             
             // Hex exponent (p/P)
@@ -716,16 +882,14 @@ char Lexer::advance() {
                  char next = peekNext();
                  if (isdigit(next) || ((next == '+' || next == '-') && isdigit(peekNextNext()))) {
                       if (type == TokenType::NUMBER) type = TokenType::DOUBLE_LITERAL; // Becomes double
-                      std::string beforeExp = lexeme;
-                      handleExponent(lexeme, true); // true = hex float exponent
-                      if (lexeme == beforeExp) {
-                           return {TokenType::ERROR, "Invalid hex exponent format (missing digits)", startLine, startColumn};
+                      if (!handleExponent(true)) { // true = hex float exponent
+                           return makeToken(TokenType::ERROR, start, "Invalid hex exponent format (missing digits)");
                       }
                       hasExponent = true;
                  } else {
                       // p/P not followed by valid exponent - error or treat p as identifier?
                       // Let's error for now, as p is required for hex float exponent
-                      return {TokenType::ERROR, "Invalid hex exponent (missing digits or sign)", startLine, startColumn};
+                      return makeToken(TokenType::ERROR, start, "Invalid hex exponent (missing digits or sign)");
             }
         }
             
@@ -742,88 +906,87 @@ char Lexer::advance() {
              if (isFloatSuffix) {
                  if (type == TokenType::NUMBER) {
                      advance();
-                     return {TokenType::ERROR, "Invalid suffix 'f'/'F' on hex integer literal", startLine, startColumn};
+                     return makeToken(TokenType::ERROR, start, "Invalid suffix 'f'/'F' on hex integer literal");
                  }
-                 lexeme += advance();
+                 advance();
                  type = TokenType::FLOAT_LITERAL;
                   if (peek() == 'l' || peek() == 'L' || peek() == 'u' || peek() == 'U') {
                       advance();
-                     return {TokenType::ERROR, "Invalid suffix after 'f'/'F'", startLine, startColumn};
+                     return makeToken(TokenType::ERROR, start, "Invalid suffix after 'f'/'F'");
                  }
              } else if (isIntSuffix) {
                   if (type == TokenType::FLOAT_LITERAL || type == TokenType::DOUBLE_LITERAL) {
                        advance();
-                       return {TokenType::ERROR, "Invalid suffix (l/L/u/U) on hex float literal", startLine, startColumn};
+                       return makeToken(TokenType::ERROR, start, "Invalid suffix (l/L/u/U) on hex float literal");
                   }
                   // Consume integer suffixes robustly (simplified)
-                  std::string suffixCombo = "";
                   // ... (Add robust suffix consumption similar to Number()) ...
                   while(isalnum(peek())) { // Simplistic consumption - needs refinement for order (U before L)
                        char s = peek();
                        if (s == 'l' || s == 'L' || s == 'u' || s == 'U') {
-                            suffixCombo += advance(); 
+                            advance(); 
                        } else break;
                   }
-                  lexeme += suffixCombo;
                   type = TokenType::NUMBER; 
              }
              
              if (current == startPos) { // Check progress
                  if (!isEnd()) advance();
-                  return {TokenType::ERROR, "Hex number parsing failed to advance", startLine, startColumn};
+                  return makeToken(TokenType::ERROR, start, "Hex number parsing failed to advance");
             }
-             return {type, lexeme, startLine, startColumn};
+             return makeToken(type, start, lexemeFrom(start));
 
         } else if (prefix == 'b' || prefix == 'B') {
             // Binary - Must be integer
-            if (!consumeBinaryDigits(lexeme)) { 
-                 return {TokenType::ERROR, "Invalid binary literal (missing digits)", startLine, startColumn};
+            if (!consumeBinaryDigits()) { 
+                 return makeToken(TokenType::ERROR, start, "Invalid binary literal (missing digits)");
             }
             type = TokenType::NUMBER; 
         } else if (prefix == 'o' || prefix == 'O') {
             // Octal - Must be integer
-             if (!consumeOctalDigits(lexeme)) { 
-                 return {TokenType::ERROR, "Invalid octal literal (missing digits)", startLine, startColumn};
+             if (!consumeOctalDigits()) { 
+                 return makeToken(TokenType::ERROR, start, "Invalid octal literal (missing digits)");
              }
             type = TokenType::NUMBER; 
         } else {
-             return {TokenType::ERROR, "Invalid prefix after '0'", startLine, startColumn};
+             return makeToken(TokenType::ERROR, start, "Invalid prefix after '0'");
         }
         
         // Suffixes for binary/octal (integers only)
         char suffixPeek = peek();
         if (suffixPeek == 'f' || suffixPeek == 'F') {
              advance();
-             return {TokenType::ERROR, "Invalid suffix 'f'/'F' on binary/octal literal", startLine, startColumn};
+             return makeToken(TokenType::ERROR, start, "Invalid suffix 'f'/'F' on binary/octal literal");
         } else if (suffixPeek == 'l' || suffixPeek == 'L' || suffixPeek == 'u' || suffixPeek == 'U'){
              // Consume integer suffixes robustly (simplified)
-              std::string suffixCombo = "";
               // ... (Add robust suffix consumption similar to Number()) ...
               while(isalnum(peek())) { // Simplistic consumption
                    char s = peek();
                    if (s == 'l' || s == 'L' || s == 'u' || s == 'U') {
-                       suffixCombo += advance();
+                       advance();
                    } else break;
               }
-             lexeme += suffixCombo;
         }
         
         if (current == startPos) { // Check progress
              if (!isEnd()) advance();
-             return {TokenType::ERROR, "Special number parsing failed to advance", startLine, startColumn};
+             return makeToken(TokenType::ERROR, start, "Special number parsing failed to advance");
         }
 
-        return {type, lexeme, startLine, startColumn};
+        return makeToken(type, start, lexemeFrom(start));
     }
     
 
     
     
     Token Lexer::string() {
-        int startColumn = column; // Column where the opening " was
-        int startLine = line;
-        std::string lexeme;
+        size_t start = current; // Offset of the opening quote
         advance(); // Consume the opening " that scanToken detected
+        // Strings without escapes view the source directly; the first escape
+        // switches to building an unescaped copy in `unescaped`.
+        size_t contentStart = current;
+        bool hasEscapes = false;
+        std::string& unescaped = stringScratch_; // Reused so escapes don't allocate per string
         
         // Read until the closing double quote
         while (!isEnd() && peek() != '"') {
@@ -831,65 +994,75 @@ char Lexer::advance() {
             
             // Handle escape sequences
             if (c == '\\' && !isEnd()) {
+                if (!hasEscapes) {
+                    unescaped.assign(source, contentStart, current - contentStart);
+                    hasEscapes = true;
+                }
                 advance(); // Consume the backslash
                 if (isEnd()) {
                     // Error: Unterminated escape sequence at end of file
-                    return {TokenType::ERROR, "Unterminated escape sequence at EOF", startLine, startColumn};
+                    return makeToken(TokenType::ERROR, start, "Unterminated escape sequence at EOF");
                 }
                 char escapedChar = advance(); // Consume the character after backslash
                 switch (escapedChar) {
-                    case 'n': lexeme += '\n'; break;
-                    case 't': lexeme += '\t'; break;
-                    case 'r': lexeme += '\r'; break;
-                    case '\\': lexeme += '\\'; break;
-                    case '\"': lexeme += '\"'; break;
+                    case 'n': unescaped += '\n'; break;
+                    case 't': unescaped += '\t'; break;
+                    case 'r': unescaped += '\r'; break;
+                    case '\\': unescaped += '\\'; break;
+                    case '\"': unescaped += '\"'; break;
                     // Add other escapes if needed (e.g., '\0')
                     default:
                         // Optional: Treat unknown escapes as literal backslash + char
-                        // lexeme += '\\';
-                        // lexeme += escapedChar;
+                        // unescaped += '\\';
+                        // unescaped += escapedChar;
                         // OR: Report an error for unknown escape sequences
-                        return {TokenType::ERROR, "Unknown escape sequence: \\" + std::string(1, escapedChar), line, column - 2};
+                        return makeToken(TokenType::ERROR, current - 2, keepText("Unknown escape sequence: \\" + std::string(1, escapedChar)));
                 }
             } else if (c == '\n') {
                  // Error: Newline inside string literal without escaping
                  advance(); // Consume the newline to report error position correctly
-                 return {TokenType::ERROR, "Unterminated string literal (newline encountered)", startLine, startColumn};
+                 return makeToken(TokenType::ERROR, start, "Unterminated string literal (newline encountered)");
             } else {
-                // Regular character
-                lexeme += advance(); // Consume the character
+                // Regular characters: take the whole run up to the next quote,
+                // backslash or newline at once
+                const char* text = source.data();
+                size_t end = scan_.findStringSpecial(text + current + 1, text + source.length()) - text;
+                if (hasEscapes) unescaped.append(source, current, end - current);
+                current = end;
             }
         }
         
         // Check for unterminated string
         if (isEnd()) {
-            return {TokenType::ERROR, "Unterminated string literal", startLine, startColumn};
+            return makeToken(TokenType::ERROR, start, "Unterminated string literal");
         }
         
+        std::string_view lexeme = hasEscapes ? keepText(unescaped) : lexemeFrom(contentStart);
+
         // Consume the closing double quote
         advance();
         
         // Return the STRING token with the processed lexeme (escape sequences interpreted)
-        return {TokenType::STRING, lexeme, startLine, startColumn};
+        return makeToken(TokenType::STRING, start, lexeme);
     }
     
 
     void Lexer::skipWhitespace() {
         while (!isEnd()) {
-            char c = peek();
-            
-            if (c == ' ' || c == '\t' || c == '\r') {
+            switch (charClass(source[current])) {
+            case CharClass::Space: {
                 // Bỏ qua các khoảng trắng thông thường
-                advance();
-            } else if (c == '\n') {
-                // Xử lý ký tự xuống dòng
-                advance();
-                line++;
-                column = 1; // Đặt cột về 1 cho dòng mới
-            } else {
-                // Dừng lại khi gặp ký tự không phải khoảng trắng
+                const char* text = source.data();
+                current = scan_.skipSpaces(text + current + 1, text + source.length()) - text;
                 break;
             }
+            case CharClass::Newline:
+                // Xuống dòng: lines_ đã ghi lại đầu mỗi dòng, chỉ cần bỏ qua
+                current++;
+                break;
+            default:
+                // Dừng lại khi gặp ký tự không phải khoảng trắng
+                return;
+            }
         }
     }
-    
\ No newline at end of file
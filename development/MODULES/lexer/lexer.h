@@ -1,24 +1,64 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
-#include <unordered_map>
 
 // Include the definitions from the common header
 #include "../common/token.h"
+#include "../common/arena.h"
+#include "../common/line_table.h"
+#include "../common/token_stream.h"
+#include "simd_scan.h"
+
+// An edit to a source buffer, in offsets of the text before the edit.
+struct SourceEdit {
+    size_t offset;                // Where the edit starts
+    size_t removedLength;         // Bytes removed at offset
+    std::string_view insertedText; // Bytes inserted in their place
+};
+
+// Result of IncrementalLexer::relex: old tokens [first, oldEnd) were
+// replaced by tokens [first, newEnd); every other token is carried over
+// unchanged (tokens after the edit with their offsets shifted).
+struct RelexResult {
+    size_t first;
+    size_t oldEnd;
+    size_t newEnd;
+};
 
 // Only declare the Lexer class here
-class Lexer{
+class Lexer : public TokenSource {
     private:
-        std::string source;
+        std::string_view source; // Not owned: usually a MappedFile (see main.cpp)
         std::vector<Token> tokens;
         size_t current = 0;
-        int line = 1;
-        int column = 1;
+        // Where the previous scanToken() pass started; seeing it again means
+        // the lexer made no progress. Per instance, so lexers can run in parallel.
+        size_t previousPosition_ = SIZE_MAX;
+        bool exhausted_ = false; // nextToken() hit an exception; only EOF_TOKEN follows
+        // Tokens carry only a byte offset; line/column come from here on demand.
+        // Chunk lexers borrow the table of the Lexer that created them.
+        LineTable ownLines_;
+        const LineTable& lines_;
 
-        //hashmap for the keyword
-        std::unordered_map<std::string, TokenType> keywords;
+        // Holds lexemes that are not verbatim source text: unescaped strings
+        // and formatted error messages. Every other lexeme views `source`.
+        Arena text_;
+        std::string stringScratch_; // Unescaping buffer reused by string()
+        // Identifier ids without the interner's lock on repeats. Chunk lexers
+        // hand out local ids, resolved when scanTokensParallel keeps the token.
+        SymbolCache symbols_;
+        const ScanKernels& scan_;   // Bulk scanning kernels for this CPU (simd_scan.h)
+
+        // --- Chunked lexing (scanTokensParallel) ---
+        bool chunk_ = false;   // Lexes one chunk; `source` ends at the chunk end
+        bool spilled_ = false; // A block comment or style path ran into the chunk end
+        size_t spillFrom_ = 0; // Start of the scanToken() call that spilled
+        std::vector<std::unique_ptr<Lexer>> chunks_; // Own the text_ of chunk lexemes
         
         //methods
         char advance();     // read next char
@@ -27,29 +67,104 @@ class Lexer{
         char peekNextNext();
         bool isEnd();        // check if source is end or not
         bool match(char expected);       //check and read if match
+        std::string_view lexemeFrom(size_t start) const; // source[start, current)
+        std::string_view keepText(const std::string& text); // copy into text_
+        Token makeToken(TokenType type, size_t start, std::string_view lexeme) const;
+        void scanLoop(); // scanToken() until the end of `source` (or a chunk spill)
+
+        // Lexes source[begin, source.size()) with a borrowed line table; offsets
+        // stay those of the whole buffer, which must start at source.data().
+        // A chunk lexer (scanTokensParallel) also stops at spills and keeps
+        // local symbol ids.
+        Lexer(std::string_view source, size_t begin, const LineTable& lines, bool chunk);
+        friend class IncrementalLexer;
 
 
     public:
-    Lexer(const std::string& source);
+    // The lexer views `source` without copying it. Token lexemes point into
+    // that buffer or into this Lexer, so both must outlive the tokens it returns.
+    explicit Lexer(std::string_view source);
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
     std::vector<Token> scanTokens();
+    // Same tokens as scanTokens(), lexed in newline-aligned chunks on up to
+    // threadCount threads (0 = one per core). Small inputs are lexed serially.
+    std::vector<Token> scanTokensParallel(unsigned threadCount = 0);
     Token scanToken();      // scan ONE token
-    void initKeywords();
+    // The tokens of scanTokens(), one per call, lexed on demand (TokenSource).
+    // Only the LineTable is built up front; no token vector is kept.
+    Token nextToken() override;
+    // Resolves Token::offset to a line and column (built once per source)
+    const LineTable& lineTable() const { return lines_; }
 
     //methods
-        Token identifier();     // process identifier and keywords
         Token Number();         //process number
         Token string();         //process string
         Token skipComment();       // skip Comment;
-        Token handleSpecialNumber(std::string& lexeme, int startColumn);
+        Token styleInclude(); // 'style' followed by a <path> or "path"
+        Token handleSpecialNumber(size_t start);
 
-        void consumeDigits(std::string& lexeme);
-        void consumeHexDigits(std::string& lexeme);
-        bool consumeBinaryDigits(std::string& lexeme);
-        bool consumeOctalDigits(std::string& lexeme);
-        void handleExponent(std::string& lexeme, bool isHexFloat);
-        void handleTypeSuffix(std::string& lexeme);
+        void consumeDigits();
+        void consumeHexDigits();
+        bool consumeBinaryDigits();
+        bool consumeOctalDigits();
+        bool handleExponent(bool isHexFloat); // false if no exponent digits followed
+        void handleTypeSuffix();
 
         //hmm
         void skipWhitespace();
 
 };
+
+// --- Incremental re-lexing ---
+// Tokens of a document an editor keeps changing. The constructor lexes it
+// once; each relex() then lexes again only the damaged region around one
+// edit, up to the first token that matches the old stream. Nothing outside
+// that region is rewritten: the tokens are a gap buffer split at the last
+// edit, tokens past the split store offsets relative to one shared shift,
+// and lexemes that are source text are kept as positions rather than views.
+// The line table is patched the same way. An edit far from the previous
+// one first moves the split there, one step per token in between.
+class IncrementalLexer {
+public:
+    // Views source without copying, like Lexer; keep it alive until the next relex()
+    explicit IncrementalLexer(std::string_view source);
+    IncrementalLexer(const IncrementalLexer&) = delete;
+    IncrementalLexer& operator=(const IncrementalLexer&) = delete;
+
+    // source is the text after edit (which is in offsets of the text before
+    // it); the old text may already be gone. Throws std::invalid_argument if
+    // the sizes do not describe this edit.
+    RelexResult relex(std::string_view source, const SourceEdit& edit);
+
+    size_t size() const { return head_.size() + tail_.size(); }
+    // Token index of the current source, as scanTokens() would return it.
+    // The lexeme views the source or this object.
+    Token token(size_t index) const;
+    std::vector<Token> tokens() const;
+    const LineTable& lineTable() const { return lines_; }
+
+private:
+    // A source-text lexeme has text == nullptr and starts lexemeAt (mod 2^32)
+    // bytes after the token; any other lexeme is copied into text_.
+    struct StoredToken {
+        TokenType type;
+        SymbolId symbol : 24;
+        uint32_t offset;
+        uint32_t lexemeAt;
+        uint32_t length;
+        const char* text;
+    };
+
+    std::string_view source_;
+    LineTable lines_;
+    // Lexemes that are not source text, including those of replaced tokens
+    Arena text_;
+    std::vector<StoredToken> head_; // Tokens before the split, in order
+    std::vector<StoredToken> tail_; // Tokens after it, last first, offsets relative to tailShift_
+    uint32_t tailShift_ = 0;        // Added (mod 2^32) to a tail_ offset gives the token's offset
+
+    void moveSplit(uint32_t offset);
+    StoredToken store(const Token& token);
+    Token load(const StoredToken& stored, uint32_t offset) const;
+};
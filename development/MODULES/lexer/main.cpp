@@ -6,10 +6,14 @@
 #include "../common/token.h"
 #include "lexer.h" // Include Lexer class definition
 #include "../common/utils.h" // Include the header for tokenTypeToString declaration
+#include "../common/token_io.h" // Binary token stream writer
+#include "../common/mapped_file.h" // mmap-backed source input
+#include "../common/log.h"
 #include <chrono>
+#include <charconv>
 
 // Helper function to escape strings for output file
-std::string escapeStringForOutput(const std::string& s) {
+std::string escapeStringForOutput(std::string_view s) {
     std::string escaped;
     escaped.reserve(s.length()); // Pre-allocate for potential expansion
     for (char c : s) {
@@ -27,7 +31,7 @@ std::string escapeStringForOutput(const std::string& s) {
 }
 
 // Print token information in a readable format
-void printToken(const Token& token) {
+void printToken(const Token& token, const LineTable& lines) {
     // Use the shared tokenTypeToString from utils.h
     std::string typeStr = tokenTypeToString(token.type);
     
@@ -46,46 +50,118 @@ void printToken(const Token& token) {
          std::cout << "\\\")";
     }
     
-    std::cout << " at line " << token.line << ", column " << token.column << std::endl;
+    SourcePosition pos = lines.position(token.offset);
+    std::cout << " at line " << pos.line << ", column " << pos.column << std::endl;
+}
+
+// Write tokens in the human-readable "TYPE [lexeme] line column" format (--text)
+bool writeTextTokens(const std::string& outputFilename, const std::vector<Token>& tokens,
+                     const LineTable& lines) {
+    std::ofstream outFile(outputFilename);
+    if (!outFile) {
+        return false;
+    }
+
+    // Write tokens to file in the specified format
+    for (const auto& token : tokens) {
+        // Use the shared tokenTypeToString function
+        std::string typeStr = tokenTypeToString(token.type);
+        outFile << typeStr;
+        
+        // Add lexeme if applicable, escaping strings/paths
+        if (token.type == TokenType::IDENTIFIER ||
+            token.type == TokenType::NUMBER ||
+            token.type == TokenType::FLOAT_LITERAL || // Added
+            token.type == TokenType::DOUBLE_LITERAL || // Added
+            token.type == TokenType::STRING ||
+            token.type == TokenType::STYLE_INCLUDE ||
+            token.type == TokenType::ERROR) // Include lexeme for ERROR tokens too
+        {
+             outFile << " ";
+             // Manually escape the lexeme before writing
+             outFile << escapeStringForOutput(token.lexeme); 
+        }
+        
+        SourcePosition pos = lines.position(token.offset);
+        outFile << " " << pos.line << " " << pos.column << std::endl;
+
+        // Stop writing after EOF_TOKEN
+        if (token.type == TokenType::EOF_TOKEN) {
+            break; 
+        }
+    }
+
+    outFile.close();
+    return true;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [input.hanami|-] [output.tokens] [--text] [--threads=N] [--log=level]" << std::endl;
+}
+
+// Reads the N of --threads=N; false unless text is a whole non-negative number
+static bool parseThreadCount(std::string_view text, unsigned& count) {
+    const char* last = text.data() + text.size();
+    auto result = std::from_chars(text.data(), last, count);
+    return !text.empty() && result.ec == std::errc() && result.ptr == last;
 }
 
 int main(int argc, char* argv[]) { 
     std::string inputFilename = "input/input.hanami"; // Default input source file
     std::string outputFilename = "output/output.tokens"; // Default output token file
-
-    if (argc > 1) {
-        inputFilename = std::string(argv[1]);
+    bool textOutput = false; // --text: write the old text format instead of binary
+    unsigned threadCount = 0; // --threads=N: lexing threads for large inputs (0 = one per core)
+
+    // Usage: lexer_executable [input] [output] [--text] [--threads=N] [--log=level]
+    // An input of "-" reads the source from standard input.
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--text") {
+            textOutput = true;
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            if (!parseThreadCount(std::string_view(arg).substr(10), threadCount)) {
+                std::cerr << "Error: Invalid thread count in " << arg << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (applyLogFlag(arg)) {
+            // --log=<level> handled
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() > 0) {
+        inputFilename = positional[0];
+    }
+    if (positional.size() > 1) {
+        outputFilename = positional[1];
     }
-    // Optional: Allow specifying output file via command line
-    // if (argc > 2) {
-    //     outputFilename = std::string(argv[2]);
-    // }
 
     std::cout << "Lexer Module" << std::endl;
     std::cout << "Reading source from: " << inputFilename << std::endl;
 
-    std::ifstream inFile(inputFilename);
-    if (!inFile) {
-        std::cerr << "Error: Could not open input file: " << inputFilename << std::endl;
+    // The source is mapped, not copied: the Lexer and its tokens view these bytes
+    MappedFile sourceFile;
+    try {
+        sourceFile = MappedFile(inputFilename);
+    } catch (const std::exception&) {
+        LOG_ERROR("Error: Could not open input file: " << inputFilename);
         return 1;
     }
-
-    std::stringstream buffer;
-    buffer << inFile.rdbuf();
-    std::string sourceCode = buffer.str();
-    inFile.close();
+    std::string_view sourceCode = sourceFile.view();
 
     if (sourceCode.empty()) {
         std::cout << "Input file is empty. Nothing to tokenize." << std::endl;
-        // Create an empty output file or one with just EOF?
-         std::ofstream outFile(outputFilename);
-         if (!outFile) {
-              std::cerr << "Error: Could not open output file: " << outputFilename << std::endl;
+        // Write just EOF for consistency
+         std::vector<Token> eofOnly = {{TokenType::EOF_TOKEN, 0, ""}};
+         LineTable oneLine;
+         bool written = textOutput ? writeTextTokens(outputFilename, eofOnly, oneLine)
+                                   : writeBinaryTokens(outputFilename, eofOnly, oneLine);
+         if (!written) {
+              LOG_ERROR("Error: Could not open output file: " << outputFilename);
               return 1;
          }
-         // Write just EOF for consistency
-         outFile << tokenTypeToString(TokenType::EOF_TOKEN) << " 1 1" << std::endl; 
-         outFile.close();
          std::cout << "Empty token file written to: " << outputFilename << std::endl;
         return 0;
     }
@@ -100,9 +176,9 @@ int main(int argc, char* argv[]) {
     bool lexSuccessful = true;
 
     try {
-        tokens = lexer.scanTokens(); // Get all tokens
+        tokens = lexer.scanTokensParallel(threadCount); // Get all tokens
     } catch (const std::exception& e) {
-        std::cerr << "An unexpected error occurred during lexing: " << e.what() << std::endl;
+        LOG_ERROR("An unexpected error occurred during lexing: " << e.what());
         // Get the time point just after execution
         auto end_time = std::chrono::steady_clock::now();
 
@@ -113,8 +189,9 @@ int main(int argc, char* argv[]) {
     // Check for errors reported during lexing (ERROR tokens)
     for(const auto& token : tokens) {
         if (token.type == TokenType::ERROR) {
-            std::cerr << "Lexing error encountered: " << token.lexeme 
-                      << " at line " << token.line << ", column " << token.column << std::endl;
+            SourcePosition pos = lexer.lineTable().position(token.offset);
+            LOG_ERROR("Lexing error encountered: " << token.lexeme 
+                      << " at line " << pos.line << ", column " << pos.column);
             lexSuccessful = false;
             
             // Decide whether to stop or continue after first error
@@ -126,16 +203,17 @@ int main(int argc, char* argv[]) {
     }
 
     if (!lexSuccessful) {
-        std::cerr << "Lexing failed due to errors. Token file not generated." << std::endl;
+        LOG_ERROR("Lexing failed due to errors. Token file not generated.");
         return 1;
     }
 
     std::cout << "Lexing completed successfully." << std::endl;
     std::cout << "Writing tokens to: " << outputFilename << std::endl;
 
-    std::ofstream outFile(outputFilename);
-    if (!outFile) {
-        std::cerr << "Error: Could not open output file: " << outputFilename << std::endl;
+    bool written = textOutput ? writeTextTokens(outputFilename, tokens, lexer.lineTable())
+                              : writeBinaryTokens(outputFilename, tokens, lexer.lineTable());
+    if (!written) {
+        LOG_ERROR("Error: Could not open output file: " << outputFilename);
 
         // Get the time point just after execution
         auto end_time = std::chrono::steady_clock::now();
@@ -143,34 +221,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Write tokens to file in the specified format
-    for (const auto& token : tokens) {
-        // Use the shared tokenTypeToString function
-        std::string typeStr = tokenTypeToString(token.type);
-        outFile << typeStr;
-        
-        // Add lexeme if applicable, escaping strings/paths
-        if (token.type == TokenType::IDENTIFIER ||
-            token.type == TokenType::NUMBER ||
-            token.type == TokenType::FLOAT_LITERAL || // Added
-            token.type == TokenType::DOUBLE_LITERAL || // Added
-            token.type == TokenType::STRING ||
-            token.type == TokenType::STYLE_INCLUDE ||
-            token.type == TokenType::ERROR) // Include lexeme for ERROR tokens too
-        {
-             outFile << " ";
-             // Manually escape the lexeme before writing
-             outFile << escapeStringForOutput(token.lexeme); 
-        }
-        
-        outFile << " " << token.line << " " << token.column << std::endl;
-
-        // Stop writing after EOF_TOKEN
-        if (token.type == TokenType::EOF_TOKEN) {
-            break; 
-        }
-    }
-
     // Get the time point just after execution
     auto end_time = std::chrono::steady_clock::now();
 
@@ -179,7 +229,6 @@ int main(int argc, char* argv[]) {
     // Correct way to print the duration in milliseconds:
     auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
 
-    outFile.close();
     std::cout << "Tokens successfully written to " << outputFilename << std::endl;
 
     std::cout<<"Time execution: "<< duration_ms.count() <<" ms"<<'\n';
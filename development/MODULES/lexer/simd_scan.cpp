@@ -0,0 +1,155 @@
+#include "simd_scan.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "char_class.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <immintrin.h>
+#define HANAMI_HAS_X86_SIMD 1
+#endif
+
+// --- Scalar kernels: the fallback everywhere, and the tail of every vector loop ---
+namespace scalar {
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && charClass(*p) == CharClass::Space) ++p;
+    return p;
+}
+
+const char* skipIdentChars(const char* p, const char* end) {
+    while (p < end && isIdentChar(*p)) ++p;
+    return p;
+}
+
+const char* findNewline(const char* p, const char* end) {
+    while (p < end && *p != '\n') ++p;
+    return p;
+}
+
+const char* findStringSpecial(const char* p, const char* end) {
+    while (p < end && *p != '"' && *p != '\\' && *p != '\n') ++p;
+    return p;
+}
+
+const char* findCommentClose(const char* p, const char* end) {
+    for (; end - p >= 2; ++p) {
+        if (p[0] == '*' && p[1] == '/') return p;
+    }
+    return end;
+}
+
+const ScanKernels kernels = {
+    "scalar", skipSpaces, skipIdentChars, findNewline, findStringSpecial, findCommentClose,
+};
+
+} // namespace scalar
+
+#ifdef HANAMI_HAS_X86_SIMD
+
+// --- SSE2: 16 bytes per step (always available on x86-64) ---
+namespace sse2 {
+
+struct Vec {
+    static constexpr ptrdiff_t WIDTH = 16;
+    static constexpr uint32_t FULL_MASK = 0xFFFFu;
+    __m128i reg;
+
+    static Vec load(const char* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+    static Vec splat(char c) { return {_mm_set1_epi8(c)}; }
+    Vec eq(Vec other) const { return {_mm_cmpeq_epi8(reg, other.reg)}; }
+    Vec minu(Vec other) const { return {_mm_min_epu8(reg, other.reg)}; }
+    Vec sub(Vec other) const { return {_mm_sub_epi8(reg, other.reg)}; }
+    Vec operator|(Vec other) const { return {_mm_or_si128(reg, other.reg)}; }
+    Vec operator&(Vec other) const { return {_mm_and_si128(reg, other.reg)}; }
+    uint32_t mask() const { return static_cast<uint32_t>(_mm_movemask_epi8(reg)); }
+};
+
+#include "simd_scan_kernels.inc"
+
+const ScanKernels kernels = {
+    "sse2", skipSpaces, skipIdentChars, findNewline, findStringSpecial, findCommentClose,
+};
+
+} // namespace sse2
+
+// --- AVX2: 32 bytes per step, compiled for AVX2 and only called after a CPU check ---
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace avx2 {
+
+struct Vec {
+    static constexpr ptrdiff_t WIDTH = 32;
+    static constexpr uint32_t FULL_MASK = 0xFFFFFFFFu;
+    __m256i reg;
+
+    static Vec load(const char* p) { return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))}; }
+    static Vec splat(char c) { return {_mm256_set1_epi8(c)}; }
+    Vec eq(Vec other) const { return {_mm256_cmpeq_epi8(reg, other.reg)}; }
+    Vec minu(Vec other) const { return {_mm256_min_epu8(reg, other.reg)}; }
+    Vec sub(Vec other) const { return {_mm256_sub_epi8(reg, other.reg)}; }
+    Vec operator|(Vec other) const { return {_mm256_or_si256(reg, other.reg)}; }
+    Vec operator&(Vec other) const { return {_mm256_and_si256(reg, other.reg)}; }
+    uint32_t mask() const { return static_cast<uint32_t>(_mm256_movemask_epi8(reg)); }
+};
+
+#include "simd_scan_kernels.inc"
+
+} // namespace avx2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+namespace avx2 {
+
+const ScanKernels kernels = {
+    "avx2", skipSpaces, skipIdentChars, findNewline, findStringSpecial, findCommentClose,
+};
+
+} // namespace avx2
+
+#endif // HANAMI_HAS_X86_SIMD
+
+namespace {
+
+bool cpuHasAvx2() {
+#ifdef HANAMI_HAS_X86_SIMD
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+const ScanKernels& bestKernels() {
+#ifdef HANAMI_HAS_X86_SIMD
+    return cpuHasAvx2() ? avx2::kernels : sse2::kernels;
+#else
+    return scalar::kernels;
+#endif
+}
+
+} // namespace
+
+const ScanKernels& scanKernels(const char* name) {
+    if (name && std::strcmp(name, "scalar") == 0) return scalar::kernels;
+#ifdef HANAMI_HAS_X86_SIMD
+    if (name && std::strcmp(name, "sse2") == 0) return sse2::kernels;
+    if (name && std::strcmp(name, "avx2") == 0 && cpuHasAvx2()) return avx2::kernels;
+#endif
+    return bestKernels();
+}
+
+const ScanKernels& scanKernels() {
+    static const ScanKernels& selected = scanKernels(std::getenv("HANAMI_SIMD"));
+    return selected;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+// --- Bulk scanning kernels for the lexer ---
+// Each kernel looks at the bytes in [p, end) and returns a pointer to the first
+// byte that stops the run (or end), testing 16 (SSE2) or 32 (AVX2) bytes per
+// step. None of them reads outside [p, end). The widest set the CPU supports is
+// picked at runtime; HANAMI_SIMD=scalar|sse2|avx2 in the environment forces a
+// narrower one (handy for comparing outputs or benchmarking).
+
+struct ScanKernels {
+    const char* name;
+
+    // First byte that is not ' ', '\t' or '\r'.
+    const char* (*skipSpaces)(const char* p, const char* end);
+    // First byte that is not a letter, digit or '_'.
+    const char* (*skipIdentChars)(const char* p, const char* end);
+    // First '\n'.
+    const char* (*findNewline)(const char* p, const char* end);
+    // First '"', '\\' or '\n' (the bytes that end a plain run in a string literal).
+    const char* (*findStringSpecial)(const char* p, const char* end);
+    // The '*' of the first "*/", or end if there is none.
+    const char* (*findCommentClose)(const char* p, const char* end);
+};
+
+// Kernels for this CPU, chosen on first use.
+const ScanKernels& scanKernels();
+
+// A specific kernel set ("scalar", "sse2" or "avx2"); falls back to the best
+// supported set if the name is unknown or the CPU lacks it.
+const ScanKernels& scanKernels(const char* name);
@@ -8,11 +8,16 @@
 #include <iomanip> // For json pretty printing
 #include <regex>
 #include <chrono>
+#include <algorithm>
 
 #include "parser.h"
 #include "../common/token.h" // Includes Token struct and TokenType enum
 #include "../common/json.hpp" // For JSON serialization
 #include "../common/utils.h" // Include for stringToTokenType
+#include "../common/mapped_file.h" // mmap-backed input
+#include "../common/token_io.h" // Binary and text token stream readers
+#include "../common/ast_binary.h" // Binary AST writer
+#include "../common/log.h"
 
 // Helper function to convert string representation of TokenType back to enum
 // NOTE: This needs to be kept in sync with the TokenType enum in token.h
@@ -51,160 +56,89 @@ TokenType stringToTokenType(const std::string& typeStr) {
 }
 */
 
-// Function to read tokens from the specified file format (simplified)
-std::vector<Token> readTokensFromFile(const std::string& filename) {
-    std::ifstream inFile(filename);
-    if (!inFile) {
+// Read tokens from either token file format. Binary files (the lexer's default)
+// are mapped into `file` and the tokens' lexemes point straight into it; only the
+// Token vector itself is allocated. Text files are read in one pass over the same
+// mapping; only unescaped STRING lexemes are copied, into `text`.
+// `lines` receives the line table that resolves the tokens' offsets.
+std::vector<Token> readTokensFromFile(const std::string& filename, MappedFile& file, Arena& text,
+                                      LineTable& lines) {
+    try {
+        file = MappedFile(filename);
+    } catch (const std::runtime_error&) {
         throw std::runtime_error("Error: Could not open input token file: " + filename);
     }
 
-    std::vector<Token> tokens;
-    std::string line;
-    int currentLineNum = 0;
-
-    while (std::getline(inFile, line)) {
-        currentLineNum++;
-        line.erase(0, line.find_first_not_of(" \t\n\r")); // Trim leading
-        line.erase(line.find_last_not_of(" \t\n\r") + 1); // Trim trailing
-        if (line.empty()) {
-            continue;
-        }
-
-        std::string tokenTypeStr;
-        std::string lexemeStr = "";
-        int tokenLine = 0;
-        int tokenColumn = 0;
-
-        // 1. Find the last space (must exist before column number)
-        size_t lastSpacePos = line.find_last_of(" \t");
-        if (lastSpacePos == std::string::npos) {
-            std::cerr << "Warning [L" << currentLineNum << "]: Malformed token line (no space before line/col?): '" << line << "'" << std::endl;
-            continue;
-        }
-
-        // 2. Extract Column Number
-        try {
-            tokenColumn = std::stoi(line.substr(lastSpacePos + 1));
-        } catch (...) {
-            std::cerr << "Warning [L" << currentLineNum << "]: Malformed token line (invalid column number?): '" << line << "'" << std::endl;
-            continue;
-        }
-
-        // 3. Find the second-to-last space (must exist before line number)
-        size_t secondLastSpacePos = line.find_last_of(" \t", lastSpacePos - 1);
-        if (secondLastSpacePos == std::string::npos) {
-            std::cerr << "Warning [L" << currentLineNum << "]: Malformed token line (no space before line number?): '" << line << "'" << std::endl;
-                continue;
-            }
-
-        // 4. Extract Line Number
-        try {
-            tokenLine = std::stoi(line.substr(secondLastSpacePos + 1, lastSpacePos - (secondLastSpacePos + 1)));
-        } catch (...) {
-            std::cerr << "Warning [L" << currentLineNum << "]: Malformed token line (invalid line number?): '" << line << "'" << std::endl;
-            continue;
-        }
-
-        // 5. Extract Token Type and Potential Lexeme
-        TokenType currentType; // Declare outside if/else
-        size_t firstSpacePos = line.find_first_of(" \\t");
-        if (firstSpacePos == std::string::npos || firstSpacePos >= secondLastSpacePos) {
-            // No space between type and line number -> No lexeme
-            tokenTypeStr = line.substr(0, secondLastSpacePos + 1);
-            tokenTypeStr.erase(tokenTypeStr.find_last_not_of(" \\t") + 1); // Trim trailing spaces
-            lexemeStr = "";
-            currentType = stringToTokenType(tokenTypeStr); // Assign type here too
-        } else {
-            // Space found -> Assume Type is before first space, Lexeme is between first and second-to-last space
-            tokenTypeStr = line.substr(0, firstSpacePos);
-            lexemeStr = line.substr(firstSpacePos + 1, secondLastSpacePos - firstSpacePos); // Original length calculation
-            
-            // Trim BOTH leading and trailing whitespace unconditionally first
-            while (!lexemeStr.empty() && std::isspace(lexemeStr.front())) {
-                lexemeStr.erase(0, 1); // Remove leading space
-            }
-            while (!lexemeStr.empty() && std::isspace(lexemeStr.back())) {
-                lexemeStr.pop_back(); // Remove trailing space
-            }
-            
-            // Convert string to TokenType enum
-            currentType = stringToTokenType(tokenTypeStr);
-            
-            // Unescape ONLY if it's a string literal
-            if (currentType == TokenType::STRING) {
-                 std::string temp_lexeme;
-                 temp_lexeme.reserve(lexemeStr.length());
-                 for(size_t i = 0; i < lexemeStr.length(); ++i){
-                     if(lexemeStr[i] == '\\' && i + 1 < lexemeStr.length()){
-                         char nextChar = lexemeStr[++i]; // Consume slash, get next char
-                         switch (nextChar) {
-                             case '\"': temp_lexeme += '\"'; break;
-                             case '\\': temp_lexeme += '\\'; break;
-                             case 'n': temp_lexeme += '\n'; break;
-                             case 'r': temp_lexeme += '\r'; break;
-                             case 't': temp_lexeme += '\t'; break;
-                             default: // Not a known escape, keep backslash and char
-                                 temp_lexeme += '\\';
-                                 temp_lexeme += nextChar;
-                                 break;
-                         }
-                     } else {
-                         temp_lexeme += lexemeStr[i];
-                     }
-                 }
-                 lexemeStr = temp_lexeme;
-            }
-        }
-
-        // 6. Add Token (Use already converted type)
-        tokens.push_back({currentType, lexemeStr, tokenLine, tokenColumn});
+    if (!isBinaryTokenFile(file.data(), file.size())) {
+        return readTextTokens(file.data(), file.size(), text, lines);
     }
 
-    inFile.close();
+    BinaryTokenReader reader(file.data(), file.size());
+    std::vector<Token> tokens;
+    tokens.reserve(reader.size());
+    for (size_t i = 0; i < reader.size(); ++i) {
+        tokens.push_back(reader[i]);
+    }
+    lines = reader.lineTable();
     return tokens;
 }
 
 int main(int argc, char* argv[]) {
     std::string inputFilename = "input/input.tokens"; // Default input file
     std::string outputFilename = "output/output.ast"; // Default output file
-
-    if (argc > 1) {
-        inputFilename = std::string(argv[1]);
+    bool jsonOutput = false; // --json: write a pretty-printed JSON dump instead of binary
+
+    // Usage: parser_executable [input] [output] [--json] [--log=level]
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            jsonOutput = true;
+        } else if (applyLogFlag(arg)) {
+            // --log=<level> handled
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() > 0) {
+        inputFilename = positional[0];
     }
-    if (argc > 2) {
-        outputFilename = std::string(argv[2]);
+    if (positional.size() > 1) {
+        outputFilename = positional[1];
     }
 
     std::cout << "Parser Module" << std::endl;
     std::cout << "Reading tokens from: " << inputFilename << std::endl;
 
+    MappedFile tokenFile; // Backs the lexemes of binary token files
+    Arena tokenText;      // Backs the lexemes of text token files
+    LineTable sourceLines; // Resolves token offsets to line/column in diagnostics
     std::vector<Token> tokens;
     try {
-        tokens = readTokensFromFile(inputFilename);
+        tokens = readTokensFromFile(inputFilename, tokenFile, tokenText, sourceLines);
         
         // Optional: Print tokens read for verification
         // std::cout << "--- Tokens Read ---" << std::endl;
         // for (const auto& token : tokens) {
-        //     std::cout << static_cast<int>(token.type) << " (" << token.lexeme << ") L" << token.line << " C" << token.column << std::endl;
+        //     std::cout << static_cast<int>(token.type) << " (" << token.lexeme << ") @" << token.offset << std::endl;
         // }
         // std::cout << "-------------------" << std::endl;
 
     } catch (const std::exception& e) {
-        std::cerr << "Error reading tokens: " << e.what() << std::endl;
+        LOG_ERROR("Error reading tokens: " << e.what());
         return 1;
     }
 
     if (tokens.empty()) {
-        std::cerr << "Error: No tokens were read from the input file." << std::endl;
+        LOG_ERROR("Error: No tokens were read from the input file.");
         return 1;
     }
 
     // Add EOF if missing (parser expects it)
      if (tokens.back().type != TokenType::EOF_TOKEN) {
-         std::cerr << "Warning: Adding missing EOF_TOKEN to token stream." << std::endl;
-         int lastLine = tokens.empty() ? 1 : tokens.back().line;
-         int lastCol = tokens.empty() ? 1 : tokens.back().column + 1;
-         tokens.push_back({TokenType::EOF_TOKEN, "", lastLine, lastCol});
+         LOG_WARN("Warning: Adding missing EOF_TOKEN to token stream.");
+         uint32_t lastOffset = tokens.empty() ? 0 : tokens.back().offset + 1;
+         tokens.push_back({TokenType::EOF_TOKEN, lastOffset, ""});
      }
 
     std::cout << "Parsing token stream..." << std::endl;
@@ -212,15 +146,16 @@ int main(int argc, char* argv[]) {
     //start_time
     auto start_time = std::chrono::steady_clock::now();
      
-    Parser parser(tokens);
-    std::unique_ptr<ProgramNode> astRoot = nullptr;
+    Arena astArena; // Owns every node and string of the AST; freed in one go at exit
+    Parser parser(tokens, sourceLines, astArena);
+    NodePtr<ProgramNode> astRoot = nullptr;
     bool parseErrorOccurred = false; // Flag to track if any ParseError was caught
 
     try {
         astRoot = parser.parse();
     } catch (const ParseError& e) {
         // Parser::error already printed details
-        std::cerr << "Parsing failed due to syntax errors." << std::endl;
+        LOG_ERROR("Parsing failed due to syntax errors.");
 
         //end time
         auto end_time = std::chrono::steady_clock::now();
@@ -229,7 +164,7 @@ int main(int argc, char* argv[]) {
         // Continue to allow partial output if desired, or return here
          // return 1; // Exit after first parse error - Keep commented to allow seeing multiple errors
     } catch (const std::exception& e) {
-        std::cerr << "An unexpected error occurred during parsing: " << e.what() << std::endl;
+        LOG_ERROR("An unexpected error occurred during parsing: " << e.what());
 
         //end time
         auto end_time = std::chrono::steady_clock::now();
@@ -238,7 +173,7 @@ int main(int argc, char* argv[]) {
     }
 
     if (!astRoot && !parseErrorOccurred) { // Check if root is null AND no parse error happened
-        std::cerr << "Error: Parsing resulted in a null AST root without reporting specific parse errors." << std::endl;
+        LOG_ERROR("Error: Parsing resulted in a null AST root without reporting specific parse errors.");
 
         //end time
         auto end_time = std::chrono::steady_clock::now();
@@ -248,15 +183,23 @@ int main(int argc, char* argv[]) {
     
     if (!parseErrorOccurred && astRoot) { // Check the flag AND if astRoot is valid
         std::cout << "Parsing completed successfully." << std::endl;
+        std::cout << "AST arena: " << astArena.bytesUsed() << " bytes used in "
+                  << astArena.blockCount() << " block(s)" << std::endl;
         std::cout << "Writing AST to: " << outputFilename << std::endl;
     
-        // Serialize AST to JSON
-        nlohmann::json astJson = astRoot->toJson();
-    
-        // Write JSON to output file
-        std::ofstream outFile(outputFilename);
-        if (!outFile) {
-            std::cerr << "Error: Could not open output AST file: " << outputFilename << std::endl;
+        bool written = false;
+        if (jsonOutput) {
+            // Serialize AST to JSON and write it pretty-printed
+            std::ofstream outFile(outputFilename);
+            if (outFile) {
+                outFile << std::setw(4) << astRoot->toJson() << std::endl;
+                written = static_cast<bool>(outFile);
+            }
+        } else {
+            written = writeBinaryAst(outputFilename, *astRoot);
+        }
+        if (!written) {
+            LOG_ERROR("Error: Could not open output AST file: " << outputFilename);
 
         //end time
         auto end_time = std::chrono::steady_clock::now();
@@ -264,10 +207,6 @@ int main(int argc, char* argv[]) {
             return 1;
         }
     
-        // Write pretty-printed JSON
-        outFile << std::setw(4) << astJson << std::endl;
-        outFile.close();
-    
         std::cout << "AST successfully written to " << outputFilename << std::endl;
     } else {
          std::cout << "Parsing finished with errors. AST was not generated or is incomplete." << std::endl;
@@ -1,44 +1,58 @@
 #include "parser.h"
+#include <array>
 #include <vector>
 #include <stdexcept>
+#include "../common/log.h"
+#include "../common/numeric_literal.h"
 
 // --- Error Handling --- 
 
 void Parser::error(const Token& token, const std::string& message) {
-    std::cerr << "[Line " << token.line << ", Col " << token.column << "] Error";
-
-    if (token.type == TokenType::EOF_TOKEN) {
-        std::cerr << " at end";
-    } else {
-        // Optionally include the problematic lexeme for context
-         std::cerr << " at '" << token.lexeme << "'";
-    }
-
-    std::cerr << ": " << message << std::endl;
+    // Optionally include the problematic lexeme for context
+    SourcePosition pos = lines_.position(token.offset);
+    LOG_ERROR("[Line " << pos.line << ", Col " << pos.column << "] Error"
+              << (token.type == TokenType::EOF_TOKEN ? std::string(" at end") : " at '" + std::string(token.lexeme) + "'")
+              << ": " << message);
     // Throw an exception to unwind the parsing stack. 
     // This allows the caller (like main.cpp) to catch it.
     throw ParseError(message); 
 }
 
+Parser::NestingGuard::NestingGuard(Parser& parser, size_t& depth, const char* kind) : depth_(depth) {
+    if (depth_ >= MAX_NESTING_DEPTH) {
+        parser.error(parser.peek(), std::string(kind) + " nesting too deep (limit is " +
+                                    std::to_string(MAX_NESTING_DEPTH) + " levels).");
+    }
+    ++depth_;
+}
+
 // Basic error recovery: advance until a likely statement boundary
 // void Parser::synchronize() { ... } // Can optionally remove or comment out this entire function if not used
 
 // --- Helper Methods --- 
 
-Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
+Parser::Parser(const std::vector<Token>& tokens, const LineTable& lines, Arena& arena)
+    : lines_(lines), arena_(arena), stream_(tokens) {}
+
+Parser::Parser(TokenSource& source, const LineTable& lines, Arena& arena)
+    : lines_(lines), arena_(arena), stream_(source) {}
 
 const Token& Parser::peek() const {
-    return tokens[current];
+    return stream_.peek();
+}
+
+const Token& Parser::peekAhead(size_t ahead) const {
+    return stream_.peek(ahead);
 }
 
 const Token& Parser::previous() const {
     // Ensure current > 0 before accessing previous
-    if (current == 0) {
+    if (stream_.position() == 0) {
          // This case should ideally not happen in normal flow after an advance()
          // Handle appropriately, maybe return the first token or throw an error
          throw std::out_of_range("Cannot get previous token at the beginning.");
     }
-    return tokens[current - 1];
+    return stream_.previous();
 }
 
 bool Parser::isAtEnd() const {
@@ -46,9 +60,9 @@ bool Parser::isAtEnd() const {
     return peek().type == TokenType::EOF_TOKEN;
 }
 
-Token Parser::advance() {
+const Token& Parser::advance() {
     if (!isAtEnd()) {
-        current++;
+        stream_.advance();
     }
     return previous();
 }
@@ -59,21 +73,29 @@ bool Parser::check(TokenType type) const {
     return peek().type == type;
 }
 
-// Checks if the current token matches any of the given types.
-// If it matches, consumes the token and returns true.
-bool Parser::match(const std::vector<TokenType>& types) {
-    for (TokenType type : types) {
-        if (check(type)) {
-            advance();
-            return true;
-        }
-    }
-    return false;
+// Checks if the current token is any of the given types without consuming it.
+bool Parser::check(TokenTypeSet types) const {
+    if (isAtEnd()) return false;
+    return types.contains(peek().type);
+}
+
+// Consumes the current token and returns true if it is of the given type.
+bool Parser::match(TokenType type) {
+    if (!check(type)) return false;
+    advance();
+    return true;
+}
+
+// Consumes the current token and returns true if it is any of the given types.
+bool Parser::match(TokenTypeSet types) {
+    if (!check(types)) return false;
+    advance();
+    return true;
 }
 
 // Consumes the current token if it matches the expected type.
 // Throws an error if it doesn't match.
-Token Parser::consume(TokenType type, const std::string& message) {
+const Token& Parser::consume(TokenType type, const std::string& message) {
     if (check(type)) {
         return advance();
     }
@@ -85,41 +107,52 @@ Token Parser::consume(TokenType type, const std::string& message) {
 
 // --- Main Parsing Logic --- 
 
-std::unique_ptr<ProgramNode> Parser::parse() {
-    auto program = std::make_unique<ProgramNode>();
+NodePtr<ProgramNode> Parser::parse() {
+    ArenaScope scope(arena_); // Every node and string below is allocated from arena_
+    auto program = makeNode<ProgramNode>();
+    while (parseNext(*program)) {
+    }
+    return program;
+}
+
+Statement* Parser::parseNext(ProgramNode& program) {
+    ArenaScope scope(arena_);
     while (!isAtEnd()) {
         try {
-             std::cerr << "DEBUG: Parser::parse() loop, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\n";
+             LOG_TRACE("Parser::parse() loop, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
              auto declaration = parseDeclaration();
              if (declaration) {
-                 std::cerr << "DEBUG: Adding statement of type '" << declaration->toJson()["node_type"].get<std::string>() << "' to ProgramNode.\n";
-                 program->statements.push_back(std::move(declaration));
+                 LOG_DEBUG("Adding statement of type '" << declaration->kindName() << "' to ProgramNode.");
+                 Statement* added = declaration.get();
+                 program.statements.push_back(std::move(declaration));
+                 return added;
              } else {
-                 std::cerr << "WARN: parseDeclaration() returned nullptr! Skipping token: " << tokenTypeToString(peek().type) << "\n";
+                 LOG_WARN("WARN: parseDeclaration() returned nullptr! Skipping token: " << tokenTypeToString(peek().type));
                  if (!isAtEnd()) advance(); // Avoid infinite loop if parseDeclaration fails
              }
         } catch (const ParseError& e) {
-             std::cerr << "DEBUG: Caught ParseError in main loop, re-throwing...\\n";
+             LOG_DEBUG("Caught ParseError in main loop, re-throwing...");
              // synchronize(); // Remove synchronization
              throw; // Re-throw the caught exception
         }
     }
-    return program;
+    return nullptr;
 }
 
 // --- Grammar Rule Parsers --- 
 
 // declaration -> styleInclude | gardenDeclaration | speciesDeclaration | functionDefinition | variableDeclaration | statement ;
-std::unique_ptr<Statement> Parser::parseDeclaration() {
+NodePtr<Statement> Parser::parseDeclaration() {
+    NestingGuard nesting(*this, statementDepth_, "Statement"); // Species bodies nest declarations
     // Check for STYLE_INCLUDE directly as the lexer now provides it
     if (check(TokenType::STYLE_INCLUDE)) {
         Token pathToken = consume(TokenType::STYLE_INCLUDE, "Internal error: checked STYLE_INCLUDE but failed to consume.");
-        match({TokenType::SEMICOLON}); // Optional semicolon
-        return std::make_unique<StyleIncludeStmt>(pathToken.lexeme);
+        match(TokenType::SEMICOLON); // Optional semicolon
+        return makeNode<StyleIncludeStmt>(pathToken.lexeme);
     }
-    if (match({TokenType::GARDEN})) return parseGardenDeclaration();
-    if (match({TokenType::SPECIES})) return parseSpeciesDeclaration();
-    if (match({TokenType::GROW})) return parseFunctionDefinition();
+    if (match(TokenType::GARDEN)) return parseGardenDeclaration();
+    if (match(TokenType::SPECIES)) return parseSpeciesDeclaration();
+    if (match(TokenType::GROW)) return parseFunctionDefinition();
     // Variable declarations start with a type (IDENTIFIER)
     // This requires lookahead or careful handling in parseStatement
     // For simplicity, let's parse potential var decls within parseStatement
@@ -128,17 +161,17 @@ std::unique_ptr<Statement> Parser::parseDeclaration() {
 }
 
 // statement -> exprStmt | branchStmt | ioStmt | returnStmt | blockStmt ;
-std::unique_ptr<Statement> Parser::parseStatement() {
-    if (match({TokenType::LEFT_BRACE})) return parseBlock();
-    if (match({TokenType::BRANCH})) return parseBranchStatement();
-    if (match({TokenType::BLOOM, TokenType::WATER})) {
+NodePtr<Statement> Parser::parseStatement() {
+    if (match(TokenType::LEFT_BRACE)) return parseBlock();
+    if (match(TokenType::BRANCH)) return parseBranchStatement();
+    if (match(TokenTypeSet{TokenType::BLOOM, TokenType::WATER})) {
         return parseIOStatement(previous().type); // Pass BLOOM or WATER
     }
-    if (match({TokenType::BLOSSOM})) return parseReturnStatement();
-    if (match({TokenType::WHILE})) {
+    if (match(TokenType::BLOSSOM)) return parseReturnStatement();
+    if (match(TokenType::WHILE)) {
         return parseWhileStatement();
     }
-    if (match({TokenType::FOR})) {
+    if (match(TokenType::FOR)) {
         return parseForStatement();
     }
 
@@ -147,42 +180,42 @@ std::unique_ptr<Statement> Parser::parseStatement() {
 }
 
 // gardenDeclaration -> GARDEN IDENTIFIER SEMICOLON? ;
-std::unique_ptr<Statement> Parser::parseGardenDeclaration() {
+NodePtr<Statement> Parser::parseGardenDeclaration() {
     // 'garden' token was already consumed
     Token name = consume(TokenType::IDENTIFIER, "Expect garden name.");
     // Semicolon is optional
-    match({TokenType::SEMICOLON}); 
-    return std::make_unique<GardenDeclStmt>(name.lexeme);
+    match(TokenType::SEMICOLON); 
+    return makeNode<GardenDeclStmt>(symbolOf(name));
 }
 
 // speciesDeclaration -> SPECIES IDENTIFIER LEFT_BRACE (visibilityBlock)* RIGHT_BRACE SEMICOLON? ;
-std::unique_ptr<Statement> Parser::parseSpeciesDeclaration() {
+NodePtr<Statement> Parser::parseSpeciesDeclaration() {
     // 'species' token consumed
     Token name = consume(TokenType::IDENTIFIER, "Expect species name.");
     consume(TokenType::LEFT_BRACE, "Expect '{' before species body.");
 
-    auto speciesDecl = std::make_unique<SpeciesDeclStmt>(name.lexeme);
+    auto speciesDecl = makeNode<SpeciesDeclStmt>(symbolOf(name));
 
     while (!check(TokenType::RIGHT_BRACE) && !isAtEnd()) {
         speciesDecl->sections.push_back(parseVisibilityBlock());
     }
 
     consume(TokenType::RIGHT_BRACE, "Expect '}' after species body.");
-    match({TokenType::SEMICOLON}); // Optional semicolon
+    match(TokenType::SEMICOLON); // Optional semicolon
 
-    std::cerr << "DEBUG: Returning SpeciesDeclStmt for '" << speciesDecl->name << "' from parseSpeciesDeclaration.\n";
+    LOG_DEBUG("Returning SpeciesDeclStmt for '" << speciesDecl->name << "' from parseSpeciesDeclaration.");
     return speciesDecl;
 }
 
 // visibilityBlock -> (OPEN | HIDDEN | GUARDED) SCOPE_RESOLUTION declaration* ;
 // Implicitly ends when next visibility keyword or RIGHT_BRACE is encountered.
-std::unique_ptr<VisibilityBlockStmt> Parser::parseVisibilityBlock() {
+NodePtr<VisibilityBlockStmt> Parser::parseVisibilityBlock() {
      TokenType visibilityType;
-     if (match({TokenType::OPEN})) {
+     if (match(TokenType::OPEN)) {
          visibilityType = TokenType::OPEN;
-     } else if (match({TokenType::HIDDEN})) {
+     } else if (match(TokenType::HIDDEN)) {
          visibilityType = TokenType::HIDDEN;
-     } else if (match({TokenType::GUARDED})) {
+     } else if (match(TokenType::GUARDED)) {
          visibilityType = TokenType::GUARDED;
      } else {
          // This part might be reached if a declaration starts without visibility keyword,
@@ -190,74 +223,72 @@ std::unique_ptr<VisibilityBlockStmt> Parser::parseVisibilityBlock() {
          // For Hanami, assume visibility keyword is mandatory here.
          error(peek(), "Expect 'open', 'hidden', or 'guarded' to start a visibility block.");
          // Return dummy value after throwing
-         return std::make_unique<VisibilityBlockStmt>(TokenType::ERROR, nullptr);
+         return makeNode<VisibilityBlockStmt>(TokenType::ERROR, nullptr);
      }
 
      consume(TokenType::COLON, "Expect ':' after visibility keyword.");
      
-     auto block = std::make_unique<BlockStmt>();
-     std::cerr << "DEBUG: Entering visibilityBlock loop, checking: " << tokenTypeToString(peek().type) << "\n";
+     auto block = makeNode<BlockStmt>();
+     LOG_TRACE("Entering visibilityBlock loop, checking: " << tokenTypeToString(peek().type));
      // Loop until }, EOF, or next visibility keyword
      while (!isAtEnd()) {
          // *** Check for terminators BEFORE parsing declaration ***
-         if (check(TokenType::RIGHT_BRACE) || 
-             check(TokenType::OPEN) || 
-             check(TokenType::HIDDEN) || 
-             check(TokenType::GUARDED)) {
-             std::cerr << "DEBUG: visibilityBlock loop - Found block end/visibility token: " << tokenTypeToString(peek().type) << ". Breaking loop.\n";
+         if (check(TokenTypeSet{TokenType::RIGHT_BRACE, TokenType::OPEN, TokenType::HIDDEN, TokenType::GUARDED})) {
+             LOG_TRACE("visibilityBlock loop - Found block end/visibility token: " << tokenTypeToString(peek().type) << ". Breaking loop.");
              break; // Exit the loop
          }
          
          // If not a terminator, parse the declaration
-         std::cerr << "DEBUG: visibilityBlock loop iteration, parsing declaration for token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+         LOG_TRACE("visibilityBlock loop iteration, parsing declaration for token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
          block->statements.push_back(parseDeclaration());
-         std::cerr << "DEBUG: visibilityBlock loop after parseDeclaration, next token: " << tokenTypeToString(peek().type) << "\n";
+         LOG_TRACE("visibilityBlock loop after parseDeclaration, next token: " << tokenTypeToString(peek().type));
      }
-     std::cerr << "DEBUG: Exiting visibilityBlock loop naturally, stopped at token: " << tokenTypeToString(peek().type) << "\n";
+     LOG_TRACE("Exiting visibilityBlock loop naturally, stopped at token: " << tokenTypeToString(peek().type));
 
-     return std::make_unique<VisibilityBlockStmt>(visibilityType, std::move(block));
+     return makeNode<VisibilityBlockStmt>(visibilityType, std::move(block));
 }
 
 
 // blockStmt -> LEFT_BRACE declaration* RIGHT_BRACE ;
-std::unique_ptr<BlockStmt> Parser::parseBlock() {
-    std::cerr << "DEBUG: Entering parseBlock(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\\n";
-    auto block = std::make_unique<BlockStmt>();
-    std::cerr << "DEBUG: Entering blockStmt loop, checking: " << tokenTypeToString(peek().type) << "\\n";
+NodePtr<BlockStmt> Parser::parseBlock() {
+    NestingGuard nesting(*this, statementDepth_, "Statement");
+    LOG_TRACE("Entering parseBlock(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
+    auto block = makeNode<BlockStmt>();
+    LOG_TRACE("Entering blockStmt loop, checking: " << tokenTypeToString(peek().type));
     // Loop until } or EOF
     while (!isAtEnd()) {
         // *** Check for terminator BEFORE parsing declaration ***
         if (check(TokenType::RIGHT_BRACE)) {
-            std::cerr << "DEBUG: blockStmt loop - Found RIGHT_BRACE. Breaking loop.\\n";
+            LOG_TRACE("blockStmt loop - Found RIGHT_BRACE. Breaking loop.");
             break; // Exit the loop
         }
 
         // If not }, parse the statement directly
-        std::cerr << "DEBUG: blockStmt loop iteration, parsing statement for token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+        LOG_TRACE("blockStmt loop iteration, parsing statement for token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
         block->statements.push_back(parseStatement()); // Call parseStatement directly
-        std::cerr << "DEBUG: blockStmt loop after parseStatement, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+        LOG_TRACE("blockStmt loop after parseStatement, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
     }
-    std::cerr << "DEBUG: Exiting blockStmt loop naturally, stopped at token: " << tokenTypeToString(peek().type) << "\\n";
+    LOG_TRACE("Exiting blockStmt loop naturally, stopped at token: " << tokenTypeToString(peek().type));
     consume(TokenType::RIGHT_BRACE, "Expect '}' after block.");
-    std::cerr << "DEBUG: Exiting parseBlock() after consuming brace\\n";
+    LOG_TRACE("Exiting parseBlock() after consuming brace");
     return block;
 }
 
 // functionDefinition -> GROW IDENTIFIER LEFT_PAREN parameters? RIGHT_PAREN ARROW IDENTIFIER blockStmt ;
 // parameters -> IDENTIFIER IDENTIFIER ( COMMA IDENTIFIER IDENTIFIER )*
-std::unique_ptr<Statement> Parser::parseFunctionDefinition() {
+NodePtr<Statement> Parser::parseFunctionDefinition() {
     // 'grow' token consumed
     Token name = consume(TokenType::IDENTIFIER, "Expect function name.");
     consume(TokenType::LEFT_PAREN, "Expect '(' after function name.");
 
-    std::vector<Parameter> parameters;
+    ArenaVector<Parameter> parameters;
     if (!check(TokenType::RIGHT_PAREN)) {
         do {
             // Basic parameter parsing: assumes TYPE NAME
             Token paramType = consume(TokenType::IDENTIFIER, "Expect parameter type.");
             Token paramName = consume(TokenType::IDENTIFIER, "Expect parameter name.");
-            parameters.emplace_back(paramType.lexeme, paramName.lexeme);
-        } while (match({TokenType::COMMA}));
+            parameters.emplace_back(symbolOf(paramType), symbolOf(paramName));
+        } while (match(TokenType::COMMA));
     }
     consume(TokenType::RIGHT_PAREN, "Expect ')' after parameters.");
 
@@ -269,7 +300,7 @@ std::unique_ptr<Statement> Parser::parseFunctionDefinition() {
     consume(TokenType::LEFT_BRACE, "Expect '{' before function body.");
     auto body = parseBlock(); // Parse the function body as a block
 
-    auto funcDef = std::make_unique<FunctionDefStmt>(name.lexeme, returnType.lexeme, std::move(body));
+    auto funcDef = makeNode<FunctionDefStmt>(symbolOf(name), symbolOf(returnType), std::move(body));
     funcDef->parameters = std::move(parameters);
     return funcDef;
 }
@@ -277,62 +308,59 @@ std::unique_ptr<Statement> Parser::parseFunctionDefinition() {
 // Variable declaration or expression statement
 // variableDeclaration -> IDENTIFIER IDENTIFIER (ASSIGN expression)? SEMICOLON ;
 // expressionStatement -> expression SEMICOLON ;
-std::unique_ptr<Statement> Parser::parseVariableDeclarationOrExprStmt() {
+NodePtr<Statement> Parser::parseVariableDeclarationOrExprStmt() {
     // Lookahead to differentiate variable declaration from expression statement
     // Declaration: TYPE_IDENTIFIER NAME_IDENTIFIER (ASSIGN | SEMICOLON)
     // Need to handle std::string potential: std :: string name ...
 
     // Check for potential std::string var decl first
     if (check(TokenType::IDENTIFIER) && peek().lexeme == "std" &&
-            current + 3 < tokens.size() &&
-        tokens[current+1].type == TokenType::SCOPE_RESOLUTION &&
-        tokens[current+2].type == TokenType::IDENTIFIER && tokens[current+2].lexeme == "string" &&
-        tokens[current+3].type == TokenType::IDENTIFIER) // name
+        peekAhead(1).type == TokenType::SCOPE_RESOLUTION &&
+        peekAhead(2).type == TokenType::IDENTIFIER && peekAhead(2).lexeme == "string" &&
+        peekAhead(3).type == TokenType::IDENTIFIER) // name
     {
         // Check if ASSIGN or SEMICOLON follows the name
-        if (current + 4 < tokens.size() &&
-            (tokens[current+4].type == TokenType::ASSIGN || tokens[current+4].type == TokenType::SEMICOLON))
+        if (peekAhead(4).type == TokenType::ASSIGN || peekAhead(4).type == TokenType::SEMICOLON)
         {
              advance(); // std
              advance(); // ::
-             Token typeName = advance(); // string
+             advance(); // string
              Token varName = advance(); // name
-             std::string actualTypeName = "string"; // Use simplified type
+             Symbol actualTypeName = Symbols::String; // Use simplified type
             
-            std::unique_ptr<Expression> initializer = nullptr;
-            if (match({TokenType::ASSIGN})) {
+            NodePtr<Expression> initializer = nullptr;
+            if (match(TokenType::ASSIGN)) {
                 initializer = parseExpression();
             }
              consume(TokenType::SEMICOLON, "Expect ';' after std::string variable declaration.");
-            return std::make_unique<VariableDeclStmt>(actualTypeName, varName.lexeme, std::move(initializer));
+            return makeNode<VariableDeclStmt>(actualTypeName, symbolOf(varName), std::move(initializer));
         }
         // If not followed by ASSIGN/SEMICOLON, let it be parsed as expression (e.g., std::string() call)
     }
 
     // Check for regular variable declaration: IDENTIFIER IDENTIFIER (ASSIGN | SEMICOLON)
     bool potentialVarDecl = check(TokenType::IDENTIFIER) &&
-                            current + 1 < tokens.size() && tokens[current + 1].type == TokenType::IDENTIFIER &&
-                            current + 2 < tokens.size() &&
-                            (tokens[current + 2].type == TokenType::ASSIGN || tokens[current + 2].type == TokenType::SEMICOLON);
+                            peekAhead(1).type == TokenType::IDENTIFIER &&
+                            (peekAhead(2).type == TokenType::ASSIGN || peekAhead(2).type == TokenType::SEMICOLON);
 
     if (potentialVarDecl)
     {
         Token typeName = advance(); // Consume TYPE
         Token varName = advance();  // Consume NAME
-        std::cerr << "DEBUG: Potential VarDecl identified: " << typeName.lexeme << " " << varName.lexeme << ", next: " << tokenTypeToString(peek().type) << "\n";
+        LOG_TRACE("Potential VarDecl identified: " << typeName.lexeme << " " << varName.lexeme << ", next: " << tokenTypeToString(peek().type));
                     
-                    std::unique_ptr<Expression> initializer = nullptr;
-                    if (match({TokenType::ASSIGN})) {
-             std::cerr << "DEBUG: Parsing initializer for " << varName.lexeme << "...\n";
+                    NodePtr<Expression> initializer = nullptr;
+                    if (match(TokenType::ASSIGN)) {
+             LOG_TRACE("Parsing initializer for " << varName.lexeme << "...");
                         initializer = parseExpression();
-             std::cerr << "DEBUG: Finished initializer for " << varName.lexeme << ", next: " << tokenTypeToString(peek().type) << "\n";
+             LOG_TRACE("Finished initializer for " << varName.lexeme << ", next: " << tokenTypeToString(peek().type));
                     }
                     
         // Check for semicolon AFTER attempting to parse initializer
         if (check(TokenType::SEMICOLON)) {
             advance(); // Consume SEMICOLON
-            std::cerr << "DEBUG: Successfully parsed VarDecl: " << typeName.lexeme << " " << varName.lexeme << "\n";
-                    return std::make_unique<VariableDeclStmt>(typeName.lexeme, varName.lexeme, std::move(initializer));
+            LOG_DEBUG("Successfully parsed VarDecl: " << typeName.lexeme << " " << varName.lexeme);
+                    return makeNode<VariableDeclStmt>(symbolOf(typeName), symbolOf(varName), std::move(initializer));
         } else {
             // This case should ideally not happen if ASSIGN was matched
             // If no ASSIGN was matched, SEMICOLON is mandatory
@@ -343,140 +371,189 @@ std::unique_ptr<Statement> Parser::parseVariableDeclarationOrExprStmt() {
     }
     
     // If it doesn't match the variable declaration patterns, parse it as an expression statement.
-    std::cerr << "DEBUG: Parsing as expression statement, token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+    LOG_TRACE("Parsing as expression statement, token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
     return parseExpressionStatement();
 }
 
 
 
 // branchStmt -> BRANCH LEFT_PAREN expression RIGHT_PAREN blockStmt (ELSE BRANCH LEFT_PAREN expression RIGHT_PAREN blockStmt)* (ELSE blockStmt)? ;
-std::unique_ptr<Statement> Parser::parseBranchStatement() {
-    std::cerr << "DEBUG: ENTERING parseBranchStatement(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+NodePtr<Statement> Parser::parseBranchStatement() {
+    LOG_TRACE("ENTERING parseBranchStatement(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
     // 'branch' consumed
-    auto branchStmt = std::make_unique<BranchStmt>();
+    auto branchStmt = makeNode<BranchStmt>();
 
     // First branch (if)
     consume(TokenType::LEFT_PAREN, "Expect '(' after 'branch'.");
     auto condition = parseExpression();
     consume(TokenType::RIGHT_PAREN, "Expect ')' after branch condition.");
     consume(TokenType::LEFT_BRACE, "Expect '{' before branch body.");
-    std::cerr << "DEBUG: parseBranchStatement() - BEFORE parsing first block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+    LOG_TRACE("parseBranchStatement() - BEFORE parsing first block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
     auto body = parseBlock();
-    std::cerr << "DEBUG: parseBranchStatement() - AFTER parsing first block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+    LOG_TRACE("parseBranchStatement() - AFTER parsing first block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
     branchStmt->branches.emplace_back(std::move(condition), std::move(body));
 
     // Else branch (else if)
-    while (check(TokenType::ELSE) && current + 1 < tokens.size() && tokens[current + 1].type == TokenType::BRANCH) {
+    while (check(TokenType::ELSE) && peekAhead(1).type == TokenType::BRANCH) {
         advance(); // Consume ELSE
         advance(); // Consume BRANCH
         consume(TokenType::LEFT_PAREN, "Expect '(' after 'else branch'.");
         auto elseIfCondition = parseExpression();
         consume(TokenType::RIGHT_PAREN, "Expect ')' after branch condition.");
         consume(TokenType::LEFT_BRACE, "Expect '{' before else branch body.");
-        std::cerr << "DEBUG: parseBranchStatement() - BEFORE parsing else-if block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+        LOG_TRACE("parseBranchStatement() - BEFORE parsing else-if block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
         auto elseIfBody = parseBlock();
-        std::cerr << "DEBUG: parseBranchStatement() - AFTER parsing else-if block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+        LOG_TRACE("parseBranchStatement() - AFTER parsing else-if block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
         branchStmt->branches.emplace_back(std::move(elseIfCondition), std::move(elseIfBody));
     }
 
     // Else block
-    if (match({TokenType::ELSE})) { // This should now correctly find the ELSE if it wasn't consumed above
+    if (match(TokenType::ELSE)) { // This should now correctly find the ELSE if it wasn't consumed above
          consume(TokenType::LEFT_BRACE, "Expect '{' before else body.");
-         std::cerr << "DEBUG: parseBranchStatement() - BEFORE parsing final else block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+         LOG_TRACE("parseBranchStatement() - BEFORE parsing final else block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
          auto elseBody = parseBlock();
-         std::cerr << "DEBUG: parseBranchStatement() - AFTER parsing final else block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+         LOG_TRACE("parseBranchStatement() - AFTER parsing final else block, current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
          branchStmt->branches.emplace_back(nullptr, std::move(elseBody));
     }
 
-    std::cerr << "DEBUG: RETURNING from parseBranchStatement(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << peek().line << "\\n";
+    LOG_TRACE("RETURNING from parseBranchStatement(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ") at line " << lineOf(peek()));
     return branchStmt;
 }
 
 
 // ioStmt -> (BLOOM | WATER) (STREAM_OUT | STREAM_IN) expression ( (STREAM_OUT | STREAM_IN) expression )* SEMICOLON ;
-std::unique_ptr<Statement> Parser::parseIOStatement(TokenType ioType) {
-    std::cerr << "DEBUG: Entering parseIOStatement for type " << tokenTypeToString(ioType) << ", next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+NodePtr<Statement> Parser::parseIOStatement(TokenType ioType) {
+    LOG_TRACE("Entering parseIOStatement for type " << tokenTypeToString(ioType) << ", next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
     TokenType direction;
     // Consume the *first* operator
-    if (match({TokenType::STREAM_OUT})) {
+    if (match(TokenType::STREAM_OUT)) {
         direction = TokenType::STREAM_OUT;
-        std::cerr << "DEBUG: parseIOStatement matched initial STREAM_OUT, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
-    } else if (match({TokenType::STREAM_IN})) {
+        LOG_TRACE("parseIOStatement matched initial STREAM_OUT, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
+    } else if (match(TokenType::STREAM_IN)) {
         direction = TokenType::STREAM_IN;
-        std::cerr << "DEBUG: parseIOStatement matched initial STREAM_IN, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+        LOG_TRACE("parseIOStatement matched initial STREAM_IN, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
     } else {
         error(peek(), "Expect '<<' or '>>' after bloom/water.");
         return nullptr; // Unreachable
     }
 
-    auto ioStmt = std::make_unique<IOStmt>(ioType, direction);
+    auto ioStmt = makeNode<IOStmt>(ioType, direction);
     
-    std::cerr << "DEBUG: parseIOStatement parsing first expression... current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+    LOG_TRACE("parseIOStatement parsing first expression... current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
     ioStmt->expressions.push_back(parseExpression());
-    std::cerr << "DEBUG: parseIOStatement finished first expression, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+    LOG_TRACE("parseIOStatement finished first expression, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
 
     // Loop while subsequent matching operators are found and consumed
-    while (match({direction})) { 
-        std::cerr << "DEBUG: parseIOStatement matched subsequent " << tokenTypeToString(direction) << ", parsing next expression...\n";
+    while (match(direction)) { 
+        LOG_TRACE("parseIOStatement matched subsequent " << tokenTypeToString(direction) << ", parsing next expression...");
         ioStmt->expressions.push_back(parseExpression());
-        std::cerr << "DEBUG: parseIOStatement finished subsequent expression, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+        LOG_TRACE("parseIOStatement finished subsequent expression, next token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
     } 
 
     consume(TokenType::SEMICOLON, "Expect ';' after I/O statement.");
-    std::cerr << "DEBUG: Exiting parseIOStatement after consuming semicolon.\n";
+    LOG_TRACE("Exiting parseIOStatement after consuming semicolon.");
     return ioStmt;
 }
 
 
 // returnStmt -> BLOSSOM expression? SEMICOLON ;
-std::unique_ptr<Statement> Parser::parseReturnStatement() {
+NodePtr<Statement> Parser::parseReturnStatement() {
     // 'blossom' consumed
-    std::unique_ptr<Expression> value = nullptr;
+    NodePtr<Expression> value = nullptr;
     if (!check(TokenType::SEMICOLON)) { // If there's something before the semicolon, parse it as the return value
         value = parseExpression();
     }
     consume(TokenType::SEMICOLON, "Expect ';' after blossom (return) value.");
-    std::cerr << "DEBUG: Returning ReturnStmt from parseReturnStatement.\n";
-    return std::make_unique<ReturnStmt>(std::move(value));
+    LOG_TRACE("Returning ReturnStmt from parseReturnStatement.");
+    return makeNode<ReturnStmt>(std::move(value));
 }
 
 // expressionStatement -> expression SEMICOLON ;
-std::unique_ptr<Statement> Parser::parseExpressionStatement() {
+NodePtr<Statement> Parser::parseExpressionStatement() {
     auto expr = parseExpression();
     consume(TokenType::SEMICOLON, "Expect ';' after expression.");
     // Removed the extra check here, as parseVariableDeclarationOrExprStmt should now correctly handle declarations.
-    return std::make_unique<ExpressionStmt>(std::move(expr));
+    return makeNode<ExpressionStmt>(std::move(expr));
 }
 
 
 // --- Expression Parsing (Recursive Descent with Precedence) --- 
 
+// Each binary operator's binding power, indexed by TokenType; 0 means "not a
+// binary operator" and ends the expression. Higher binds tighter, and every
+// level is left-associative.
+//   logicalOr  -> logicalAnd ( OR logicalAnd )* ;
+//   logicalAnd -> equality ( AND equality )* ;
+//   equality   -> comparison ( (NOT_EQUAL | EQUAL) comparison )* ;
+//   comparison -> term ( (GREATER | GREATER_EQUAL | LESS | LESS_EQUAL) term )* ;
+//   term       -> factor ( (MINUS | PLUS) factor )* ;
+//   factor     -> unary ( (SLASH | STAR | MODULO) unary )* ;
+namespace {
+
+enum Precedence : uint8_t {
+    PREC_NONE = 0,
+    PREC_OR,         // ||
+    PREC_AND,        // &&
+    PREC_EQUALITY,   // == !=
+    PREC_COMPARISON, // < > <= >=
+    PREC_TERM,       // + -
+    PREC_FACTOR      // * / %
+};
+
+constexpr std::array<uint8_t, TOKEN_TYPE_COUNT> makeBindingPowers() {
+    std::array<uint8_t, TOKEN_TYPE_COUNT> power{};
+    auto set = [&power](TokenType type, Precedence precedence) { power[static_cast<size_t>(type)] = precedence; };
+    set(TokenType::OR, PREC_OR);
+    set(TokenType::AND, PREC_AND);
+    set(TokenType::EQUAL, PREC_EQUALITY);
+    set(TokenType::NOT_EQUAL, PREC_EQUALITY);
+    set(TokenType::LESS, PREC_COMPARISON);
+    set(TokenType::LESS_EQUAL, PREC_COMPARISON);
+    set(TokenType::GREATER, PREC_COMPARISON);
+    set(TokenType::GREATER_EQUAL, PREC_COMPARISON);
+    set(TokenType::PLUS, PREC_TERM);
+    set(TokenType::MINUS, PREC_TERM);
+    set(TokenType::STAR, PREC_FACTOR);
+    set(TokenType::SLASH, PREC_FACTOR);
+    set(TokenType::MODULO, PREC_FACTOR);
+    return power;
+}
+
+constexpr std::array<uint8_t, TOKEN_TYPE_COUNT> BINDING_POWER = makeBindingPowers();
+
+inline int bindingPower(TokenType type) {
+    return BINDING_POWER[static_cast<size_t>(type)];
+}
+
+} // namespace
+
 // expression -> assignment ;
-std::unique_ptr<Expression> Parser::parseExpression() {
+NodePtr<Expression> Parser::parseExpression() {
     return parseAssignment();
 }
 
 // assignment -> ( call "." )? IDENTIFIER ASSIGN assignment | logicalOr ;
 // Note: This handles simple assignments like `a = b`, `g.member = c`. 
 // It doesn't handle complex left-hand sides like `a[i] = x` yet.
-std::unique_ptr<Expression> Parser::parseAssignment() {
-     auto expr = parseLogicalOr(); // Parse higher precedence first
+NodePtr<Expression> Parser::parseAssignment() {
+     NestingGuard nesting(*this, expressionDepth_, "Expression"); // Every parenthesis, argument list and chained '=' comes back here
+     auto expr = parseBinary(PREC_OR); // Parse higher precedence first
 
-     if (match({TokenType::ASSIGN})) {
+     if (match(TokenType::ASSIGN)) {
          Token equals = previous();
          auto value = parseAssignment(); // Right-associative
 
          // Check if the left side is a valid assignment target (L-value)
-         if (IdentifierExpr* identifier = dynamic_cast<IdentifierExpr*>(expr.get())) {
+         if (IdentifierExpr* identifier = nodeCast<IdentifierExpr>(expr.get())) {
               // Simple variable assignment: a = ...
              // Need to move ownership of name, create new IdentifierExpr for AssignmentStmt
-              return std::make_unique<AssignmentStmt>( 
-                   std::make_unique<IdentifierExpr>(std::move(identifier->name)),
+              return makeNode<AssignmentStmt>( 
+                   makeNode<IdentifierExpr>(std::move(identifier->name)),
                    std::move(value));
-         } else if (MemberAccessExpr* memberAccess = dynamic_cast<MemberAccessExpr*>(expr.get())){
+         } else if (MemberAccessExpr* memberAccess = nodeCast<MemberAccessExpr>(expr.get())){
              // Member assignment: g.member = ...
              // We can directly use the parsed MemberAccessExpr as the left side
-             return std::make_unique<AssignmentStmt>(std::move(expr), std::move(value));
+             return makeNode<AssignmentStmt>(std::move(expr), std::move(value));
          }
 
          // If the left side is not a valid target
@@ -486,103 +563,47 @@ std::unique_ptr<Expression> Parser::parseAssignment() {
      return expr; // If not an assignment, return the parsed expression
 }
 
-// Helper for binary operators - now a static member
-std::unique_ptr<Expression> Parser::parseBinaryHelper(
-    Parser* parser, // Explicitly pass parser instance
-    std::function<std::unique_ptr<Expression>()> parseOperand,
-    const std::vector<TokenType>& operators
-) {
-    std::cerr << "DEBUG: Entering parseBinaryHelper for operators: [ ";
-    for(const auto& op : operators) std::cerr << tokenTypeToString(op) << " ";
-    std::cerr << "]\n";
-    
-    auto expr = parseOperand();
-
-    while (true) { // Keep looping as long as matching operators are found
-        bool matchedOperator = false;
-        for (const TokenType& opType : operators) {
-             if (parser->check(opType)) { // Use check() first without consuming
-                  std::cerr << "DEBUG: parseBinaryHelper - Found matching operator: " 
-                           << tokenTypeToString(opType) 
-                           << " at token: " << tokenTypeToString(parser->peek().type) 
-                           << " (" << parser->peek().lexeme << ")\n";
-                 parser->advance(); // Consume the matched operator
-        Token opToken = parser->previous();
-        auto right = parseOperand();
-        expr = std::make_unique<BinaryOpExpr>(opToken.type, std::move(expr), std::move(right));
-                 matchedOperator = true;
-                 break; // Exit the inner for loop once an operator is matched and handled
-             }
-        }
-        
-        if (!matchedOperator) { 
-             std::cerr << "DEBUG: parseBinaryHelper - No more matching operators found. Current token: " 
-                      << tokenTypeToString(parser->peek().type) << " (" << parser->peek().lexeme << ")\n";
-            break; // Exit the while loop if no operator in the list matched
+// Parses a unary operand, then folds in operators binding at least
+// minPrecedence. The right operand of an operator at level p only takes
+// operators above p, which makes equal levels group to the left.
+NodePtr<Expression> Parser::parseBinary(int minPrecedence) {
+    auto expr = parseUnary();
+
+    for (;;) {
+        int precedence = bindingPower(peek().type); // EOF_TOKEN has none
+        if (precedence < minPrecedence || precedence == PREC_NONE) break;
+        TokenType op = advance().type;
+        LOG_TRACE("parseBinary - operator " << tokenTypeToString(op) << " at precedence " << precedence);
+        NodePtr<Expression> right;
+        {
+            // Counted so the tree never nests deeper than readBinaryAst accepts
+            NestingGuard nesting(*this, expressionDepth_, "Expression");
+            right = parseBinary(precedence + 1);
         }
+        expr = makeNode<BinaryOpExpr>(op, std::move(expr), std::move(right));
     }
 
-    std::cerr << "DEBUG: Exiting parseBinaryHelper\n";
-    return expr;
-}
-
-// logicalOr -> logicalAnd ( OR logicalAnd )* ;
-std::unique_ptr<Expression> Parser::parseLogicalOr() {
-     return parseBinaryHelper(this, [this]() { return parseLogicalAnd(); }, {TokenType::OR}); // Pass 'this'
-}
-
-// logicalAnd -> equality ( AND equality )* ;
-std::unique_ptr<Expression> Parser::parseLogicalAnd() {
-     return parseBinaryHelper(this, [this]() { return parseEquality(); }, {TokenType::AND}); // Pass 'this'
-}
-
-// equality -> comparison ( (NOT_EQUAL | EQUAL) comparison )* ;
-std::unique_ptr<Expression> Parser::parseEquality() {
-    return parseBinaryHelper(this, [this]() { return parseComparison(); }, {TokenType::NOT_EQUAL, TokenType::EQUAL}); // EQUAL (==) is correct here
-}
-
-// comparison -> term ( (GREATER | GREATER_EQUAL | LESS | LESS_EQUAL) term )* ;
-std::unique_ptr<Expression> Parser::parseComparison() {
-    std::cerr << "DEBUG: Entering parseComparison(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
-    auto expr = parseBinaryHelper(this, [this]() { return parseTerm(); }, 
-        {TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::LESS, TokenType::LESS_EQUAL}); // This list seems correct based on lexer
-    std::cerr << "DEBUG: Exiting parseComparison(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n"; 
-    return expr;
-}
-
-// term -> factor ( (MINUS | PLUS) factor )* ;
-std::unique_ptr<Expression> Parser::parseTerm() {
-    std::cerr << "DEBUG: Entering parseTerm(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
-    auto expr = parseBinaryHelper(this, [this]() { return parseFactor(); }, {TokenType::MINUS, TokenType::PLUS});
-    std::cerr << "DEBUG: Exiting parseTerm()\n";
-    return expr;
-}
-
-// factor -> unary ( (SLASH | STAR | MODULO) unary )* ;
-std::unique_ptr<Expression> Parser::parseFactor() {
-    std::cerr << "DEBUG: Entering parseFactor(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
-    auto expr = parseBinaryHelper(this, [this]() { return parseUnary(); }, {TokenType::SLASH, TokenType::STAR, TokenType::MODULO});
-    std::cerr << "DEBUG: Exiting parseFactor()\n";
     return expr;
 }
 
 // unary -> (NOT | MINUS) unary | call ;
-std::unique_ptr<Expression> Parser::parseUnary() {
-    std::cerr << "DEBUG: Entering parseUnary(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
-    if (match({TokenType::NOT, TokenType::MINUS})) {
+NodePtr<Expression> Parser::parseUnary() {
+    LOG_TRACE("Entering parseUnary(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
+    if (match(TokenTypeSet{TokenType::NOT, TokenType::MINUS})) {
+        NestingGuard nesting(*this, expressionDepth_, "Expression");
         Token opToken = previous();
         auto right = parseUnary();
          error(opToken, "Unary operators not fully implemented yet."); 
          return nullptr; 
     }
     auto expr = parseCall();
-    std::cerr << "DEBUG: Exiting parseUnary()\n";
+    LOG_TRACE("Exiting parseUnary()");
     return expr;
 }
 
 // Helper to finish parsing a function call - now a static member
-std::unique_ptr<Expression> Parser::finishCall(Parser* parser, std::unique_ptr<Expression> callee) { // Explicitly pass parser instance
-    auto callExpr = std::make_unique<FunctionCallExpr>(std::move(callee));
+NodePtr<Expression> Parser::finishCall(Parser* parser, NodePtr<Expression> callee) { // Explicitly pass parser instance
+    auto callExpr = makeNode<FunctionCallExpr>(std::move(callee));
 
     if (!parser->check(TokenType::RIGHT_PAREN)) {
         do {
@@ -591,7 +612,7 @@ std::unique_ptr<Expression> Parser::finishCall(Parser* parser, std::unique_ptr<E
             //     parser->error(parser->peek(), "Too many arguments.");
             // }
             callExpr->arguments.push_back(parser->parseExpression());
-        } while (parser->match({TokenType::COMMA}));
+        } while (parser->match(TokenType::COMMA));
     }
 
     parser->consume(TokenType::RIGHT_PAREN, "Expect ')' after arguments.");
@@ -600,15 +621,15 @@ std::unique_ptr<Expression> Parser::finishCall(Parser* parser, std::unique_ptr<E
 
 // call -> primary ( LEFT_PAREN arguments? RIGHT_PAREN | DOT IDENTIFIER )* ;
 // arguments -> expression ( COMMA expression )*
-std::unique_ptr<Expression> Parser::parseCall() {
+NodePtr<Expression> Parser::parseCall() {
     auto expr = parsePrimary();
 
     while (true) {
-        if (match({TokenType::LEFT_PAREN})) {
+        if (match(TokenType::LEFT_PAREN)) {
             expr = finishCall(this, std::move(expr)); // Pass 'this'
-        } else if (match({TokenType::DOT})) {
+        } else if (match(TokenType::DOT)) {
             Token name = consume(TokenType::IDENTIFIER, "Expect property name after '.'.");
-            expr = std::make_unique<MemberAccessExpr>(std::move(expr), std::make_unique<IdentifierExpr>(name.lexeme));
+            expr = makeNode<MemberAccessExpr>(std::move(expr), makeNode<IdentifierExpr>(symbolOf(name)));
         } else {
             break;
         }
@@ -621,55 +642,59 @@ std::unique_ptr<Expression> Parser::parseCall() {
 // primary -> NUMBER | STRING | TRUE | FALSE | IDENTIFIER | LEFT_PAREN expression RIGHT_PAREN ;
 // Handle std::string special case
 // Ensure FLOAT_LITERAL and DOUBLE_LITERAL are checked
-std::unique_ptr<Expression> Parser::parsePrimary() {
-    std::cerr << "DEBUG: Entering parsePrimary(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")\n";
+NodePtr<Expression> Parser::parsePrimary() {
+    LOG_TRACE("Entering parsePrimary(), current token: " << tokenTypeToString(peek().type) << " (" << peek().lexeme << ")");
     
-    if (match({TokenType::FALSE})) { 
-        std::cerr << "DEBUG: parsePrimary() matched FALSE\n"; 
-        return std::make_unique<BooleanLiteralExpr>(false); 
+    if (match(TokenType::FALSE)) { 
+        LOG_TRACE("parsePrimary() matched FALSE"); 
+        return makeNode<BooleanLiteralExpr>(false); 
     }
-    if (match({TokenType::TRUE})) { 
-        std::cerr << "DEBUG: parsePrimary() matched TRUE\n"; 
-        return std::make_unique<BooleanLiteralExpr>(true); 
+    if (match(TokenType::TRUE)) { 
+        LOG_TRACE("parsePrimary() matched TRUE"); 
+        return makeNode<BooleanLiteralExpr>(true); 
     }
 
-    if (match({TokenType::NUMBER})) {
-        std::cerr << "DEBUG: parsePrimary() matched NUMBER: " << previous().lexeme << "\n";
-        return std::make_unique<NumberLiteralExpr>(previous().lexeme);
+    // Numeric values are decoded here, once per literal, not for every token
+    if (match(TokenType::NUMBER)) {
+        LOG_TRACE("parsePrimary() matched NUMBER: " << previous().lexeme);
+        NumericLiteral literal = decodeNumericLiteral(TokenType::NUMBER, previous().lexeme);
+        return makeNode<NumberLiteralExpr>(previous().lexeme, literal.value.integer, literal.overflow);
     }
-    if (match({TokenType::FLOAT_LITERAL})) {
-        std::cerr << "DEBUG: parsePrimary() matched FLOAT_LITERAL: " << previous().lexeme << "\n";
-        return std::make_unique<FloatLiteralExpr>(previous().lexeme);
+    if (match(TokenType::FLOAT_LITERAL)) {
+        LOG_TRACE("parsePrimary() matched FLOAT_LITERAL: " << previous().lexeme);
+        NumericLiteral literal = decodeNumericLiteral(TokenType::FLOAT_LITERAL, previous().lexeme);
+        return makeNode<FloatLiteralExpr>(previous().lexeme, literal.value.real, literal.overflow);
     }
-    if (match({TokenType::DOUBLE_LITERAL})) {
-        std::cerr << "DEBUG: parsePrimary() matched DOUBLE_LITERAL: " << previous().lexeme << "\n";
-        return std::make_unique<DoubleLiteralExpr>(previous().lexeme);
+    if (match(TokenType::DOUBLE_LITERAL)) {
+        LOG_TRACE("parsePrimary() matched DOUBLE_LITERAL: " << previous().lexeme);
+        NumericLiteral literal = decodeNumericLiteral(TokenType::DOUBLE_LITERAL, previous().lexeme);
+        return makeNode<DoubleLiteralExpr>(previous().lexeme, literal.value.real, literal.overflow);
     }
-    if (match({TokenType::STRING})) {
-        std::cerr << "DEBUG: parsePrimary() matched STRING: \"" << previous().lexeme << "\"\n";
-        return std::make_unique<StringLiteralExpr>(previous().lexeme);
+    if (match(TokenType::STRING)) {
+        LOG_TRACE("parsePrimary() matched STRING: \"" << previous().lexeme << "\"");
+        return makeNode<StringLiteralExpr>(previous().lexeme);
     }
 
-    if (match({TokenType::IDENTIFIER})) {
-         std::cerr << "DEBUG: parsePrimary() matched IDENTIFIER: " << previous().lexeme << "\n";
+    if (match(TokenType::IDENTIFIER)) {
+         LOG_TRACE("parsePrimary() matched IDENTIFIER: " << previous().lexeme);
          // Handle `std::string` usage - Check if it was already handled or if it appears here
-         if (previous().lexeme == "std" && match({TokenType::SCOPE_RESOLUTION})) {
+         if (previous().lexeme == "std" && match(TokenType::SCOPE_RESOLUTION)) {
              Token typeName = consume(TokenType::IDENTIFIER, "Expect type name after 'std::'.");
              if (typeName.lexeme == "string") {
-                 std::cerr << "DEBUG: parsePrimary() resolved std::string identifier\n";
-                 return std::make_unique<IdentifierExpr>("string");
+                 LOG_TRACE("parsePrimary() resolved std::string identifier");
+                 return makeNode<IdentifierExpr>(Symbols::String);
              }
-             std::cerr << "DEBUG: parsePrimary() resolved std::" << typeName.lexeme << " identifier\n";
-             return std::make_unique<IdentifierExpr>("std::" + typeName.lexeme);
+             LOG_TRACE("parsePrimary() resolved std::" << typeName.lexeme << " identifier");
+             return makeNode<IdentifierExpr>("std::" + std::string(typeName.lexeme));
          }
-        return std::make_unique<IdentifierExpr>(previous().lexeme);
+        return makeNode<IdentifierExpr>(symbolOf(previous()));
     }
 
-    if (match({TokenType::LEFT_PAREN})) {
-        std::cerr << "DEBUG: parsePrimary() matched LEFT_PAREN, parsing grouped expression\n";
+    if (match(TokenType::LEFT_PAREN)) {
+        LOG_TRACE("parsePrimary() matched LEFT_PAREN, parsing grouped expression");
         auto expr = parseExpression();
         consume(TokenType::RIGHT_PAREN, "Expect ')' after expression.");
-        std::cerr << "DEBUG: parsePrimary() finished grouped expression\n";
+        LOG_TRACE("parsePrimary() finished grouped expression");
         return expr; 
     }
 
@@ -678,25 +703,25 @@ std::unique_ptr<Expression> Parser::parsePrimary() {
     return nullptr; // Unreachable due to error throw
 }
 
-std::unique_ptr<Statement> Parser::parseWhileStatement() {
+NodePtr<Statement> Parser::parseWhileStatement() {
     consume(TokenType::LEFT_PAREN, "Expect '(' after 'while'.");
     auto condition = parseExpression();
     consume(TokenType::RIGHT_PAREN, "Expect ')' after while condition.");
     auto body = parseBlock();
-    return std::make_unique<WhileStmt>(std::move(condition), std::move(body));
+    return makeNode<WhileStmt>(std::move(condition), std::move(body));
 }
 
-std::unique_ptr<Statement> Parser::parseForStatement() {
+NodePtr<Statement> Parser::parseForStatement() {
     consume(TokenType::LEFT_PAREN, "Expect '(' after 'for'.");
 
-    std::unique_ptr<Statement> initializer;
-    if (match({TokenType::SEMICOLON})) {
+    NodePtr<Statement> initializer;
+    if (match(TokenType::SEMICOLON)) {
         initializer = nullptr; // No initializer
-    } else if (match({TokenType::IDENTIFIER})) { // Check if it looks like a var decl
+    } else if (match(TokenType::IDENTIFIER)) { // Check if it looks like a var decl
          // Need to backtrack or parse more carefully
          // Assuming var decl starts with IDENTIFIER (type)
          // This is simplified - Hanami might not require type keyword here
-         current--; // Backtrack IDENTIFIER
+         stream_.retreat(); // Backtrack IDENTIFIER
          initializer = parseVariableDeclarationOrExprStmt(); // Handles var decl or expr
     } else {
         initializer = parseExpressionStatement(); // Treat as expression
@@ -705,13 +730,13 @@ std::unique_ptr<Statement> Parser::parseForStatement() {
         // consume(TokenType::SEMICOLON, "Expect ';' after for loop initializer.");
     }
 
-    std::unique_ptr<Expression> condition;
+    NodePtr<Expression> condition;
     if (!check(TokenType::SEMICOLON)) {
         condition = parseExpression();
     }
     consume(TokenType::SEMICOLON, "Expect ';' after for loop condition.");
 
-    std::unique_ptr<Expression> increment;
+    NodePtr<Expression> increment;
     if (!check(TokenType::RIGHT_PAREN)) {
         increment = parseExpression();
     }
@@ -719,5 +744,5 @@ std::unique_ptr<Statement> Parser::parseForStatement() {
 
     auto body = parseBlock();
 
-    return std::make_unique<ForStmt>(std::move(initializer), std::move(condition), std::move(increment), std::move(body));
+    return makeNode<ForStmt>(std::move(initializer), std::move(condition), std::move(increment), std::move(body));
 }
\ No newline at end of file
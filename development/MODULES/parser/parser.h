@@ -6,73 +6,106 @@
 #include <memory>
 #include <stdexcept>
 #include <iostream>
-#include <functional>
 
 // Include common definitions
 #include "../common/token.h" // Needs Token, TokenType
+#include "../common/token_stream.h" // Pull-based token input with lookahead
+#include "../common/line_table.h" // Token offsets -> line/column for diagnostics
 #include "../common/ast.h"   // Needs AST Node definitions (ProgramNode, Statement, Expression, etc.) and ParseError
 
 // --- Parser Class Declaration --- 
 class Parser {
 public:
-    Parser(const std::vector<Token>& tokens);
+    // Nodes are allocated from arena, which must outlive the returned tree.
+    // lines resolves token offsets for error messages.
+    Parser(const std::vector<Token>& tokens, const LineTable& lines, Arena& arena);
+    // Pulls tokens from source as parsing goes (e.g. straight from a Lexer),
+    // so only a few tokens are held at a time.
+    Parser(TokenSource& source, const LineTable& lines, Arena& arena);
     // Returns the root of the AST, defined in common/ast.h
-    std::unique_ptr<ProgramNode> parse(); 
+    NodePtr<ProgramNode> parse(); 
+    // parse() one top-level declaration at a time: parses the next one,
+    // appends it to program and returns it, or returns nullptr at EOF.
+    // Earlier declarations are complete and never touched again, so another
+    // thread may read them while parsing goes on.
+    Statement* parseNext(ProgramNode& program);
 
 private:
-    const std::vector<Token>& tokens;
-    size_t current = 0;
+    const LineTable& lines_;
+    Arena& arena_;
+    TokenStream stream_;
 
-    // Helper methods
+    // Statements (declarations and blocks) and expressions (parentheses,
+    // argument lists, right-hand operands, chained '=' and unary operators)
+    // are parsed recursively; input nested deeper than MAX_NESTING_DEPTH
+    // (common/ast.h) is rejected with a ParseError instead of overflowing the
+    // stack. The two kinds are counted separately, so a deeply nested
+    // expression is not cut short by the blocks around it.
+    size_t statementDepth_ = 0;
+    size_t expressionDepth_ = 0;
+
+    // Counts one level in depth (statementDepth_ or expressionDepth_) for as
+    // long as it lives; kind names it in the error message.
+    class NestingGuard {
+    public:
+        NestingGuard(Parser& parser, size_t& depth, const char* kind);
+        ~NestingGuard() { --depth_; }
+        NestingGuard(const NestingGuard&) = delete;
+        NestingGuard& operator=(const NestingGuard&) = delete;
+    private:
+        size_t& depth_;
+    };
+
+    // Helper methods. The tokens they return live in the stream's lookahead
+    // buffer and are only good until the stream moves on: copy a Token that
+    // has to outlive further parsing (Token name = consume(...)).
     const Token& peek() const;
+    const Token& peekAhead(size_t ahead) const; // Up to TokenStream::MAX_LOOKAHEAD
     const Token& previous() const;
     bool isAtEnd() const;
-    Token advance();
+    const Token& advance();
     bool check(TokenType type) const;
-    bool match(const std::vector<TokenType>& types);
-    Token consume(TokenType type, const std::string& message);
+    bool check(TokenTypeSet types) const;
+    bool match(TokenType type);
+    bool match(TokenTypeSet types);
+    const Token& consume(TokenType type, const std::string& message);
     void synchronize(); // Error recovery
 
     // Parsing methods for grammar rules (return types from common/ast.h)
-    std::unique_ptr<Statement> parseDeclaration();
-    std::unique_ptr<Statement> parseStatement();
-    std::unique_ptr<Statement> parseStyleInclude();
-    std::unique_ptr<Statement> parseGardenDeclaration();
-    std::unique_ptr<Statement> parseSpeciesDeclaration();
-    std::unique_ptr<VisibilityBlockStmt> parseVisibilityBlock();
-    std::unique_ptr<BlockStmt> parseBlock();
-    std::unique_ptr<Statement> parseFunctionDefinition();
-    std::unique_ptr<Statement> parseVariableDeclarationOrExprStmt();
-    std::unique_ptr<Statement> parseBranchStatement();
-    std::unique_ptr<Statement> parseIOStatement(TokenType ioType);
-    std::unique_ptr<Statement> parseReturnStatement(); // blossom
-    std::unique_ptr<Statement> parseExpressionStatement();
-    std::unique_ptr<Statement> parseWhileStatement();
-    std::unique_ptr<Statement> parseForStatement();
+    NodePtr<Statement> parseDeclaration();
+    NodePtr<Statement> parseStatement();
+    NodePtr<Statement> parseStyleInclude();
+    NodePtr<Statement> parseGardenDeclaration();
+    NodePtr<Statement> parseSpeciesDeclaration();
+    NodePtr<VisibilityBlockStmt> parseVisibilityBlock();
+    NodePtr<BlockStmt> parseBlock();
+    NodePtr<Statement> parseFunctionDefinition();
+    NodePtr<Statement> parseVariableDeclarationOrExprStmt();
+    NodePtr<Statement> parseBranchStatement();
+    NodePtr<Statement> parseIOStatement(TokenType ioType);
+    NodePtr<Statement> parseReturnStatement(); // blossom
+    NodePtr<Statement> parseExpressionStatement();
+    NodePtr<Statement> parseWhileStatement();
+    NodePtr<Statement> parseForStatement();
 
     // Expression parsing (following operator precedence - types from common/ast.h)
-    std::unique_ptr<Expression> parseExpression();
-    std::unique_ptr<Expression> parseAssignment(); // Handles assignment (=)
-    std::unique_ptr<Expression> parseLogicalOr();  // Handles ||
-    std::unique_ptr<Expression> parseLogicalAnd(); // Handles &&
-    std::unique_ptr<Expression> parseEquality();   // Handles ==, !=
-    std::unique_ptr<Expression> parseComparison(); // Handles <, >, <=, >=
-    std::unique_ptr<Expression> parseTerm();       // Handles +, -
-    std::unique_ptr<Expression> parseFactor();     // Handles *, /, %
-    std::unique_ptr<Expression> parseUnary();      // Handles !, - (unary)
-    std::unique_ptr<Expression> parseCall();       // Handles function calls like `expr()` and member access like `expr.member`
-    std::unique_ptr<Expression> parsePrimary();    // Handles literals, grouping, identifiers
+    NodePtr<Expression> parseExpression();
+    NodePtr<Expression> parseAssignment(); // Handles assignment (=)
+    NodePtr<Expression> parseBinary(int minPrecedence); // Binary operators binding at least minPrecedence
+    NodePtr<Expression> parseUnary();      // Handles !, - (unary)
+    NodePtr<Expression> parseCall();       // Handles function calls like `expr()` and member access like `expr.member`
+    NodePtr<Expression> parsePrimary();    // Handles literals, grouping, identifiers
 
     // Error reporting (uses ParseError from common/ast.h)
     void error(const Token& token, const std::string& message);
+    int lineOf(const Token& token) const { return lines_.position(token.offset).line; }
+    // Interned name of an IDENTIFIER; the lexer usually interned it already
+    static Symbol symbolOf(const Token& token) {
+        return token.symbol ? Symbol::fromId(token.symbol) : Symbol(token.lexeme);
+    }
 
     // Static helper functions
-    static std::unique_ptr<Expression> parseBinaryHelper(
-        Parser* parser,
-        std::function<std::unique_ptr<Expression>()> parseOperand,
-        const std::vector<TokenType>& operators
-    );
-    static std::unique_ptr<Expression> finishCall(Parser* parser, std::unique_ptr<Expression> callee);
+    static NodePtr<Expression> finishCall(Parser* parser, NodePtr<Expression> callee);
 
 };
 
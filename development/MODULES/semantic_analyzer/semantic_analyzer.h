@@ -0,0 +1,797 @@
+#ifndef SEMANTIC_ANALYZER_H
+#define SEMANTIC_ANALYZER_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "../common/token.h" // Needs TokenType, etc.
+#include "../common/ast.h"   // Needs AST node definitions
+#include "../common/ast_visitor.h" // Switch-based dispatch
+#include "../common/utils.h" // Needs tokenTypeToString
+#include "../common/log.h"   // Error reporting
+
+// The symbol table and analyzer live in this header so that both the
+// standalone semantic_analyzer_executable and the in-process hanamic driver
+// can run the exact same analysis.
+
+// --- Enhanced Symbol Table --- 
+
+enum class SymbolType { VARIABLE, FUNCTION, SPECIES, UNKNOWN };
+
+enum class Visibility { PUBLIC = 2, PRIVATE = 3, PROTECTED = 4, DEFAULT = 0 };
+
+struct SymbolEntry {
+    Symbol name;
+    Symbol typeName; // e.g., "int", "void", "Rose", or "int()" for functions before enhancement
+    SymbolType kind = SymbolType::UNKNOWN;
+    int scopeLevel = 0;
+    Visibility visibility = Visibility::DEFAULT;
+    Symbol parentSpecies; // Tên của species chứa member này (nếu là member)
+    
+    // For functions/methods: store parameter types
+    std::vector<Symbol> parameterTypes; 
+    // Add more info: is_param, is_member, visibility, etc.
+}; 
+
+struct SpeciesMemberInfo {
+    Symbol name;
+    Symbol type;
+    SymbolType kind;
+    Visibility visibility;
+};
+
+class SymbolTable {
+public:
+    SymbolTable() { enterScope(); } // Start with global scope
+
+    void enterScope() {
+        scopes_.emplace_back();
+        currentLevel_++;
+    }
+
+    void exitScope() {
+        if (!scopes_.empty()) {
+            scopes_.pop_back();
+        }
+        if(currentLevel_ > 0) currentLevel_--;
+    }
+
+    // Define a symbol in the current scope
+    bool define(Symbol name, Symbol type, SymbolType kind, 
+                Visibility visibility = Visibility::DEFAULT, Symbol parentSpecies = Symbol(),
+                const std::vector<Symbol>& paramTypes = {}) {
+        if (scopes_.empty()) return false; // Should not happen
+        
+        // Check if already defined in the *current* scope
+        auto& currentScope = scopes_.back();
+        // For non-members, check current scope. For members, check speciesMembers_
+        bool alreadyDefined = false;
+        if (!parentSpecies.empty()) {
+            auto speciesIt = speciesMembers_.find(parentSpecies);
+            if (speciesIt != speciesMembers_.end() && speciesIt->second.count(name)) {
+                alreadyDefined = true;
+            }
+        } else {
+            if (currentScope.count(name)) {
+                 alreadyDefined = true;
+            }
+        }
+
+        if (alreadyDefined) {
+            return false; // Already defined in this scope or species
+        }
+        
+        SymbolEntry entry = {name, type, kind, currentLevel_};
+        entry.visibility = visibility;
+        entry.parentSpecies = parentSpecies;
+        if (kind == SymbolType::FUNCTION) {
+            entry.parameterTypes = paramTypes;
+        }
+        
+        // Add to current scope (for local lookup within methods/blocks)
+        currentScope[name] = entry; 
+        
+        // Nếu đây là một member của species, lưu vào speciesMembers_
+        if (!parentSpecies.empty()) {
+            // Check if species map exists, if not create it (should exist if SpeciesDecl was processed)
+            speciesMembers_[parentSpecies][name] = entry; 
+        }
+        
+        return true;
+    }
+
+    // Find a symbol by searching current and outer scopes
+    SymbolEntry* lookup(Symbol name) {
+        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
+            auto found = it->find(name);
+            if (found != it->end()) {
+                return &found->second;
+            }
+        }
+        return nullptr; // Not found
+    }
+    
+    // Lookup a member within a specific species context
+    SymbolEntry* lookupMember(Symbol memberName, Symbol speciesName, Symbol analysisContext) {
+        // Primarily look within the permanent species member storage
+        auto speciesIt = speciesMembers_.find(speciesName);
+        if (speciesIt != speciesMembers_.end()) {
+            auto& members = speciesIt->second;
+            auto memberIt = members.find(memberName);
+            if (memberIt != members.end()) {
+                // Found the member entry
+                SymbolEntry* entry = &memberIt->second; // Get pointer to the stored entry
+
+                // Check visibility
+                if (entry->visibility == Visibility::PUBLIC || analysisContext == speciesName) {
+                    return entry; // Found accessible member
+                } else {
+                    // Found but not accessible from this context
+                    return nullptr;
+                }
+            }
+        }
+        // Member not found in the species definition
+        return nullptr; 
+    }
+    
+    int getCurrentLevel() const { return currentLevel_; }
+    
+    // Helper to check member existence and basic visibility 
+    // (Used before calling lookupMember to get the full entry)
+    bool hasAccessibleMember(Symbol speciesName, Symbol memberName, Symbol analysisContext) {
+        auto it = speciesMembers_.find(speciesName);
+        if (it != speciesMembers_.end()) {
+            const auto& members = it->second;
+            auto memberIt = members.find(memberName);
+            if (memberIt != members.end()) {
+                const auto& memberEntry = memberIt->second;
+                // Check visibility
+                return memberEntry.visibility == Visibility::PUBLIC || analysisContext == speciesName;
+            }
+        }
+        return false;
+    }
+    
+    // Thiết lập context species hiện tại (dùng khi phân tích bên trong species)
+    void setCurrentSpeciesContext(Symbol speciesName) {
+        currentSpeciesContext_ = speciesName;
+    }
+    
+    // Get all member names for a species (could be useful for checks like unused members later)
+    std::vector<Symbol> getMemberNames(Symbol speciesName) {
+        auto it = speciesMembers_.find(speciesName);
+        std::vector<Symbol> names;
+        if (it != speciesMembers_.end()) {
+            for(const auto& pair : it->second) {
+                names.push_back(pair.first);
+            }
+        }
+        return names;
+    }
+
+private:
+    // Keyed by interned name, so lookups hash and compare integers
+    std::vector<std::unordered_map<Symbol, SymbolEntry>> scopes_;
+    int currentLevel_ = -1;
+    
+    // Store full SymbolEntry for members of each species, keyed by species name, then member name.
+    std::unordered_map<Symbol, std::unordered_map<Symbol, SymbolEntry>> speciesMembers_;
+    
+    // Species context hiện tại - dùng để kiểm tra quyền truy cập private/protected
+    Symbol currentSpeciesContext_;
+};
+
+// --- Semantic Analysis Visitor --- 
+
+class SemanticAnalyzerVisitor : public ASTVisitor<SemanticAnalyzerVisitor, void> {
+    friend class ASTVisitor<SemanticAnalyzerVisitor, void>; // dispatch() calls the private visit methods
+public:
+    SemanticAnalyzerVisitor() = default;
+
+    void analyze(ASTNode* node) {
+        errors_.clear();
+        currentSpeciesName_ = Symbol(); // Reset context
+        currentFunctionReturnType_ = Symbol();
+        visit(node);
+    }
+
+    // analyze() for a program that arrives one top-level declaration at a
+    // time: beginProgram(), then analyzeDeclaration() for each (in source
+    // order), then endProgram(). Errors accumulate as in analyze().
+    void beginProgram() {
+        errors_.clear();
+        currentSpeciesName_ = Symbol(); // Reset context
+        currentFunctionReturnType_ = Symbol();
+        symbolTable_.enterScope(); // Global Scope
+    }
+
+    void analyzeDeclaration(Statement* stmt) {
+        visit(stmt);
+    }
+
+    void endProgram() {
+        symbolTable_.exitScope();
+    }
+
+    bool hasErrors() const {
+        return !errors_.empty();
+    }
+
+    void printErrors() const {
+        for (const auto& err : errors_) {
+            LOG_ERROR("Semantic Error: " << err);
+        }
+    }
+
+private:
+    SymbolTable symbolTable_;
+    std::vector<std::string> errors_;
+    Symbol currentFunctionReturnType_;
+    Symbol currentSpeciesName_; // Track the current species context
+
+    // Helper to record errors
+    void error(const std::string& message) {
+        errors_.push_back(message);
+    }
+    
+    // Helper to infer expression type (Enhanced)
+    // Returns the empty Symbol when the type is unknown (error already reported)
+    Symbol typeOf(Expression* expr) {
+        if (!expr) return Symbol();
+
+        switch (expr->kind) {
+        // Basic Literals
+        case NodeKind::NumberLiteralExpr: return Symbols::Int;
+        case NodeKind::StringLiteralExpr: return Symbols::String;
+        case NodeKind::BooleanLiteralExpr: return Symbols::Bool;
+        case NodeKind::FloatLiteralExpr: return Symbols::Float;
+        case NodeKind::DoubleLiteralExpr: return Symbols::Double;
+
+        // Variables/Functions/Species instances
+        case NodeKind::IdentifierExpr: {
+            IdentifierExpr* ident = static_cast<IdentifierExpr*>(expr);
+            SymbolEntry* entry = symbolTable_.lookup(ident->name);
+
+            if (!entry) {
+                error("Undeclared identifier '" + ident->name + "' used in expression.");
+                return Symbol();
+            }
+            // If it's a function symbol, return its base return type (strip "()")
+             if (entry->kind == SymbolType::FUNCTION) {
+                 std::string_view returnType = entry->typeName;
+                  if (returnType.length() >= 2 && returnType.substr(returnType.length() - 2) == "()") {
+                      return Symbol(returnType.substr(0, returnType.length() - 2));
+                  }
+                 error("Invalid function signature stored for '" + ident->name + "'. Found: " + entry->typeName);
+                 return Symbol(); // Should not happen if defined correctly
+             }
+            return entry->typeName;
+        }
+
+        // Binary Operations
+        case NodeKind::BinaryOpExpr: {
+            BinaryOpExpr* binOp = static_cast<BinaryOpExpr*>(expr);
+            Symbol leftType = typeOf(binOp->left.get());
+            Symbol rightType = typeOf(binOp->right.get());
+
+            if (leftType.empty() || rightType.empty()) return Symbol(); // Avoid cascading errors
+
+            // Helper lambda to check if a type is numeric
+            auto isNumeric = [](Symbol type) {
+                return type == Symbols::Int || type == Symbols::Float || type == Symbols::Double;
+            };
+
+            // Arithmetic Operations
+            if (binOp->op == TokenType::PLUS || binOp->op == TokenType::MINUS ||
+                binOp->op == TokenType::STAR || binOp->op == TokenType::SLASH) {
+                if (isNumeric(leftType) && isNumeric(rightType)) {
+                    // Type promotion rules: double > float > int
+                    if (leftType == Symbols::Double || rightType == Symbols::Double) return Symbols::Double;
+                    if (leftType == Symbols::Float || rightType == Symbols::Float) return Symbols::Float;
+                    return Symbols::Int; // Both must be int
+                }
+                // Allow string concatenation for PLUS
+                if (binOp->op == TokenType::PLUS && leftType == Symbols::String && rightType == Symbols::String) {
+                     return Symbols::String;
+                }
+                 error("Arithmetic operation requires numeric types (int, float, double) or string concatenation, but got '" + leftType + "' and '" + rightType + "'.");
+                 return Symbol();
+             }
+            // Modulo (typically integer only)
+            if (binOp->op == TokenType::MODULO) {
+                 if (leftType == Symbols::Int && rightType == Symbols::Int) return Symbols::Int;
+                 error("Modulo operation requires 'int' types, but got '" + leftType + "' and '" + rightType + "'.");
+                 return Symbol();
+            }
+            // Logical
+            if (binOp->op == TokenType::AND || binOp->op == TokenType::OR) {
+                if (leftType == Symbols::Bool && rightType == Symbols::Bool) return Symbols::Bool;
+                error("Logical operation requires 'bool' types, but got '" + leftType + "' and '" + rightType + "'.");
+                return Symbol();
+            }
+            // Comparison
+            if (binOp->op == TokenType::EQUAL || binOp->op == TokenType::NOT_EQUAL ||
+                binOp->op == TokenType::LESS || binOp->op == TokenType::LESS_EQUAL ||
+                binOp->op == TokenType::GREATER || binOp->op == TokenType::GREATER_EQUAL)
+            {
+                 // Allow comparison between any two numeric types
+                 if (isNumeric(leftType) && isNumeric(rightType)) return Symbols::Bool;
+                 // Allow comparison between two strings
+                 if (leftType == Symbols::String && rightType == Symbols::String) return Symbols::Bool;
+                 // Allow comparison between two bools (for == and !=)
+                 if ((binOp->op == TokenType::EQUAL || binOp->op == TokenType::NOT_EQUAL) && leftType == Symbols::Bool && rightType == Symbols::Bool) return Symbols::Bool;
+                 
+                 error("Comparison between incompatible types '" + leftType + "' and '" + rightType + "'.");
+                 return Symbol();
+            }
+
+            error("Unsupported binary operator '" + tokenTypeToString(binOp->op) + "' for types '" + leftType + "' and '" + rightType + "'.");
+            return Symbol();
+        }
+
+        // Function Calls - Phiên bản tổng quát
+        case NodeKind::FunctionCallExpr: {
+            FunctionCallExpr* call = static_cast<FunctionCallExpr*>(expr);
+            if (IdentifierExpr* calleeIdent = nodeCast<IdentifierExpr>(call->callee.get())) {
+                SymbolEntry* funcEntry = symbolTable_.lookup(calleeIdent->name);
+                if (!funcEntry || funcEntry->kind != SymbolType::FUNCTION) {
+                    error("Attempting to call undeclared or non-function identifier '" + calleeIdent->name + "'.");
+                    return Symbol();
+                }
+                
+                // Check arguments
+                const auto& expectedParams = funcEntry->parameterTypes;
+                if (call->arguments.size() != expectedParams.size()) {
+                    error("Function '" + calleeIdent->name + "' expects " + std::to_string(expectedParams.size()) + 
+                          " arguments, but got " + std::to_string(call->arguments.size()) + ".");
+                    return Symbol(); // Return empty type on error
+                }
+
+                for (size_t i = 0; i < expectedParams.size(); ++i) {
+                    Symbol argType = typeOf(call->arguments[i].get());
+                    bool compatible = checkCompatibility(expectedParams[i], argType);
+                    if (!argType.empty() && !compatible) {
+                        error("Argument type mismatch in call to '" + calleeIdent->name + "'. Expected compatible with '" + 
+                              expectedParams[i] + "' for argument " + std::to_string(i+1) + ", but got '" + argType + "'.");
+                        // Continue checking other args, but overall call result is invalid
+                    }
+                }
+                
+                // Return the function's declared return type (now stored directly in typeName)
+                return funcEntry->typeName;
+            } 
+            else if (MemberAccessExpr* memberCall = nodeCast<MemberAccessExpr>(call->callee.get())) {
+                Symbol objectType = typeOf(memberCall->object.get());
+                if (objectType.empty()) return Symbol(); // Error already reported
+                
+                Symbol methodName = memberCall->member->name;
+ 
+                // --- Member Function Lookup & Argument Check ---
+                SymbolEntry* methodEntry = symbolTable_.lookupMember(methodName, objectType, currentSpeciesName_);
+
+                if (!methodEntry || methodEntry->kind != SymbolType::FUNCTION) {
+                    error("Cannot find accessible member function '" + methodName + "' in species '" + objectType + "'.");
+                    return Symbol();
+                }
+
+                // Check arguments (similar to regular function call)
+                const auto& expectedParams = methodEntry->parameterTypes;
+                if (call->arguments.size() != expectedParams.size()) {
+                    error("Method '" + methodName + "' expects " + std::to_string(expectedParams.size()) +
+                          " arguments, but got " + std::to_string(call->arguments.size()) + ".");
+                    return Symbol(); // Return empty type on error
+                }
+
+                for (size_t i = 0; i < expectedParams.size(); ++i) {
+                    Symbol argType = typeOf(call->arguments[i].get());
+                    bool compatible = checkCompatibility(expectedParams[i], argType);
+                    if (!argType.empty() && !compatible) {
+                        error("Argument type mismatch in call to '" + methodName + "'. Expected compatible with '" +
+                              expectedParams[i] + "' for argument " + std::to_string(i+1) + ", but got '" + argType + "'.");
+                        // Continue checking other args
+                    }
+                }
+
+                // Return the method's declared return type
+                return methodEntry->typeName;
+                // --- End Member Function Lookup ---
+            } 
+            else {
+                error("Invalid callee type for function call.");
+                return Symbol();
+            }
+        }
+
+        // Assignment (is also an expression)
+        case NodeKind::AssignmentStmt: {
+            AssignmentStmt* assign = static_cast<AssignmentStmt*>(expr);
+             // Type of assignment is the type of the right-hand side
+             Symbol rightType = typeOf(assign->right.get());
+             Symbol leftType;
+
+             // Check if left side is assignable (L-value)
+             bool isLValue = false;
+             // Check if left side is assignable (L-value) & type compatibility
+             if (IdentifierExpr* ident = nodeCast<IdentifierExpr>(assign->left.get())) {
+                  SymbolEntry* entry = symbolTable_.lookup(ident->name);
+                   if (!entry) {
+                       error("Cannot assign to undeclared identifier '" + ident->name + "'.");
+                       return Symbol();
+                   } else {
+                       // TODO: Check if variable is const
+                       isLValue = true; 
+                       leftType = entry->typeName;
+                   }
+             } else if (MemberAccessExpr* member = nodeCast<MemberAccessExpr>(assign->left.get())) {
+                  Symbol objectType = typeOf(member->object.get());
+                  Symbol memberName = member->member->name;
+
+                  if (!objectType.empty()) { // Only check member if object type is known
+                       SymbolEntry* speciesEntry = symbolTable_.lookup(objectType);
+                       if (speciesEntry && speciesEntry->kind == SymbolType::SPECIES) {
+                            // Use the proper SymbolTable method to lookup the member
+                            SymbolEntry* memberEntry = symbolTable_.lookupMember(memberName, objectType, currentSpeciesName_);
+
+                            if (memberEntry) {
+                                // Check if assigning to a method
+                                if (memberEntry->kind == SymbolType::FUNCTION) {
+                                    error("Cannot assign to method '" + memberName + "'.");
+                                    return Symbol(); // Invalid assignment
+                                }
+                                // TODO: Check if member is const
+                                isLValue = true;
+                                leftType = memberEntry->typeName;
+                            } else {
+                                error("Cannot find accessible member variable '" + memberName + "' in species '" + objectType + "' for assignment.");
+                                return Symbol();
+                            }
+                       } else {
+                             error("Cannot assign to member '" + memberName + "' of non-species type '" + objectType + "'.");
+                            return Symbol();
+                       }
+                     }
+             }
+
+             // Perform checks if LHS is valid and types are known
+             if (!isLValue) {
+                  error("Invalid left-hand side for assignment.");
+                  return Symbol();
+              }
+             
+             // Check assignment compatibility
+             bool compatible = false;
+             if (leftType == rightType) {
+                 compatible = true;
+             } else {
+                 // Allow assigning int to float/double, or float to double
+                 if ((leftType == Symbols::Float || leftType == Symbols::Double) && rightType == Symbols::Int) compatible = true;
+                 if (leftType == Symbols::Double && rightType == Symbols::Float) compatible = true;
+                 if (leftType == Symbols::Float && rightType == Symbols::Double) compatible = true;
+             }
+
+             if (!leftType.empty() && !rightType.empty() && !compatible) {
+                   error("Type mismatch: Cannot assign value of type '" + rightType + "' to L-value of type '" + leftType + "'.");
+                   return Symbol(); // Return empty on type error
+             }
+             
+             return rightType; // Assignment expression evaluates to the assigned value's type (rhs)
+         }
+
+
+        // Member Access (e.g., g.member) - evaluation type
+        case NodeKind::MemberAccessExpr: {
+            MemberAccessExpr* memberAccess = static_cast<MemberAccessExpr*>(expr);
+            Symbol objectType = typeOf(memberAccess->object.get());
+            if (objectType.empty()) return Symbol(); // Error already reported
+
+            SymbolEntry* speciesEntry = symbolTable_.lookup(objectType);
+             if (!speciesEntry || speciesEntry->kind != SymbolType::SPECIES) {
+                 error("Cannot access member '" + memberAccess->member->name + "' on non-species type '" + objectType + "'.");
+                 return Symbol();
+             }
+             
+             // Use the proper SymbolTable method to lookup the member
+             Symbol memberName = memberAccess->member->name;
+             SymbolEntry* memberEntry = symbolTable_.lookupMember(memberName, objectType, currentSpeciesName_);
+
+             if (memberEntry) {
+                  // Check if accessing a function like a variable
+                  if (memberEntry->kind == SymbolType::FUNCTION) {
+                       error("Cannot access method '" + memberName + "' like a variable. Use () to call.");
+                       return Symbol();
+                  }
+                  // It's a variable, return its type
+                  return memberEntry->typeName;
+             } 
+
+            // Member not found or not accessible
+            error("Cannot find accessible member variable '" + memberName + "' in species '" + objectType + "'.");
+            return Symbol();
+        }
+
+        // ... Add other expression types ...
+        default:
+            break;
+        }
+
+        error("Unable to determine type for this expression node.");
+        return Symbol();
+    }
+
+    // --- Visitor Methods --- 
+
+    void visit(ASTNode* node) {
+        dispatch(node); // Switch on node->kind (see ast_visitor.h)
+    }
+
+    // Reached for node kinds without a visit method below (WhileStmt, ForStmt, ...)
+    void visitUnsupported(ASTNode* node) {
+        if (isExpressionKind(node->kind)) {
+            // Should not happen at statement level
+            return;
+        }
+        error("Unsupported AST node type '" + std::string(node->kindName()) + "' encountered during semantic analysis.");
+    }
+
+    void visitProgram(ProgramNode* node) {
+         symbolTable_.enterScope(); // Global Scope
+         for (const auto& stmt : node->statements) {
+             visit(stmt.get());
+         }
+          symbolTable_.exitScope();
+    }
+
+    void visitStyleInclude(StyleIncludeStmt* node) { /* Usually ignored */ }
+    void visitGardenDecl(GardenDeclStmt* node) { /* Namespace handling if needed */ }
+
+    void visitSpeciesDecl(SpeciesDeclStmt* node) {
+        if (!symbolTable_.define(node->name, node->name, SymbolType::SPECIES)) {
+            error("Species '" + node->name + "' already defined in this scope.");
+        }
+        
+        Symbol previousSpeciesName = currentSpeciesName_;
+        currentSpeciesName_ = node->name; // Set current species context
+        
+        // Thiết lập context trong symbol table để kiểm tra quyền truy cập
+        symbolTable_.setCurrentSpeciesContext(node->name);
+        
+        symbolTable_.enterScope(); // Enter species member scope
+        
+        // First pass: define members in the symbol table
+        for (const auto& section : node->sections) {
+            if (!section) continue;
+            
+            // Lấy visibility từ section
+            Visibility visibility = Visibility::DEFAULT;
+            if (auto* visBlock = nodeCast<VisibilityBlockStmt>(section.get())) {
+                visibility = static_cast<Visibility>(visBlock->visibility);
+            }
+            
+            if (!section->block) continue;
+            
+            for (const auto& stmt : section->block->statements) {
+                if (auto* varDecl = nodeCast<VariableDeclStmt>(stmt.get())) {
+                    if (!symbolTable_.define(varDecl->varName, varDecl->typeName, 
+                                           SymbolType::VARIABLE, visibility, node->name)) {
+                        error("Member variable '" + varDecl->varName + "' already declared in species '" + node->name + "'.");
+                    }
+                } else if (auto* funcDef = nodeCast<FunctionDefStmt>(stmt.get())) {
+                    // Lưu thông tin method với return type
+                    // Collect parameter types
+                    std::vector<Symbol> paramTypes;
+                    for (const auto& param : funcDef->parameters) {
+                        paramTypes.push_back(param.typeName);
+                    }
+                    if (!symbolTable_.define(funcDef->name, funcDef->returnType, 
+                                          SymbolType::FUNCTION, visibility, node->name, paramTypes)) {
+                        error("Method '" + funcDef->name + "' already declared in species '" + node->name + "'.");
+                    }
+                }
+            }
+        }
+        
+        // Second pass: visit sections để phân tích method bodies
+        for (const auto& section : node->sections) {
+            visit(section.get());
+        }
+        
+        symbolTable_.exitScope(); // Exit species scope
+        
+        // Khôi phục context trước đó
+        symbolTable_.setCurrentSpeciesContext(previousSpeciesName);
+        currentSpeciesName_ = previousSpeciesName;
+    }
+
+    void visitVisibilityBlock(VisibilityBlockStmt* node) {
+        // Visit the statements within the block
+        if (node->block) {
+            // We don't create a new scope here, members belong to the species scope
+            for (const auto& stmt : node->block->statements) {
+                 visit(stmt.get());
+            }
+        }
+    }
+
+    void visitBlock(BlockStmt* node) {
+        // Only create a new scope if NOT directly inside a species visibility block
+        bool newScopeNeeded = (symbolTable_.getCurrentLevel() > 0 && currentSpeciesName_.empty()); // Crude check
+         if(newScopeNeeded) symbolTable_.enterScope(); 
+        for (const auto& stmt : node->statements) {
+            visit(stmt.get());
+        }
+         if(newScopeNeeded) symbolTable_.exitScope();
+    }
+
+    void visitVariableDecl(VariableDeclStmt* node) {
+         // If inside a species, this was handled in visitSpeciesDecl first pass
+         if (!currentSpeciesName_.empty()) {
+              // Analyze initializer if present
+             if (node->initializer) {
+                 Symbol initializerType = typeOf(node->initializer.get());
+                  if (!initializerType.empty() && initializerType != node->typeName) {
+                       error("Type mismatch: Cannot initialize member variable '" + node->varName +
+                             "' of type '" + node->typeName + "' with expression of type '" +
+                             initializerType + "'.");
+                  }
+             }
+             return; // Definition already handled
+         }
+
+         // --- Regular variable declaration ---
+         // Check type exists
+         if (node->typeName != Symbols::Int && node->typeName != Symbols::String && node->typeName != Symbols::Bool &&
+             node->typeName != Symbols::Float && node->typeName != Symbols::Double) {
+             SymbolEntry* typeEntry = symbolTable_.lookup(node->typeName);
+             if (!typeEntry || typeEntry->kind != SymbolType::SPECIES) { // Allow species types
+                 error("Unknown type '" + node->typeName + "' for variable '" + node->varName + "'.");
+             }
+         }
+
+        // Check initializer type
+        if (node->initializer) {
+             Symbol initializerType = typeOf(node->initializer.get());
+             if (!initializerType.empty() && initializerType != node->typeName) {
+                  error("Type mismatch: Cannot initialize variable '" + node->varName +
+                        "' of type '" + node->typeName + "' with expression of type '" +
+                        initializerType + "'.");
+             }
+        }
+
+        // Define the variable
+        if (!symbolTable_.define(node->varName, node->typeName, SymbolType::VARIABLE)) {
+            error("Variable '" + node->varName + "' already declared in this scope.");
+        }
+    }
+
+    void visitFunctionDef(FunctionDefStmt* node) {
+          // If inside a species, the symbol was defined in visitSpeciesDecl first pass.
+         // We still need to analyze the body.
+
+         // Collect parameter types
+         std::vector<Symbol> paramTypes;
+         for (const auto& param : node->parameters) {
+             paramTypes.push_back(param.typeName);
+         }
+
+         // Set context for return type checking
+         Symbol previousFunctionReturnType = currentFunctionReturnType_;
+         currentFunctionReturnType_ = node->returnType;
+
+         // Define the function symbol if not already defined (e.g., if not a method)
+         // Store only return type in 'typeName', param types are separate
+         if (currentSpeciesName_.empty()) { // Only define if not a method (methods defined in visitSpeciesDecl)
+             if (!symbolTable_.define(node->name, node->returnType, SymbolType::FUNCTION, Visibility::DEFAULT, Symbol(), paramTypes)) {
+                 error("Function '" + node->name + "' already defined in this scope.");
+                 // Even if redefined, continue analysis of the body with the new definition's scope
+             }
+         }
+
+         symbolTable_.enterScope(); // Enter function parameter/body scope
+         // Define parameters
+         for (const auto& param : node->parameters) {
+              // Check parameter type validity
+              if (param.typeName != Symbols::Int && param.typeName != Symbols::String && param.typeName != Symbols::Bool) {
+                  if (!symbolTable_.lookup(param.typeName)) { // Allow species types
+                      error("Unknown type '" + param.typeName + "' for parameter '" + param.paramName + "' in function '" + node->name + "'.");
+                  }
+              }
+              // Define parameter in function scope
+              if (!symbolTable_.define(param.paramName, param.typeName, SymbolType::VARIABLE)) {
+                  error("Parameter '" + param.paramName + "' redeclared in function '" + node->name + "'.");
+              }
+         }
+
+         // Visit function body
+         if (node->body) {
+              // For methods, body doesn't create another scope level directly via visitBlock
+              for (const auto& stmt : node->body->statements) {
+                   visit(stmt.get());
+              }
+         } else {
+              error("Function '" + node->name + "' has no body.");
+         }
+         
+         symbolTable_.exitScope(); // Exit function scope
+
+         currentFunctionReturnType_ = previousFunctionReturnType; // Restore outer context
+    }
+
+    void visitReturn(ReturnStmt* node) {
+        Symbol returnExprType = Symbols::Void;
+        if (node->returnValue) {
+            returnExprType = typeOf(node->returnValue.get());
+            if (returnExprType.empty()) return; // Error already reported by typeOf
+        }
+
+        if (currentFunctionReturnType_.empty()) {
+            error("'blossom' (return) statement found outside of a function definition.");
+        } else {
+            bool typesCompatible = checkCompatibility(currentFunctionReturnType_, returnExprType);
+            if (!typesCompatible) {
+                if (currentFunctionReturnType_ == Symbols::Void && node->returnValue) {
+                    error("Cannot return a value from a 'void' function.");
+                } else if (currentFunctionReturnType_ != Symbols::Void && !node->returnValue) {
+                    error("Must return a value of type '" + currentFunctionReturnType_ + "' from non-void function.");
+                } else {
+                    error("Return type mismatch: Cannot return value of type '" + returnExprType +
+                          "' from function expecting '" + currentFunctionReturnType_ + "'.");
+                }
+            }
+        }
+    }
+
+    void visitExpressionStmt(ExpressionStmt* node) {
+        // Analyze the expression
+        typeOf(node->expression.get());
+    }
+
+    void visitBranch(BranchStmt* node) {
+        for (const auto& branch : node->branches) {
+            if (branch.condition) {
+                Symbol conditionType = typeOf(branch.condition.get());
+                if (!conditionType.empty() && conditionType != Symbols::Bool) {
+                    error("Condition for 'branch' must be of type bool, but got '" + conditionType + "'.");
+                }
+            }
+             if(branch.body) { // Visit body block
+                 visit(branch.body.get());
+             }
+        }
+    }
+
+    void visitIO(IOStmt* node) {
+        for (const auto& expr : node->expressions) {
+            Symbol exprType = typeOf(expr.get());
+             if (exprType.empty()) continue; // Error already reported
+
+             if (node->direction == TokenType::STREAM_IN) {
+                 if (!nodeCast<IdentifierExpr>(expr.get()) && !nodeCast<MemberAccessExpr>(expr.get())) { // Allow reading into members
+                      error("'water >>' can only read into variables or assignable members.");
+                 }
+                 // Could also check if the variable/member is assignable (not const etc. if language had it)
+             }
+             // Could add checks for << on complex types if needed (e.g., require toString method)
+        }
+    }
+
+    bool checkCompatibility(Symbol expectedType, Symbol actualType) {
+        // Checks if actualType can be implicitly converted to expectedType
+        if (expectedType == actualType) return true;
+        
+        // Allow int -> float, int -> double, float -> double
+        if (expectedType == Symbols::Float && actualType == Symbols::Int) return true;
+        if (expectedType == Symbols::Double && actualType == Symbols::Int) return true;
+        if (expectedType == Symbols::Double && actualType == Symbols::Float) return true;
+        
+        // Allow double -> float (potentially lossy, add warning later if needed)
+        if (expectedType == Symbols::Float && actualType == Symbols::Double) return true;
+        
+        // Disallow other conversions for now
+        return false;
+    }
+};
+
+#endif // SEMANTIC_ANALYZER_H
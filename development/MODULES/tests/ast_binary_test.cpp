@@ -0,0 +1,111 @@
+// Test: readBinaryAst rejects malformed trees a parser could not have written.
+//
+// Usage: ast_binary_test
+// Trees are built by hand, written with BinaryAstWriter and read back:
+// statements or right-hand operands nested past MAX_NESTING_DEPTH and token
+// types past TOKEN_TYPE_COUNT must be rejected with a runtime_error, while
+// nesting exactly at the limit and long chains of left-hand operands (which
+// never nest in the parser) must read back.
+// Prints one line per case and returns 1 if any case fails.
+
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../common/ast.h"
+#include "../common/ast_binary.h"
+
+// Builds a program with build (nodes go to the arena in scope) and returns its binary AST
+static std::string writeProgram(const std::function<NodePtr<Statement>()>& build) {
+    Arena arena;
+    ArenaScope scope(arena);
+    auto program = makeNode<ProgramNode>();
+    program->statements.push_back(build());
+    BinaryAstWriter writer;
+    program->writeBinary(writer);
+    return writer.finish();
+}
+
+// Blocks nested inside each other, depth statements in all
+static std::string nestedBlocks(size_t depth) {
+    return writeProgram([depth] {
+        auto outer = makeNode<BlockStmt>();
+        BlockStmt* block = outer.get();
+        for (size_t i = 1; i < depth; ++i) {
+            auto inner = makeNode<BlockStmt>();
+            BlockStmt* next = inner.get();
+            block->statements.push_back(std::move(inner));
+            block = next;
+        }
+        return outer;
+    });
+}
+
+// "x op (x op (x ...))" with depth right-hand operands, or
+// "((x op x) op x) ..." with depth left-hand operands
+static std::string operandChain(size_t depth, bool rightHand, TokenType op = TokenType::PLUS) {
+    return writeProgram([=] {
+        NodePtr<Expression> expr = makeNode<IdentifierExpr>(Symbol("x"));
+        for (size_t i = 0; i < depth; ++i) {
+            NodePtr<Expression> operand = makeNode<IdentifierExpr>(Symbol("x"));
+            expr = rightHand ? makeNode<BinaryOpExpr>(op, std::move(operand), std::move(expr))
+                             : makeNode<BinaryOpExpr>(op, std::move(expr), std::move(operand));
+        }
+        return makeNode<ExpressionStmt>(std::move(expr));
+    });
+}
+
+// Empty if bytes read back, otherwise the error message
+static std::string readError(const std::string& bytes) {
+    Arena arena;
+    try {
+        readBinaryAst(bytes.data(), bytes.size(), arena);
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+static int failures = 0;
+
+static void expectReads(const char* name, const std::string& bytes) {
+    std::string message = readError(bytes);
+    if (message.empty()) {
+        std::cout << "ok   " << name << std::endl;
+    } else {
+        std::cout << "FAIL " << name << ": " << message << std::endl;
+        ++failures;
+    }
+}
+
+static void expectRejected(const char* name, const std::string& bytes, const std::string& expected) {
+    std::string message = readError(bytes);
+    if (message.find(expected) != std::string::npos) {
+        std::cout << "ok   " << name << std::endl;
+    } else {
+        std::cout << "FAIL " << name << ": expected \"" << expected << "\", got \""
+                  << (message.empty() ? "no error" : message) << "\"" << std::endl;
+        ++failures;
+    }
+}
+
+int main() {
+    expectReads("statements at the limit", nestedBlocks(MAX_NESTING_DEPTH));
+    expectRejected("statements one over the limit", nestedBlocks(MAX_NESTING_DEPTH + 1),
+                   "statement nesting too deep");
+
+    expectReads("right-hand operands at the limit", operandChain(MAX_NESTING_DEPTH, true));
+    expectRejected("right-hand operands one over the limit", operandChain(MAX_NESTING_DEPTH + 1, true),
+                   "expression nesting too deep");
+    expectReads("long chain of left-hand operands", operandChain(10000, false));
+
+    expectRejected("operator past the last token type",
+                   operandChain(1, false, static_cast<TokenType>(TOKEN_TYPE_COUNT)), "token type out of range");
+
+    if (failures > 0) {
+        std::cout << failures << " binary AST case(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
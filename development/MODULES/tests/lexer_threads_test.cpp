@@ -0,0 +1,168 @@
+// Test: several Lexer objects running at the same time on different threads.
+//
+// Usage: lexer_threads_test [threads] [rounds]
+// Each source below is lexed serially for reference, once with scanTokens()
+// and once pulling tokens one by one with nextToken() (scanTokens() keeps the
+// EOF_TOKEN that trailing whitespace produces before adding its own, so the
+// two are compared separately). Then threads (default 8) lexers start
+// together, each on a different source, and lex it rounds (default 20) times,
+// alternating the two ways. Every token must match the serial result. Build
+// with "make SANITIZE=thread" to run it under ThreadSanitizer.
+// Last, scanTokensParallel() lexes a corpus whose middle chunks start inside
+// a block comment full of names; it must match scanTokens() and must not
+// intern the names its thrown-away chunk guesses saw.
+// Prints one line per thread (and one for the parallel lex) and returns 1 if
+// any token differed.
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../lexer/lexer.h"
+
+static const char* const SOURCES[] = {
+    "../lexer/input/test_final.hanami",
+    "../lexer/input/test.hanami",
+    "../lexer/input/simple_math.hanami",
+    "../lexer/input/error.hanami",
+    "../benchmarks/input/expressions.hanami",
+    "../benchmarks/input/generated_tables.hanami",
+};
+
+static bool sameToken(const Token& a, const Token& b) {
+    return a.type == b.type && a.symbol == b.symbol && a.offset == b.offset && a.lexeme == b.lexeme;
+}
+
+static std::vector<Token> pullTokens(Lexer& lexer) {
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(lexer.nextToken());
+    } while (tokens.back().type != TokenType::EOF_TOKEN);
+    return tokens;
+}
+
+// Index of the first token that differs from expected, or -1 if none does
+static long firstMismatch(const std::vector<Token>& tokens, const std::vector<Token>& expected) {
+    size_t n = std::min(tokens.size(), expected.size());
+    for (size_t i = 0; i < n; ++i) {
+        if (!sameToken(tokens[i], expected[i])) return static_cast<long>(i);
+    }
+    return tokens.size() == expected.size() ? -1 : static_cast<long>(n);
+}
+
+// Chunked lex of test_final around a comment that spans several chunks.
+// Returns false (after printing why) if it differs from the serial lex.
+static bool checkParallel(const std::string& unit, unsigned threadCount) {
+    std::string corpus;
+    while (corpus.size() < 512 * 1024) corpus += unit + "\n";
+    corpus += "/*\n";
+    for (int i = 0; corpus.size() < 2 * 1024 * 1024; ++i) {
+        corpus += "ghostName" + std::to_string(i) + " = ghostName" + std::to_string(i + 1) + ";\n";
+    }
+    corpus += "*/\n";
+    while (corpus.size() < 3 * 1024 * 1024) corpus += unit + "\n";
+
+    Lexer serialLexer(corpus);
+    std::vector<Token> expected = serialLexer.scanTokens();
+    size_t interned = globalInterner().size();
+    Lexer parallelLexer(corpus);
+    std::vector<Token> tokens = parallelLexer.scanTokensParallel(std::max(threadCount, 2u));
+    long mismatch = firstMismatch(tokens, expected);
+    if (mismatch >= 0) {
+        std::cout << "FAIL parallel: differs from the serial lex at token " << mismatch << std::endl;
+        return false;
+    }
+    if (globalInterner().size() != interned) {
+        std::cout << "FAIL parallel: interned " << globalInterner().size() - interned
+                  << " names the serial lex never kept" << std::endl;
+        return false;
+    }
+    std::cout << "ok   parallel: " << corpus.size() << " bytes, " << tokens.size() << " tokens" << std::endl;
+    return true;
+}
+
+struct ThreadResult {
+    size_t tokens = 0;
+    long mismatch = -1; // First differing token in the round that failed
+    int round = -1;
+};
+
+int main(int argc, char* argv[]) {
+    int threadCount = argc > 1 ? std::atoi(argv[1]) : 8;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (threadCount <= 0 || rounds <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [threads] [rounds]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> sources;
+    for (const char* path : SOURCES) {
+        std::ifstream inFile(path);
+        if (!inFile) {
+            std::cerr << "Error: Could not open input file: " << path << std::endl;
+            return 1;
+        }
+        std::stringstream buffer;
+        buffer << inFile.rdbuf();
+        sources.push_back(buffer.str());
+    }
+
+    // Serial reference; the lexers stay alive because error lexemes live in them
+    std::vector<std::unique_ptr<Lexer>> referenceLexers;
+    std::vector<std::vector<Token>> expectedScanned;
+    std::vector<std::vector<Token>> expectedPulled;
+    for (const std::string& source : sources) {
+        referenceLexers.push_back(std::make_unique<Lexer>(source));
+        expectedScanned.push_back(referenceLexers.back()->scanTokens());
+        referenceLexers.push_back(std::make_unique<Lexer>(source));
+        expectedPulled.push_back(pullTokens(*referenceLexers.back()));
+    }
+
+    std::vector<ThreadResult> results(threadCount);
+    std::atomic<int> ready{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            size_t index = t % sources.size();
+            ThreadResult& result = results[t];
+            // Start together so the lexers really overlap
+            ready.fetch_add(1);
+            while (ready.load() < threadCount) std::this_thread::yield();
+            for (int round = 0; round < rounds && result.mismatch < 0; ++round) {
+                Lexer lexer(sources[index]);
+                bool scanned = round % 2 == 0;
+                std::vector<Token> tokens = scanned ? lexer.scanTokens() : pullTokens(lexer);
+                result.tokens += tokens.size();
+                result.mismatch = firstMismatch(tokens, scanned ? expectedScanned[index] : expectedPulled[index]);
+                if (result.mismatch >= 0) result.round = round;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    int failures = 0;
+    for (int t = 0; t < threadCount; ++t) {
+        const char* source = SOURCES[t % sources.size()];
+        if (results[t].mismatch < 0) {
+            std::cout << "ok   thread " << t << ": " << source << ", " << results[t].tokens << " tokens" << std::endl;
+        } else {
+            std::cout << "FAIL thread " << t << ": " << source << " differs from the serial lex at token "
+                      << results[t].mismatch << " in round " << results[t].round << std::endl;
+            ++failures;
+        }
+    }
+    if (!checkParallel(sources[0], threadCount)) ++failures;
+    if (failures > 0) {
+        std::cout << failures << " lex(es) differed from the serial one" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Test: MAX_NESTING_DEPTH boundaries in the parser.
+//
+// Usage: nesting_test
+// Statement nesting (declarations and blocks) and expression nesting
+// (parentheses, argument lists, right-hand operands, chained '=') are limited
+// separately: input exactly at the limit must parse, one level more must fail
+// with a ParseError, and a deep expression inside deep blocks must still
+// parse. Whatever parses must also read back from the binary AST, which
+// applies the same limit.
+// Prints one line per case and returns 1 if any case fails.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+#include "../common/ast_binary.h"
+
+// Top-level "int x = (((1)));": the initializer is one expression level, and
+// every parenthesis adds another.
+static std::string nestedExpression(size_t parens) {
+    return std::string(parens, '(') + "1" + std::string(parens, ')');
+}
+
+// "grow f() -> void { { ... } }" with blocks braces: the function
+// declaration is one statement level and every block one more. body goes in
+// the innermost block.
+static std::string nestedBlocks(size_t blocks, const std::string& body = "") {
+    return "grow f() -> void " + std::string(blocks, '{') + body + std::string(blocks, '}');
+}
+
+// "1 + (1 + (... (1 + last)))": every level is a right-hand operand and a
+// parenthesis, two expression levels.
+static std::string nestedOperands(size_t parens, const std::string& last) {
+    std::string source = "1";
+    for (size_t i = 0; i < parens; ++i) source += " + (1";
+    return source + " + " + last + std::string(parens, ')');
+}
+
+// Empty if source parses and its binary AST reads back to the same bytes,
+// otherwise the error message
+static std::string parseError(const std::string& source) {
+    Lexer lexer(source);
+    std::vector<Token> tokens = lexer.scanTokens();
+    Arena arena;
+    Parser parser(tokens, lexer.lineTable(), arena);
+    std::string bytes;
+    try {
+        NodePtr<ProgramNode> program = parser.parse();
+        BinaryAstWriter writer;
+        program->writeBinary(writer);
+        bytes = writer.finish();
+    } catch (const ParseError& e) {
+        return e.what();
+    }
+    try {
+        NodePtr<ASTNode> copy = readBinaryAst(bytes.data(), bytes.size(), arena);
+        BinaryAstWriter writer;
+        copy->writeBinary(writer);
+        if (writer.finish() != bytes) return "binary AST did not round-trip";
+    } catch (const std::exception& e) {
+        return std::string("binary AST: ") + e.what();
+    }
+    return "";
+}
+
+static int failures = 0;
+
+static void expectParses(const char* name, const std::string& source) {
+    std::string message = parseError(source);
+    if (message.empty()) {
+        std::cout << "ok   " << name << std::endl;
+    } else {
+        std::cout << "FAIL " << name << ": " << message << std::endl;
+        ++failures;
+    }
+}
+
+static void expectTooDeep(const char* name, const std::string& source, const std::string& kind) {
+    std::string message = parseError(source);
+    std::string expected = kind + " nesting too deep";
+    if (message.find(expected) != std::string::npos) {
+        std::cout << "ok   " << name << std::endl;
+    } else {
+        std::cout << "FAIL " << name << ": expected \"" << expected << "\", got \""
+                  << (message.empty() ? "no error" : message) << "\"" << std::endl;
+        ++failures;
+    }
+}
+
+int main() {
+    // 256 levels: the initializer plus 255 parentheses
+    expectParses("expression at the limit", "int x = " + nestedExpression(255) + ";");
+    expectTooDeep("expression one over the limit", "int x = " + nestedExpression(256) + ";", "Expression");
+
+    // 256 levels: the initializer, 127 operand and parenthesis pairs, and the
+    // last operand
+    expectParses("right-hand operands at the limit", "int x = " + nestedOperands(127, "1") + ";");
+    expectTooDeep("right-hand operands one over the limit", "int x = " + nestedOperands(127, "1 * 1") + ";",
+                  "Expression");
+    // Left-hand operands are parsed in a loop and never nest
+    std::string sum = "1";
+    for (int i = 0; i < 5000; ++i) sum += " + 1";
+    expectParses("long chain of left-hand operands", "int x = " + sum + ";");
+
+    // 256 levels: the function and 255 blocks
+    expectParses("blocks at the limit", nestedBlocks(255));
+    expectTooDeep("blocks one over the limit", nestedBlocks(256), "Statement");
+
+    // Statement and expression depth both at the limit
+    expectParses("expression at the limit inside blocks at the limit",
+                 nestedBlocks(255, "int x = " + nestedExpression(255) + ";"));
+    expectTooDeep("expression one over the limit inside blocks",
+                  nestedBlocks(255, "int x = " + nestedExpression(256) + ";"), "Expression");
+
+    if (failures > 0) {
+        std::cout << failures << " nesting case(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Test: hanamic reports the same diagnostics whether it compiles stage after
+# stage (--threads=1) or as a pipeline (--threads=4).
+#
+# Usage: pipeline_diagnostics.sh [hanamic] [input.hanami...]
+# Each input (by default every file in input/) is compiled both ways; the
+# exit status and everything printed must match. Returns 1 if any input
+# differs.
+
+HANAMIC=${1:-../hanamic/hanamic}
+[ $# -gt 0 ] && shift
+[ $# -eq 0 ] && set -- input/*.hanami
+
+if [ ! -x "$HANAMIC" ]; then
+    echo "Error: $HANAMIC not found (run make build first)"
+    exit 1
+fi
+
+OUT=$(mktemp -d) || exit 1
+trap 'rm -rf "$OUT"' EXIT
+
+failures=0
+for input in "$@"; do
+    "$HANAMIC" "$input" "$OUT/serial" --threads=1 > "$OUT/serial.txt" 2>&1
+    serialStatus=$?
+    "$HANAMIC" "$input" "$OUT/pipelined" --threads=4 > "$OUT/pipelined.txt" 2>&1
+    pipelinedStatus=$?
+    if [ $serialStatus -ne $pipelinedStatus ]; then
+        echo "FAIL $input: exit status $serialStatus with --threads=1, $pipelinedStatus with --threads=4"
+        failures=$((failures + 1))
+    elif ! diff "$OUT/serial.txt" "$OUT/pipelined.txt" > "$OUT/diff.txt"; then
+        echo "FAIL $input: diagnostics differ (< --threads=1, > --threads=4)"
+        cat "$OUT/diff.txt"
+        failures=$((failures + 1))
+    else
+        echo "ok   $input"
+    fi
+done
+
+if [ $failures -gt 0 ]; then
+    echo "$failures input(s) compiled differently"
+    exit 1
+fi
+exit 0
@@ -0,0 +1,139 @@
+// Test: IncrementalLexer::relex against a full lex after every edit.
+//
+// Usage: relex_test [edits] [seed]
+// The lexer inputs are joined into one document, which then takes edits
+// (default 3000) from a fixed pseudo-random walk: mostly small insertions,
+// deletions and replacements near the previous edit, sometimes a jump
+// elsewhere, with text that opens or closes comments and strings, adds
+// newlines or style paths. After each edit the tokens must equal
+// scanTokens() of the new text, tokens outside the reported range must be
+// the old ones (shifted past the edit), and the line table must equal one
+// built from the new text.
+// Prints one line and returns 1 at the first edit that differs.
+
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../lexer/lexer.h"
+
+static const char* const SOURCES[] = {
+    "../lexer/input/test_final.hanami",
+    "../lexer/input/test.hanami",
+    "../lexer/input/simple_math.hanami",
+    "../lexer/input/error.hanami",
+};
+
+// Inserted text: ordinary tokens and everything that changes how far a change reaches
+static const char* const SNIPPETS[] = {
+    "x", "y1", " ", "\n", "0x1F", "3.5e", "\"", "\\", "\"a\\tb\"", "/*", "*/", "//",
+    "style", " <path.h>\n", "{", "}", "(", "->", "::", "@", "int z = 1;\n",
+};
+
+// A token with its lexeme copied, so it outlives the text it came from
+struct TokenCopy {
+    TokenType type;
+    SymbolId symbol;
+    uint32_t offset;
+    std::string lexeme;
+};
+
+static std::vector<TokenCopy> copyTokens(const std::vector<Token>& tokens) {
+    std::vector<TokenCopy> copies;
+    for (const Token& token : tokens) {
+        copies.push_back({token.type, token.symbol, token.offset, std::string(token.lexeme)});
+    }
+    return copies;
+}
+
+static bool sameToken(const TokenCopy& a, const TokenCopy& b, uint32_t shift = 0) {
+    return a.type == b.type && a.symbol == b.symbol && a.offset == b.offset + shift && a.lexeme == b.lexeme;
+}
+
+// Why the state after an edit is wrong, or "" if it is right
+static std::string check(const IncrementalLexer& incremental, const std::string& text,
+                         const std::vector<TokenCopy>& before, const RelexResult& result, uint32_t shift) {
+    Lexer full(text);
+    std::vector<TokenCopy> expected = copyTokens(full.scanTokens());
+    std::vector<TokenCopy> tokens = copyTokens(incremental.tokens());
+    if (tokens.size() != expected.size()) {
+        return std::to_string(tokens.size()) + " tokens, full lex has " + std::to_string(expected.size());
+    }
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (!sameToken(tokens[i], expected[i])) return "token " + std::to_string(i) + " differs from the full lex";
+    }
+    if (result.first > result.newEnd || result.first > result.oldEnd || result.oldEnd > before.size() ||
+        before.size() - result.oldEnd != tokens.size() - result.newEnd) {
+        return "reported range does not fit the token counts";
+    }
+    for (size_t i = 0; i < result.first; ++i) {
+        if (!sameToken(tokens[i], before[i])) return "token " + std::to_string(i) + " before the range changed";
+    }
+    for (size_t i = result.newEnd; i < tokens.size(); ++i) {
+        if (!sameToken(tokens[i], before[i - result.newEnd + result.oldEnd], shift)) {
+            return "token " + std::to_string(i) + " after the range is not the old one shifted";
+        }
+    }
+    LineTable lines(text);
+    if (incremental.lineTable().lineStarts() != lines.lineStarts()) return "line table differs";
+    for (size_t offset = 0; offset <= text.size(); offset += 1 + text.size() / 64) {
+        SourcePosition a = incremental.lineTable().position(static_cast<uint32_t>(offset));
+        SourcePosition b = lines.position(static_cast<uint32_t>(offset));
+        if (a.line != b.line || a.column != b.column) return "position of offset " + std::to_string(offset) + " differs";
+    }
+    return "";
+}
+
+int main(int argc, char* argv[]) {
+    int edits = argc > 1 ? std::atoi(argv[1]) : 3000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 16;
+    if (edits <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [edits] [seed]" << std::endl;
+        return 1;
+    }
+
+    std::string text;
+    for (const char* path : SOURCES) {
+        std::ifstream inFile(path);
+        if (!inFile) {
+            std::cerr << "Error: Could not open input file: " << path << std::endl;
+            return 1;
+        }
+        std::stringstream buffer;
+        buffer << inFile.rdbuf();
+        text += buffer.str() + "\n";
+    }
+
+    IncrementalLexer incremental(text);
+    std::mt19937 random(seed);
+    size_t cursor = text.size() / 2;
+    for (int n = 0; n < edits; ++n) {
+        std::vector<TokenCopy> before = copyTokens(incremental.tokens());
+        if (random() % 8 == 0) {
+            cursor = random() % (text.size() + 1); // Jump elsewhere
+        } else {
+            cursor = std::min(text.size(), cursor + random() % 41 - std::min<size_t>(cursor, 20));
+        }
+        size_t removed = random() % 3 == 0 ? std::min<size_t>(text.size() - cursor, random() % 6) : 0;
+        std::string inserted = removed > 0 && random() % 2 == 0 ? "" : SNIPPETS[random() % (sizeof(SNIPPETS) / sizeof(SNIPPETS[0]))];
+
+        // Edit in place, as an editor would; the old text is gone before relex()
+        text.replace(cursor, removed, inserted);
+        SourceEdit edit{cursor, removed, inserted};
+        RelexResult result = incremental.relex(text, edit);
+        std::string error = check(incremental, text, before, result,
+                                  static_cast<uint32_t>(inserted.size()) - static_cast<uint32_t>(removed));
+        if (!error.empty()) {
+            std::cout << "FAIL edit " << n << " (offset " << cursor << ", removed " << removed << ", inserted \""
+                      << inserted << "\"): " << error << std::endl;
+            return 1;
+        }
+        cursor += inserted.size();
+    }
+    std::cout << "ok   " << edits << " edits, " << text.size() << " bytes, " << incremental.size() << " tokens at the end"
+              << std::endl;
+    return 0;
+}